@@ -1,14 +1,37 @@
+#include <algorithm>
+#include <cmath>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "lib/aggregator.h"
 #include "lib/benchmark.h"
+#include "lib/chunked_mc.h"
 #include "lib/greeks.h"
+#include "lib/hierarchy.h"
+#include "lib/implied_vol.h"
+#include "lib/incremental_var.h"
+#include "lib/isa_dispatch.h"
+#include "lib/lattice.h"
+#include "lib/market_data.h"
+#include "lib/memory_stats.h"
 #include "lib/monte_carlo.h"
+#include "lib/normal.h"
+#include "lib/pipelined_mc.h"
 #include "lib/position.h"
+#include "lib/pricing_table.h"
+#include "lib/reduction.h"
+#include "lib/rollup.h"
+#include "lib/risk_pipeline.h"
+#include "lib/risk_service.h"
+#include "lib/risk_workspace.h"
+#include "lib/scenario.h"
 #include "lib/system.h"
+#include "lib/var_attribution.h"
 
 void print_usage() {
     std::cout << "Usage: risk_benchmark [options]\n"
@@ -16,6 +39,17 @@ void print_usage() {
               << "  --positions N       Number of positions (default: 10000)\n"
               << "  --simulations N     Number of MC simulations (default: 100000)\n"
               << "  --threads N         Number of threads (default: auto-detect)\n"
+              << "  --tick-rate N       Synthetic market-data ticks/sec (default: 1000000)\n"
+              << "  --pricing-cpu N     Pin the market-data pricing thread to CPU N\n"
+              << "  --latency-csv PATH  Write latency histograms as CSV\n"
+              << "  --book PROFILE      legacy | uniform | skewed (default: legacy)\n"
+              << "  --agg-sweep         Compare aggregation strategies from 100 to 1M symbols\n"
+              << "  --isa LEVEL         Force kernel variant: baseline | v2 | v3 | v4\n"
+              << "  --precision P       double | float (float kernels, double sums)\n"
+              << "  --mc-checkpoint PATH  Checkpoint the chunked MC run; resume if PATH exists\n"
+              << "  --stream-mb N       STREAM probe array size in MB (default: 64)\n"
+              << "\nService Options:\n"
+              << "  --serve PATH        Run as a resident risk service on a Unix socket\n"
               << "\nSystem Tuning Options:\n"
               << "  --cpus LIST         Pin to specific CPUs (e.g., 0,1,2 or 0-3 or 0,2-4)\n"
               << "  --numa-node N       Bind to NUMA node N\n"
@@ -37,10 +71,28 @@ void print_usage() {
               << "  # Full isolation for low-latency testing\n"
               << "  sudo risk_benchmark --isolate --realtime --cpus 2-5\n"
               << "\n"
+              << "  # Resident service, driven by risk_client\n"
+              << "  risk_benchmark --serve /tmp/risk.sock --positions 50000\n"
+              << "\n"
               << "  # With Solarflare Onload (run externally)\n"
               << "  onload risk_benchmark --isolate\n";
 }
 
+// "uniform" is the parallel generator's default profile; "skewed" models a
+// book concentrated in a few names with a short-dated expiry ladder.
+trading::BookProfile make_book_profile(const std::string& name) {
+    trading::BookProfile profile;
+    if (name == "skewed") {
+        profile.num_symbols = 2000;
+        profile.symbol_skew = 1.1;
+        profile.call_fraction = 0.4;
+        profile.put_fraction = 0.3;
+        profile.expiry_profile = {{1.0 / 12.0, 1.0}, {0.25, 2.0}, {0.5, 2.0},
+                                  {1.0, 1.5}, {2.0, 0.5}};
+    }
+    return profile;
+}
+
 void print_header(int num_positions, int num_simulations, int num_threads) {
     std::cout << "\n";
     std::cout << "=== Trading System CPU Benchmark ===\n";
@@ -54,12 +106,193 @@ void print_section(const std::string& name) {
     std::cout << name << ":\n";
 }
 
+void print_solve_stats(const trading::ImpliedVolBatchResult& result,
+                       double elapsed_ms) {
+    double solves_per_sec = result.num_solved / (elapsed_ms / 1000.0);
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Solves/sec:      " << std::setw(8) << solves_per_sec
+              << " (" << result.num_solved << " solved, "
+              << result.num_failed << " failed)\n";
+    std::cout << "  Iterations:     ";
+    for (size_t k = 0; k < result.iteration_histogram.size(); ++k) {
+        if (result.iteration_histogram[k] > 0) {
+            std::cout << " " << k << ":" << result.iteration_histogram[k];
+        }
+    }
+    std::cout << "\n";
+}
+
+// Reprices every option at a few shifted spots, timing each call on its
+// own between serialized clock reads, less the clock's own overhead.
+template <typename PriceFn>
+trading::LatencyHistogram measure_reprice_latency(
+    const std::vector<trading::Position>& positions, PriceFn price_fn) {
+    std::vector<size_t> options;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (positions[i].type != trading::PositionType::STOCK) {
+            options.push_back(i);
+        }
+    }
+
+    trading::LatencyHistogram hist;
+    volatile double sink = 0.0;
+    int64_t clock_overhead = static_cast<int64_t>(trading::TscClock::overhead_ns());
+    for (double shift : {-0.02, -0.005, 0.01, 0.03}) {
+        for (size_t i : options) {
+            double spot = positions[i].price * (1.0 + shift);
+            uint64_t start = trading::TscClock::start();
+            double price = price_fn(i, spot);
+            uint64_t stop = trading::TscClock::stop();
+            sink = sink + price;
+            hist.record(std::max<int64_t>(
+                trading::TscClock::to_ns(stop - start) - clock_overhead, 0));
+        }
+    }
+    return hist;
+}
+
+void print_latency_percentiles(const trading::LatencyHistogram& hist) {
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Latency p50:     " << std::setw(10)
+              << hist.value_at_percentile(50.0) / 1000.0 << " us\n";
+    std::cout << "  Latency p99:     " << std::setw(10)
+              << hist.value_at_percentile(99.0) / 1000.0 << " us\n";
+    std::cout << "  Latency p99.9:   " << std::setw(10)
+              << hist.value_at_percentile(99.9) / 1000.0 << " us\n";
+    std::cout << "  Latency max:     " << std::setw(10)
+              << hist.max() / 1000.0 << " us\n";
+}
+
+// Firm/desk/book/account/symbol rollup over 8 desks x 8 books x 32 accounts.
+// symbol_ids are the book's interned ids; accounts do not change them.
+void run_hierarchy_benchmark(std::vector<trading::Position> positions,
+                             const std::vector<uint32_t>& symbol_ids,
+                             int num_threads) {
+    auto hierarchy = trading::make_synthetic_hierarchy(8, 8, 32);
+    trading::assign_random_accounts(&positions, hierarchy.num_accounts());
+    trading::HierarchyAggregation result;
+
+    auto single = trading::run_benchmark("Hierarchy Single", [&]() {
+        result = trading::aggregate_hierarchy_single(positions, symbol_ids, hierarchy);
+        return result.firm.notional;
+    });
+    auto multi = trading::run_benchmark("Hierarchy Multi", [&]() {
+        result = trading::aggregate_hierarchy_multi(positions, symbol_ids, hierarchy,
+                                                    num_threads);
+        return result.firm.notional;
+    });
+
+    trading::print_comparison(single, multi);
+    std::cout << "  Nodes:           " << hierarchy.num_desks() << " desks, "
+              << hierarchy.num_books() << " books, " << hierarchy.num_accounts()
+              << " accounts, " << result.by_account_symbol.size()
+              << " account/symbol\n";
+}
+
+// Aggregation strategies across symbol cardinalities; the book grows to
+// at least two positions per symbol.
+void run_aggregation_sweep(int num_positions, int num_threads) {
+    print_section("Aggregation Sweep (ms)");
+    std::cout << "  " << std::setw(9) << "Symbols" << std::setw(11) << "Positions"
+              << std::setw(13) << "Private map" << std::setw(10) << "Sharded"
+              << std::setw(9) << "+Merge" << std::setw(12) << "Concurrent" << "\n";
+
+    for (size_t num_symbols : {100, 1000, 10000, 100000, 1000000}) {
+        size_t count = std::max<size_t>(num_positions, 2 * num_symbols);
+        auto positions = trading::generate_random_positions(count, 42, num_symbols);
+
+        auto private_map = trading::run_benchmark("Private Map", [&]() {
+            return trading::aggregate_positions_multi(positions, num_threads)
+                .net_exposure;
+        });
+        // Sharded: parallel passes only, results left in the shards.
+        // +Merge: the serial flatten into one map, timed on its own.
+        auto sharded = trading::run_benchmark("Sharded", [&]() {
+            return trading::aggregate_positions_into_shards(positions, num_threads)
+                .net_exposure;
+        });
+        auto shards = trading::aggregate_positions_into_shards(positions, num_threads);
+        auto merge = trading::run_benchmark("Merge", [&]() {
+            return static_cast<double>(shards.flatten().by_symbol.size());
+        });
+        auto concurrent = trading::run_benchmark("Concurrent", [&]() {
+            return trading::aggregate_positions_concurrent(positions, num_threads,
+                                                           num_symbols)
+                .net_exposure;
+        });
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  " << std::setw(9) << num_symbols << std::setw(11) << count
+                  << std::setw(13) << private_map.elapsed_ms
+                  << std::setw(10) << sharded.elapsed_ms
+                  << std::setw(9) << merge.elapsed_ms
+                  << std::setw(12) << concurrent.elapsed_ms << "\n";
+    }
+    std::cout << "\n";
+
+    print_section("Hierarchical Aggregation (1M positions, 5 levels)");
+    auto hierarchy_book = trading::generate_random_positions(1000000, 42, 5000);
+    trading::SymbolTable hierarchy_symbols;
+    auto hierarchy_ids = trading::intern_symbols(hierarchy_book, &hierarchy_symbols);
+    run_hierarchy_benchmark(std::move(hierarchy_book), hierarchy_ids, num_threads);
+    std::cout << "\n";
+}
+
+// Average cost of one evaluation over a sweep of inputs.
+template <typename Fn>
+double ns_per_call(const std::vector<double>& xs, Fn fn) {
+    trading::Timer timer;
+    volatile double sink = fn();
+    (void)sink;
+    return static_cast<double>(timer.elapsed_ns()) / xs.size();
+}
+
+template <typename Policy>
+void print_normal_timings(const std::string& label,
+                          const std::vector<double>& xs,
+                          std::vector<double>& out) {
+    double cdf_scalar = ns_per_call(xs, [&]() {
+        double sum = 0.0;
+        for (double x : xs) sum += Policy::cdf(x);
+        return sum;
+    });
+    double cdf_batch = ns_per_call(xs, [&]() {
+        trading::normal_cdf_batch<Policy>(xs.data(), out.data(), xs.size());
+        return out[xs.size() / 2];
+    });
+    double pdf_scalar = ns_per_call(xs, [&]() {
+        double sum = 0.0;
+        for (double x : xs) sum += Policy::pdf(x);
+        return sum;
+    });
+    double pdf_batch = ns_per_call(xs, [&]() {
+        trading::normal_pdf_batch<Policy>(xs.data(), out.data(), xs.size());
+        return out[xs.size() / 2];
+    });
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  " << label << " CDF:   " << std::setw(6) << cdf_scalar
+              << " scalar " << std::setw(6) << cdf_batch << " batch\n";
+    std::cout << "  " << label << " PDF:   " << std::setw(6) << pdf_scalar
+              << " scalar " << std::setw(6) << pdf_batch << " batch\n";
+}
+
 int main(int argc, char* argv[]) {
     int num_positions = 10000;
     int num_simulations = 100000;
     int num_threads = std::thread::hardware_concurrency();
     trading::SystemConfig sys_config;
     bool show_sysinfo = false;
+    std::string serve_path;
+    double tick_rate = 1e6;
+    int pricing_cpu = -1;
+    std::string latency_csv_path;
+    bool agg_sweep = false;
+    std::string book_profile = "legacy";
+    std::string isa_override;
+    std::string precision = "double";
+    std::string mc_checkpoint_path;
+    size_t stream_mb = 64;
 
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
@@ -71,6 +304,35 @@ int main(int argc, char* argv[]) {
             num_simulations = std::stoi(argv[++i]);
         } else if (arg == "--threads" && i + 1 < argc) {
             num_threads = std::stoi(argv[++i]);
+        } else if (arg == "--tick-rate" && i + 1 < argc) {
+            tick_rate = std::stod(argv[++i]);
+        } else if (arg == "--pricing-cpu" && i + 1 < argc) {
+            pricing_cpu = std::stoi(argv[++i]);
+        } else if (arg == "--latency-csv" && i + 1 < argc) {
+            latency_csv_path = argv[++i];
+        } else if (arg == "--book" && i + 1 < argc) {
+            book_profile = argv[++i];
+            if (book_profile != "legacy" && book_profile != "uniform" &&
+                book_profile != "skewed") {
+                std::cerr << "Unknown book profile: " << book_profile << "\n";
+                return 1;
+            }
+        } else if (arg == "--agg-sweep") {
+            agg_sweep = true;
+        } else if (arg == "--isa" && i + 1 < argc) {
+            isa_override = argv[++i];
+        } else if (arg == "--mc-checkpoint" && i + 1 < argc) {
+            mc_checkpoint_path = argv[++i];
+        } else if (arg == "--stream-mb" && i + 1 < argc) {
+            stream_mb = std::stoul(argv[++i]);
+        } else if (arg == "--precision" && i + 1 < argc) {
+            precision = argv[++i];
+            if (precision != "double" && precision != "float") {
+                std::cerr << "Unknown precision: " << precision << "\n";
+                return 1;
+            }
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serve_path = argv[++i];
         }
         // System tuning options
         else if (arg == "--cpus" && i + 1 < argc) {
@@ -126,33 +388,350 @@ int main(int argc, char* argv[]) {
         std::cout << "\n";
     }
 
+    if (!isa_override.empty()) {
+        trading::IsaLevel level;
+        if (!trading::parse_isa_level(isa_override, &level)) {
+            std::cerr << "Unknown ISA level: " << isa_override << "\n";
+            return 1;
+        }
+        if (!trading::set_isa_level(level)) {
+            std::cerr << "ISA level " << trading::isa_level_name(level)
+                      << " is not compiled in or not supported by this CPU\n";
+            return 1;
+        }
+    }
+
     print_header(num_positions, num_simulations, num_threads);
+    std::cout << "Kernels: " << trading::isa_level_name(trading::selected_isa_level())
+              << " (CPU supports " << trading::isa_level_name(trading::detect_isa_level())
+              << ")\n";
+    bool use_float = (precision == "float");
+    std::cout << "Precision: "
+              << (use_float ? "float kernels, double accumulation" : "double") << "\n";
+
+    if (trading::TscClock::source() == trading::TscClock::Source::TSC) {
+        std::cout << "Clock: invariant TSC at " << std::fixed << std::setprecision(3)
+                  << trading::TscClock::ticks_per_ns() << " GHz";
+    } else {
+        std::cout << "Clock: steady_clock (TSC not invariant)";
+    }
+    std::cout << std::setprecision(1) << ", " << trading::TscClock::overhead_ns()
+              << " ns read overhead\n\n";
 
-    std::cout << "Generating " << num_positions << " random positions...\n";
+    if (agg_sweep) {
+        run_aggregation_sweep(num_positions, num_threads);
+        return 0;
+    }
+
+    std::cout << "Generating " << num_positions << " random positions ("
+              << book_profile << " book)...\n";
+    // The book is interned once here; every symbol-id path below (rollup,
+    // hierarchy, fused pipeline) reuses book.symbols and book.symbol_ids.
     trading::Timer gen_timer;
-    auto positions = trading::generate_random_positions(num_positions, 42);
+    trading::GeneratedBook book;
+    if (book_profile == "legacy") {
+        book.positions = trading::generate_random_positions(num_positions, 42);
+        book.symbol_ids = trading::intern_symbols(book.positions, &book.symbols);
+    } else {
+        book = trading::generate_book(num_positions, make_book_profile(book_profile),
+                                      42, num_threads);
+    }
+    std::vector<trading::Position>& positions = book.positions;
+    const trading::SymbolTable& symbol_table = book.symbols;
+    const std::vector<uint32_t>& symbol_ids = book.symbol_ids;
     std::cout << "Generated in " << std::fixed << std::setprecision(1)
               << gen_timer.elapsed_ms() << " ms\n\n";
 
+    if (!serve_path.empty()) {
+        trading::RiskServiceConfig service_config;
+        service_config.socket_path = serve_path;
+        service_config.num_threads = num_threads;
+        trading::RiskService service(std::move(positions), service_config);
+
+        trading::Timer warmup_timer;
+        if (!service.start()) {
+            return 1;
+        }
+        std::cout << "Warm-up completed in " << std::fixed << std::setprecision(1)
+                  << warmup_timer.elapsed_ms() << " ms\n";
+        std::cout << "Serving on " << serve_path << " (send SHUTDOWN to stop)\n";
+        service.run();
+        std::cout << "Service stopped\n";
+        return 0;
+    }
+
+    // Normal CDF/PDF policies
+    print_section("Normal Distribution (ns/call)");
+    std::vector<double> normal_inputs(1 << 20);
+    for (size_t i = 0; i < normal_inputs.size(); ++i) {
+        normal_inputs[i] = -6.0 + 12.0 * i / normal_inputs.size();
+    }
+    std::vector<double> normal_outputs(normal_inputs.size());
+    print_normal_timings<trading::PreciseNormal>("Precise", normal_inputs,
+                                                 normal_outputs);
+    print_normal_timings<trading::FastNormal>("Fast   ", normal_inputs,
+                                              normal_outputs);
+    std::cout << "\n";
+
     // Monte Carlo VaR
-    print_section("Monte Carlo VaR");
+    print_section(use_float ? "Monte Carlo VaR (float)" : "Monte Carlo VaR");
     trading::VaRResult var_result;
 
     auto mc_single = trading::run_benchmark("MC Single", [&]() {
-        var_result = trading::run_monte_carlo_single(
-            positions, num_simulations, 1.0/252.0, 42);
+        var_result = use_float
+            ? trading::run_monte_carlo_single<float>(
+                  positions, num_simulations, 1.0/252.0, 42)
+            : trading::run_monte_carlo_single(
+                  positions, num_simulations, 1.0/252.0, 42);
         return var_result.var_99;
     });
 
     auto mc_multi = trading::run_benchmark("MC Multi", [&]() {
-        var_result = trading::run_monte_carlo_multi(
-            positions, num_simulations, 1.0/252.0, num_threads, 42);
+        var_result = use_float
+            ? trading::run_monte_carlo_multi<float>(
+                  positions, num_simulations, 1.0/252.0, num_threads, 42)
+            : trading::run_monte_carlo_multi(
+                  positions, num_simulations, 1.0/252.0, num_threads, 42);
         return var_result.var_99;
     });
 
     trading::print_comparison(mc_single, mc_multi);
     std::cout << "\n";
 
+    // Chunked Monte Carlo: fixed-size batches folded into a 5% tail buffer,
+    // optionally checkpointed so a long run can resume after a crash
+    print_section("Chunked Monte Carlo (batched, resumable)");
+    trading::ChunkedMcConfig chunked_config;
+    chunked_config.num_simulations = num_simulations;
+    chunked_config.batch_size = 8192;
+    chunked_config.num_threads = num_threads;
+    chunked_config.checkpoint_path = mc_checkpoint_path;
+    chunked_config.checkpoint_every = 4;
+    try {
+        trading::ChunkedMcResult chunked;
+        auto chunked_timed = trading::run_benchmark("MC Chunked", [&]() {
+            chunked = trading::run_monte_carlo_chunked(
+                trading::prepare_mc_inputs(positions, 1.0/252.0), chunked_config);
+            return chunked.var.var_99;
+        });
+        size_t tail_bytes = trading::PnlTail::capacity_for(num_simulations) * sizeof(double);
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  Multi-threaded:  " << std::setw(8) << chunked_timed.elapsed_ms
+                  << " ms, " << std::setprecision(0)
+                  << (chunked.scenarios_done - chunked.resumed_from) /
+                         std::max(chunked_timed.elapsed_ms / 1000.0, 1e-9)
+                  << " scenarios/s\n";
+        std::cout << "  Tail buffer:     " << std::setw(8) << tail_bytes / 1024
+                  << " KiB (full P&L " << num_simulations * sizeof(double) / 1024
+                  << " KiB)\n";
+        std::cout << std::setprecision(2);
+        std::cout << "  VaR (99%):       $" << std::setw(12) << chunked.var.var_99
+                  << ", ES $" << chunked.var.expected_shortfall << "\n";
+        if (!mc_checkpoint_path.empty()) {
+            std::cout << "  Checkpoints:     " << chunked.checkpoints_written
+                      << " written to " << mc_checkpoint_path;
+            if (chunked.resumed_from > 0) {
+                std::cout << ", resumed at scenario " << chunked.resumed_from;
+            }
+            std::cout << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cout << "  Skipped: " << e.what() << "\n";
+    }
+    std::cout << "\n";
+
+    // Pipelined Monte Carlo: producers fill shock buffers while consumers
+    // price the previous ones. Stall fractions show which side is short of
+    // threads for a given split.
+    print_section("Pipelined Monte Carlo (RNG producers / pricing consumers)");
+    {
+        auto mc_inputs = trading::prepare_mc_inputs(positions, 1.0/252.0);
+        int pipeline_threads = std::max(num_threads, 2);
+        std::vector<int> producer_counts = {1, pipeline_threads / 4, pipeline_threads / 2,
+                                            3 * pipeline_threads / 4};
+        std::sort(producer_counts.begin(), producer_counts.end());
+        producer_counts.erase(std::unique(producer_counts.begin(), producer_counts.end()),
+                              producer_counts.end());
+
+        std::vector<double> fused(num_simulations);
+        auto fused_timed = trading::run_benchmark("MC Fused", [&]() {
+            trading::simulate_pnl_scenarios(mc_inputs, 42, 0, fused.size(), fused.data());
+            return fused.empty() ? 0.0 : fused[0];
+        });
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  Fused, 1 thread:  " << std::setw(8) << fused_timed.elapsed_ms << " ms\n";
+
+        for (int producers : producer_counts) {
+            if (producers < 1 || producers >= pipeline_threads) continue;
+            trading::PipelinedMcConfig pipeline_config;
+            pipeline_config.num_simulations = num_simulations;
+            pipeline_config.num_producers = producers;
+            pipeline_config.num_consumers = pipeline_threads - producers;
+            trading::PipelinedMcResult pipelined;
+            auto timed = trading::run_benchmark("MC Pipelined", [&]() {
+                pipelined = trading::run_monte_carlo_pipelined(mc_inputs, pipeline_config);
+                return pipelined.var.var_99;
+            });
+            std::cout << "  " << std::setw(2) << producers << "P / " << std::setw(2)
+                      << pipeline_config.num_consumers << "C:       " << std::setw(8)
+                      << timed.elapsed_ms << " ms, stalls: producer "
+                      << std::setw(5) << 100.0 * pipelined.stats.producer_stall_fraction
+                      << "%, consumer " << std::setw(5)
+                      << 100.0 * pipelined.stats.consumer_stall_fraction << "% ("
+                      << pipelined.stats.buffers_handed_off << " buffers of "
+                      << pipelined.stats.scenarios_per_buffer << " scenarios)\n";
+        }
+    }
+    std::cout << "\n";
+
+    // VaR attribution: component VaR/ES per position and symbol from a
+    // replay of the tail scenarios only
+    print_section("VaR Attribution (component VaR / ES)");
+    {
+        trading::VaRAttributionConfig attribution_config;
+        attribution_config.num_simulations = num_simulations;
+        attribution_config.num_threads = num_threads;
+        trading::VaRAttribution attribution;
+        auto timed = trading::run_benchmark("VaR Attribution", [&]() {
+            attribution = trading::attribute_var(positions, attribution_config);
+            return attribution.portfolio.var_99;
+        });
+        double matrix_mb = static_cast<double>(num_simulations) * positions.size() *
+                           sizeof(double) / (1024.0 * 1024.0);
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  Multi-threaded:  " << std::setw(8) << timed.elapsed_ms << " ms, "
+                  << attribution.tracked_scenarios << " of " << num_simulations
+                  << " scenarios replayed (full matrix would be " << matrix_mb << " MB)\n";
+
+        std::vector<uint32_t> ranked(attribution.by_symbol.size());
+        for (uint32_t id = 0; id < ranked.size(); ++id) ranked[id] = id;
+        std::sort(ranked.begin(), ranked.end(), [&](uint32_t a, uint32_t b) {
+            return attribution.by_symbol[a].es > attribution.by_symbol[b].es;
+        });
+        double es = attribution.portfolio.expected_shortfall;
+        std::cout << "  Top symbols by component ES (ES $" << std::setprecision(2) << es
+                  << ", VaR99 $" << attribution.portfolio.var_99 << "):\n";
+        for (size_t k = 0; k < std::min<size_t>(5, ranked.size()); ++k) {
+            const auto& risk = attribution.by_symbol[ranked[k]];
+            std::cout << "    " << std::left << std::setw(8)
+                      << attribution.symbols.name(ranked[k]) << std::right
+                      << " ES $" << std::setw(12) << risk.es
+                      << " (" << std::setw(5) << std::setprecision(1)
+                      << (es != 0.0 ? 100.0 * risk.es / es : 0.0) << "%)"
+                      << "  VaR99 $" << std::setw(12) << std::setprecision(2)
+                      << risk.var_99 << "\n";
+        }
+    }
+    std::cout << "\n";
+
+    // Incremental VaR: cached scenario P&L, one slot re-evaluated per
+    // trade, quantiles by partial selection
+    print_section("Incremental VaR (pre-trade what-if)");
+    {
+        std::unique_ptr<trading::IncrementalVaR<>> built;
+        auto build = trading::run_benchmark("Incremental Build", [&]() {
+            built = std::make_unique<trading::IncrementalVaR<>>(
+                positions, num_simulations, 1.0/252.0, 42, num_threads);
+            return built->var().var_99;
+        });
+        trading::IncrementalVaR<>& engine = *built;
+        trading::IncrementalVaR<float> compact(positions, num_simulations, 1.0/252.0,
+                                               42, num_threads);
+
+        const size_t kTrades = 20;
+        auto trades = trading::generate_random_positions(kTrades, 2024);
+        double what_if_var = 0.0;
+        auto what_if = trading::run_benchmark("What-if", [&]() {
+            for (size_t k = 0; k < kTrades; ++k) {
+                what_if_var += engine.what_if_replace(k % engine.num_slots(), trades[k]).var_99;
+            }
+            return what_if_var;
+        });
+        auto float_what_if = trading::run_benchmark("What-if (float cache)", [&]() {
+            double sum = 0.0;
+            for (size_t k = 0; k < kTrades; ++k) {
+                sum += compact.what_if_replace(k % compact.num_slots(), trades[k]).var_99;
+            }
+            return sum;
+        });
+        // The full re-run this engine would otherwise do: the same
+        // scenarios re-priced for the whole book.
+        auto full_rerun = trading::run_benchmark("Full Re-run", [&]() {
+            engine.rebuild();
+            return engine.var().var_99;
+        });
+        auto apply = trading::run_benchmark("Apply Trades", [&]() {
+            for (size_t k = 0; k < kTrades; ++k) {
+                engine.replace(k % engine.num_slots(), trades[k]);
+            }
+            return engine.var().var_99;
+        });
+
+        double per_check = what_if.elapsed_ms / kTrades;
+        std::cout << std::fixed << std::setprecision(3);
+        std::cout << "  Build cache:     " << std::setw(10) << build.elapsed_ms << " ms ("
+                  << num_simulations * sizeof(double) / 1024 << " KiB double, "
+                  << num_simulations * sizeof(float) / 1024 << " KiB float)\n";
+        std::cout << "  Full re-run:     " << std::setw(10) << full_rerun.elapsed_ms
+                  << " ms (rebuild)\n";
+        std::cout << "  What-if check:   " << std::setw(10) << per_check << " ms ("
+                  << std::setprecision(0) << full_rerun.elapsed_ms / per_check
+                  << "x faster than a full re-run)\n";
+        std::cout << std::setprecision(3);
+        std::cout << "  What-if (float): " << std::setw(10)
+                  << float_what_if.elapsed_ms / kTrades << " ms\n";
+        std::cout << "  Apply trade:     " << std::setw(10) << apply.elapsed_ms / kTrades
+                  << " ms\n";
+    }
+    std::cout << "\n";
+
+    // Steady-state reuse: the same Greeks / MC / aggregation cycle with
+    // fresh results every time versus caller buffers on a RiskWorkspace
+    print_section("Steady-State Reuse (RiskWorkspace)");
+    {
+        const int kRounds = 5;
+        const size_t workspace_sims = std::min<size_t>(num_simulations, 20000);
+        auto mc_inputs = trading::prepare_mc_inputs(positions, 1.0/252.0);
+        auto fresh = trading::run_benchmark("Fresh Results", [&]() {
+            double sum = 0.0;
+            for (int round = 0; round < kRounds; ++round) {
+                auto greeks = trading::calculate_all_greeks_multi(positions, num_threads);
+                auto var = trading::run_monte_carlo_multi(mc_inputs, workspace_sims,
+                                                          num_threads, 42 + round);
+                auto agg = trading::aggregate_positions_multi(positions, num_threads);
+                sum += greeks[0].price + var.var_99 + agg.net_exposure;
+            }
+            return sum;
+        });
+
+        trading::RiskWorkspace workspace(num_threads);
+        std::vector<trading::Greeks> greeks(positions.size());
+        trading::AggregationResult exposure{};
+        auto cycle = [&](unsigned int seed) {
+            trading::calculate_all_greeks_multi(positions, workspace, greeks.data());
+            auto var = trading::run_monte_carlo_multi(mc_inputs, workspace_sims, workspace, seed);
+            trading::aggregate_positions_multi(positions, workspace, &exposure);
+            return greeks[0].price + var.var_99 + exposure.net_exposure;
+        };
+        cycle(41);  // Warm-up grows the workspace once
+        auto reused = trading::run_benchmark("Workspace", [&]() {
+            double sum = 0.0;
+            for (int round = 0; round < kRounds; ++round) {
+                sum += cycle(42 + round);
+            }
+            return sum;
+        });
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  " << kRounds << " rounds of Greeks + MC VaR (" << workspace_sims
+                  << " sims) + aggregation:\n";
+        std::cout << "  Fresh results:   " << std::setw(8) << fresh.elapsed_ms << " ms\n";
+        std::cout << "  Workspace:       " << std::setw(8) << reused.elapsed_ms << " ms ("
+                  << std::setprecision(2) << fresh.elapsed_ms / reused.elapsed_ms
+                  << "x, no allocation after warm-up)\n";
+    }
+    std::cout << "\n";
+
     // Greeks Calculation
     print_section("Greeks Calculation");
     double total_delta = 0.0;
@@ -170,8 +749,114 @@ int main(int argc, char* argv[]) {
     });
 
     trading::print_comparison(greeks_single, greeks_multi);
+
+    // Single-option cost between serialized reads, less the clock's own
+    trading::LatencyHistogram option_latency;
+    volatile double greeks_sink = 0.0;
+    double clock_overhead = trading::TscClock::overhead_ns();
+    for (const auto& pos : positions) {
+        if (pos.type == trading::PositionType::STOCK) continue;
+        uint64_t start = trading::TscClock::start();
+        trading::Greeks g = trading::calculate_greeks(pos);
+        uint64_t stop = trading::TscClock::stop();
+        greeks_sink = greeks_sink + g.delta;
+        option_latency.record(std::max<int64_t>(
+            trading::TscClock::to_ns(stop - start) -
+                static_cast<int64_t>(clock_overhead), 0));
+    }
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Per option:      " << std::setw(8)
+              << option_latency.value_at_percentile(50.0) << " ns p50, "
+              << option_latency.value_at_percentile(99.0) << " ns p99\n";
+    std::cout << "\n";
+
+    // Type-Specialized Greeks: runtime type dispatch over the mixed book,
+    // over a copy sorted by type, and per-type kernels over a partition
+    print_section("Type-Specialized Greeks");
+    std::vector<trading::Position> sorted_book = positions;
+    std::stable_sort(sorted_book.begin(), sorted_book.end(),
+                     [](const trading::Position& a, const trading::Position& b) {
+                         return a.type < b.type;
+                     });
+    trading::TypePartition partition = trading::partition_by_type(positions);
+    trading::PerfCounter branch_misses(trading::PerfCounter::Event::BRANCH_MISSES);
+
+    auto print_kernel = [&](const std::string& label, auto&& kernel) {
+        branch_misses.start();
+        auto timed = trading::run_benchmark(label, kernel);
+        uint64_t misses = branch_misses.stop();
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  " << label << std::setw(8) << timed.elapsed_ms << " ms";
+        if (branch_misses.available()) {
+            std::cout << ", " << std::setprecision(3)
+                      << static_cast<double>(misses) / positions.size()
+                      << " branch misses/position";
+        }
+        std::cout << "\n";
+    };
+    print_kernel("Mixed book:      ", [&]() {
+        return trading::calculate_all_greeks_single(positions)[0].price;
+    });
+    print_kernel("Sorted book:     ", [&]() {
+        return trading::calculate_all_greeks_single(sorted_book)[0].price;
+    });
+    print_kernel("Partitioned:     ", [&]() {
+        return trading::calculate_all_greeks_partitioned_single(positions, partition)[0].price;
+    });
+    if (!branch_misses.available()) {
+        std::cout << "  (branch-miss counter unavailable; check perf_event_paranoid)\n";
+    }
     std::cout << "\n";
 
+    // ISA Variants: the dispatched kernels at every level this CPU can run;
+    // '*' marks the one the rest of the run uses
+    print_section("ISA Variants (partitioned Greeks, FastNormal CDF)");
+    trading::IsaLevel selected_isa = trading::selected_isa_level();
+    for (trading::IsaLevel level : {trading::IsaLevel::BASELINE, trading::IsaLevel::X86_64_V2,
+                                    trading::IsaLevel::X86_64_V3, trading::IsaLevel::X86_64_V4}) {
+        if (!trading::set_isa_level(level)) continue;
+        auto greeks_timed = trading::run_benchmark("ISA Greeks", [&]() {
+            return trading::calculate_all_greeks_isa_single(positions, partition)[0].price;
+        });
+        auto cdf_timed = trading::run_benchmark("ISA CDF", [&]() {
+            trading::normal_cdf_batch_isa(normal_inputs.data(), normal_outputs.data(),
+                                          normal_inputs.size());
+            return normal_outputs[normal_inputs.size() / 2];
+        });
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  " << (level == selected_isa ? '*' : ' ') << " "
+                  << std::left << std::setw(10) << trading::isa_level_name(level)
+                  << std::right << " Greeks " << std::setw(8) << greeks_timed.elapsed_ms
+                  << " ms, CDF " << std::setprecision(2)
+                  << cdf_timed.elapsed_ms * 1e6 / normal_inputs.size() << " ns/call\n";
+    }
+    trading::set_isa_level(selected_isa);
+    std::cout << "\n";
+
+    // Greeks Rollup: priced and bucketed in the same traversal
+    print_section("Greeks Rollup (symbol/expiry/strike)");
+    trading::GreeksRollup rollup;
+
+    auto rollup_single = trading::run_benchmark("Rollup Single", [&]() {
+        rollup = trading::calculate_greeks_rollup_single(
+            positions, symbol_ids, symbol_table.size());
+        return rollup.total.delta;
+    });
+
+    auto rollup_multi = trading::run_benchmark("Rollup Multi", [&]() {
+        rollup = trading::calculate_greeks_rollup_multi(
+            positions, symbol_ids, symbol_table.size(), num_threads);
+        return rollup.total.delta;
+    });
+
+    trading::print_comparison(rollup_single, rollup_multi);
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Delta by expiry:";
+    for (const auto& bucket : rollup.by_expiry) {
+        std::cout << " " << bucket.delta;
+    }
+    std::cout << "\n\n";
+
     // Position Aggregation
     print_section("Position Aggregation");
     trading::AggregationResult agg_result;
@@ -187,6 +872,449 @@ int main(int argc, char* argv[]) {
     });
 
     trading::print_comparison(agg_single, agg_multi);
+
+    // Top-N dashboard query: heap selection vs the incrementally ranked index
+    constexpr size_t kTopN = 20;
+    constexpr int kTopQueries = 200;
+    trading::TopExposureIndex top_index(agg_result);
+    double top_select_us = 0.0;
+    double top_multi_us = 0.0;
+    double top_index_us = 0.0;
+    {
+        trading::Timer timer;
+        for (int q = 0; q < kTopQueries; ++q) {
+            trading::get_top_exposures(agg_result, kTopN);
+        }
+        top_select_us = timer.elapsed_ns() / 1000.0 / kTopQueries;
+        timer.reset();
+        for (int q = 0; q < kTopQueries; ++q) {
+            trading::get_top_exposures_multi(agg_result, kTopN, num_threads);
+        }
+        top_multi_us = timer.elapsed_ns() / 1000.0 / kTopQueries;
+        timer.reset();
+        for (int q = 0; q < kTopQueries; ++q) {
+            top_index.top(kTopN);
+        }
+        top_index_us = timer.elapsed_ns() / 1000.0 / kTopQueries;
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Top-" << kTopN << " select:    " << std::setw(8) << top_select_us
+              << " us/query (" << agg_result.by_symbol.size() << " symbols)\n";
+    std::cout << "  Top-" << kTopN << " sharded:   " << std::setw(8) << top_multi_us
+              << " us/query\n";
+    std::cout << "  Top-" << kTopN << " index:     " << std::setw(8) << top_index_us
+              << " us/query\n";
+    std::cout << "\n";
+
+    print_section("Hierarchical Aggregation (firm/desk/book/account/symbol)");
+    run_hierarchy_benchmark(positions, symbol_ids, num_threads);
+    std::cout << "\n";
+
+    // Deterministic Reduction: cost of fixed-shape and compensated sums, and
+    // whether the result survives a change of thread count bit for bit
+    print_section("Deterministic Reduction");
+    std::vector<double> notionals(std::max<size_t>(positions.size(), 1 << 22));
+    for (size_t i = 0; i < notionals.size(); ++i) {
+        const auto& pos = positions[i % positions.size()];
+        notionals[i] = pos.quantity * pos.price;
+    }
+    std::cout << std::fixed << std::setprecision(2);
+    for (auto [label, mode] : {std::make_pair("Naive   ", trading::Summation::NAIVE),
+                               std::make_pair("Pairwise", trading::Summation::PAIRWISE),
+                               std::make_pair("Neumaier", trading::Summation::NEUMAIER)}) {
+        double reference = trading::parallel_reduce_sum(notionals.data(),
+                                                        notionals.size(), 1, mode);
+        trading::BenchmarkResult timed = trading::run_benchmark(label, [&]() {
+            return trading::parallel_reduce_sum(notionals.data(), notionals.size(),
+                                                num_threads, mode);
+        });
+        std::cout << "  Sum " << label << ":    " << std::setw(8) << timed.elapsed_ms
+                  << " ms (" << notionals.size() << " terms, "
+                  << (timed.result_value == reference ? "bitwise stable"
+                                                      : "differs from 1 thread")
+                  << ")\n";
+    }
+    for (auto [label, mode] : {std::make_pair("Pairwise", trading::Summation::PAIRWISE),
+                               std::make_pair("Neumaier", trading::Summation::NEUMAIER)}) {
+        double reference =
+            trading::aggregate_positions_deterministic(positions, 1, mode).net_exposure;
+        trading::BenchmarkResult timed = trading::run_benchmark(label, [&]() {
+            return trading::aggregate_positions_deterministic(positions, num_threads, mode)
+                .net_exposure;
+        });
+        std::cout << "  Agg " << label << ":    " << std::setw(8) << timed.elapsed_ms
+                  << " ms (" << (timed.result_value == reference ? "bitwise stable"
+                                                                  : "differs from 1 thread")
+                  << ")\n";
+    }
+    std::cout << "  Agg Multi:       " << std::setw(8) << agg_multi.elapsed_ms
+              << " ms (" << (agg_multi.result_value == agg_single.result_value
+                                 ? "matches single" : "differs from single")
+              << ")\n\n";
+
+    // Float vs Double: the same kernels at both precisions, with the float
+    // path's deviation from the double reference
+    if (use_float) {
+        print_section("Float vs Double (float kernels, double sums)");
+        std::cout << std::fixed;
+        auto greeks_double = trading::run_benchmark("Greeks double", [&]() {
+            auto greeks = trading::calculate_all_greeks_partitioned_multi(
+                positions, partition, num_threads);
+            return trading::total_portfolio_delta(greeks, positions);
+        });
+        auto greeks_float = trading::run_benchmark("Greeks float", [&]() {
+            auto greeks = trading::calculate_all_greeks_partitioned_multi<
+                trading::PreciseNormal, float>(positions, partition, num_threads);
+            return trading::total_portfolio_delta(greeks, positions);
+        });
+        auto agg_double = trading::run_benchmark("Agg double", [&]() {
+            return trading::aggregate_positions_deterministic(positions, num_threads)
+                .net_exposure;
+        });
+        auto agg_float = trading::run_benchmark("Agg float", [&]() {
+            return trading::aggregate_positions_deterministic<float>(positions, num_threads)
+                .net_exposure;
+        });
+        auto mc_double = trading::run_benchmark("MC double", [&]() {
+            return trading::run_monte_carlo_multi(
+                positions, num_simulations, 1.0/252.0, num_threads, 42).var_99;
+        });
+
+        auto print_pair = [](const std::string& label,
+                             const trading::BenchmarkResult& reference,
+                             const trading::BenchmarkResult& reduced) {
+            double diff = std::abs(reduced.result_value - reference.result_value);
+            std::cout << "  " << label << std::setprecision(1) << std::setw(8)
+                      << reference.elapsed_ms << " / " << std::setw(8) << reduced.elapsed_ms
+                      << " ms, |diff| " << std::setprecision(2) << diff << " ("
+                      << std::scientific << std::setprecision(1)
+                      << diff / std::max(std::abs(reference.result_value), 1e-300)
+                      << " rel)\n" << std::fixed;
+        };
+        std::cout << "                  double /    float\n";
+        print_pair("Portfolio delta:", greeks_double, greeks_float);
+        print_pair("Net exposure:   ", agg_double, agg_float);
+        print_pair("MC VaR (99%):   ", mc_double, mc_multi);
+        std::cout << "\n";
+    }
+
+    // Full Risk Run: separate rollup/aggregation/MC walks vs one fused pass
+    print_section("Full Risk Run (fused pipeline)");
+    trading::RiskPipelineResult pipeline;
+
+    auto separate_run = trading::run_benchmark("Separate Kernels", [&]() {
+        rollup = trading::calculate_greeks_rollup_multi(
+            positions, symbol_ids, symbol_table.size(), num_threads);
+        agg_result = trading::aggregate_positions_multi(positions, num_threads);
+        var_result = trading::run_monte_carlo_multi(
+            positions, num_simulations, 1.0/252.0, num_threads, 42);
+        return var_result.var_99;
+    });
+
+    auto fused_run = trading::run_benchmark("Fused Pipeline", [&]() {
+        pipeline = trading::run_risk_pipeline_multi(
+            positions, symbol_ids, symbol_table, 1.0/252.0, num_threads);
+        var_result = trading::run_monte_carlo_multi(
+            pipeline.mc_inputs, num_simulations, num_threads, 42);
+        return var_result.var_99;
+    });
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Separate:        " << std::setw(8) << separate_run.elapsed_ms
+              << " ms (rollup + aggregation + MC)\n";
+    std::cout << "  Fused:           " << std::setw(8) << fused_run.elapsed_ms
+              << " ms (" << separate_run.elapsed_ms / fused_run.elapsed_ms
+              << "x)\n\n";
+
+    // Scenario Grid: spot -20%..+20% in 1% steps x vol -5/0/+5 points
+    std::vector<double> spot_shocks;
+    for (int pct = -20; pct <= 20; ++pct) {
+        spot_shocks.push_back(pct / 100.0);
+    }
+    trading::ScenarioGrid scenario_grid;
+    scenario_grid.scenarios = trading::make_spot_vol_grid(
+        spot_shocks, {-0.05, 0.0, 0.05});
+
+    print_section("Scenario Grid (" +
+                  std::to_string(scenario_grid.scenarios.size()) +
+                  " scenarios)");
+    double worst_scenario_pnl = 0.0;
+
+    auto scen_single = trading::run_benchmark("Scenario Single", [&]() {
+        auto result = trading::run_scenarios_single(positions, scenario_grid);
+        worst_scenario_pnl = *std::min_element(result.portfolio_pnl.begin(),
+                                               result.portfolio_pnl.end());
+        return worst_scenario_pnl;
+    });
+
+    auto scen_multi = trading::run_benchmark("Scenario Multi", [&]() {
+        auto result = trading::run_scenarios_multi(positions, scenario_grid,
+                                                   num_threads);
+        worst_scenario_pnl = *std::min_element(result.portfolio_pnl.begin(),
+                                               result.portfolio_pnl.end());
+        return worst_scenario_pnl;
+    });
+
+    trading::print_comparison(scen_single, scen_multi);
+    std::cout << "\n";
+
+    // Implied Volatility: back out vols from model prices at the book's vols
+    print_section("Implied Volatility");
+    std::vector<double> market_prices;
+    market_prices.reserve(positions.size());
+    for (const auto& pos : positions) {
+        market_prices.push_back(trading::black_scholes_price(
+            pos.price, pos.strike, pos.volatility, pos.risk_free_rate,
+            pos.time_to_expiry, pos.type == trading::PositionType::OPTION_CALL));
+    }
+    trading::ImpliedVolBatchResult iv_result;
+
+    auto iv_single = trading::run_benchmark("IV Single", [&]() {
+        iv_result = trading::solve_implied_vols_single(positions, market_prices);
+        return static_cast<double>(iv_result.num_solved);
+    });
+
+    auto iv_multi = trading::run_benchmark("IV Multi", [&]() {
+        iv_result = trading::solve_implied_vols_multi(positions, market_prices,
+                                                      num_threads);
+        return static_cast<double>(iv_result.num_solved);
+    });
+
+    trading::print_comparison(iv_single, iv_multi);
+    print_solve_stats(iv_result, iv_multi.elapsed_ms);
+    std::cout << "\n";
+
+    // Pricing Tables: table lookup vs analytic repricing latency
+    print_section("Pricing Tables");
+    trading::PricingTableConfig table_config;
+    trading::Timer table_timer;
+    auto tables = trading::build_price_tables(positions, table_config,
+                                              num_threads);
+    double table_build_ms = table_timer.elapsed_ms();
+
+    double table_max_error = 0.0;
+    size_t table_nodes = 0;
+    size_t table_fallbacks = 0;
+    for (size_t i = 0; i < tables.size(); ++i) {
+        const auto& table = tables[i];
+        if (positions[i].type == trading::PositionType::STOCK) continue;
+        if (table.within_tolerance()) {
+            table_max_error = std::max(table_max_error, table.max_error());
+            table_nodes += table.num_nodes();
+        } else {
+            table_fallbacks++;
+        }
+    }
+
+    auto table_latency = measure_reprice_latency(
+        positions, [&](size_t i, double spot) { return tables[i].price(spot); });
+    auto analytic_latency = measure_reprice_latency(
+        positions, [&](size_t i, double spot) {
+            const auto& pos = positions[i];
+            return trading::black_scholes_price(
+                spot, pos.strike, pos.volatility, pos.risk_free_rate,
+                pos.time_to_expiry,
+                pos.type == trading::PositionType::OPTION_CALL);
+        });
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Build:           " << std::setw(8) << table_build_ms
+              << " ms (" << table_nodes << " nodes, max error "
+              << std::scientific << std::setprecision(1) << table_max_error
+              << ", " << table_fallbacks << " options priced analytically)\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Table lookup:    " << std::setw(8) << table_latency.mean()
+              << " ns/option (p99 " << table_latency.value_at_percentile(99.0)
+              << " ns)\n";
+    std::cout << "  Analytic:        " << std::setw(8) << analytic_latency.mean()
+              << " ns/option (p99 " << analytic_latency.value_at_percentile(99.0)
+              << " ns)\n";
+    std::cout << "\n";
+
+    // American Lattice: early-exercise Greeks on a sample of the options
+    std::vector<trading::Position> american_book;
+    for (const auto& pos : positions) {
+        if (pos.type != trading::PositionType::STOCK && american_book.size() < 500) {
+            american_book.push_back(pos);
+            american_book.back().exercise = trading::ExerciseStyle::AMERICAN;
+        }
+    }
+
+    print_section("American Lattice (" + std::to_string(american_book.size()) +
+                  " options)");
+    double american_delta = 0.0;
+
+    auto lattice_single = trading::run_benchmark("Lattice Single", [&]() {
+        auto greeks = trading::calculate_all_greeks_single(american_book);
+        american_delta = trading::total_portfolio_delta(greeks, american_book);
+        return american_delta;
+    });
+
+    auto lattice_multi = trading::run_benchmark("Lattice Multi", [&]() {
+        auto greeks = trading::calculate_all_greeks_multi(american_book, num_threads);
+        american_delta = trading::total_portfolio_delta(greeks, american_book);
+        return american_delta;
+    });
+
+    trading::print_comparison(lattice_single, lattice_multi);
+
+    for (int steps : {200, 500, 1000}) {
+        for (auto method : {trading::LatticeMethod::CRR,
+                            trading::LatticeMethod::LEISEN_REIMER}) {
+            trading::Timer steps_timer;
+            volatile double sink = 0.0;
+            for (const auto& pos : american_book) {
+                sink = sink + trading::lattice_price(
+                    pos.price, pos.strike, pos.volatility, pos.risk_free_rate,
+                    pos.time_to_expiry,
+                    pos.type == trading::PositionType::OPTION_CALL, true,
+                    steps, method);
+            }
+            double options_per_sec =
+                american_book.size() / steps_timer.elapsed_seconds();
+            std::cout << std::fixed << std::setprecision(0);
+            std::cout << "  " << (method == trading::LatticeMethod::CRR ? "CRR" : "LR ")
+                      << std::setw(5) << steps << " steps:  " << std::setw(9)
+                      << options_per_sec << " options/sec\n";
+        }
+    }
+    std::cout << "\n";
+
+    // Market Data: synthetic feeds -> rings -> pinned pricing thread
+    print_section("Market Data (tick-to-Greeks, PreciseNormal)");
+    trading::MarketDataConfig md_config;
+    md_config.num_feeds = 2;
+    md_config.pricing_cpu = pricing_cpu;
+    trading::MarketDataEngine md_engine(positions, md_config);
+
+    std::vector<trading::TickGeneratorResult> feed_results(md_config.num_feeds);
+    md_engine.start();
+    std::vector<std::thread> feed_threads;
+    for (size_t f = 0; f < md_config.num_feeds; ++f) {
+        feed_threads.emplace_back([&, f]() {
+            trading::TickGeneratorConfig gen;
+            gen.ticks_per_second = tick_rate / md_config.num_feeds;
+            gen.seed = 42 + static_cast<unsigned int>(f);
+            feed_results[f] = trading::run_synthetic_feed(md_engine, f, gen);
+        });
+    }
+    for (auto& t : feed_threads) {
+        t.join();
+    }
+    md_engine.stop();
+
+    uint64_t ticks_published = 0;
+    uint64_t ticks_dropped = 0;
+    double feed_seconds = 0.0;
+    for (const auto& r : feed_results) {
+        ticks_published += r.published;
+        ticks_dropped += r.dropped;
+        feed_seconds = std::max(feed_seconds, r.elapsed_seconds);
+    }
+    auto md_stats = md_engine.stats();
+
+    std::cout << std::fixed << std::setprecision(0);
+    std::cout << "  Ticks/sec:       " << std::setw(10)
+              << md_stats.ticks_processed / feed_seconds << " ("
+              << ticks_published << " published, " << ticks_dropped
+              << " dropped)\n";
+    std::cout << "  Repriced/sec:    " << std::setw(10)
+              << md_stats.options_repriced / feed_seconds << " options ("
+              << std::setprecision(1)
+              << static_cast<double>(md_stats.ticks_processed) /
+                     std::max<uint64_t>(md_stats.batches, 1)
+              << " ticks/batch)\n";
+    print_latency_percentiles(md_engine.latency());
+    std::cout << "\n";
+
+    // Memory footprint and achieved bandwidth per kernel, against a
+    // STREAM probe of this machine's sustainable bandwidth
+    print_section("Memory Footprint & Bandwidth");
+    {
+        trading::StreamConfig stream_config;
+        stream_config.array_elements = std::max<size_t>(stream_mb, 1) * (1u << 20) / sizeof(double);
+        stream_config.num_threads = num_threads;
+        trading::StreamResult stream = trading::run_stream_probe(stream_config);
+        double peak_gbps = stream.peak_gbps();
+
+        std::cout << std::fixed << std::setprecision(1);
+        std::cout << "  STREAM (" << 3 * stream.array_bytes / (1u << 20) << " MB, "
+                  << num_threads << " threads)"
+                  << (stream.validated ? "" : " [VALIDATION FAILED]") << ":\n";
+        std::cout << "    Copy " << stream.copy_gbps << "  Scale " << stream.scale_gbps
+                  << "  Add " << stream.add_gbps << "  Triad " << stream.triad_gbps
+                  << " GB/s\n\n";
+
+        // bytes_moved is each kernel's compulsory traffic: inputs read once
+        // and outputs written once. Anything re-read from cache is not counted.
+        const size_t mem_sims = std::min<size_t>(num_simulations, 20000);
+        const double position_bytes = static_cast<double>(positions.size()) * sizeof(trading::Position);
+        auto mc_inputs = trading::prepare_mc_inputs(positions, 1.0/252.0);
+        trading::RiskWorkspace workspace(num_threads);
+        std::vector<trading::Greeks> greeks(positions.size());
+        trading::AggregationResult exposure{};
+        double checksum = 0.0;
+
+        struct Row { const char* name; trading::PhaseMemory phase; };
+        std::vector<Row> rows;
+        rows.push_back({"Greeks (fresh)", trading::measure_phase([&]() {
+            checksum += trading::calculate_all_greeks_multi(positions, num_threads)[0].price;
+        }, position_bytes + positions.size() * sizeof(trading::Greeks))});
+        rows.push_back({"Greeks (workspace)", trading::measure_phase([&]() {
+            trading::calculate_all_greeks_multi(positions, workspace, greeks.data());
+            checksum += greeks[0].price;
+        }, position_bytes + positions.size() * sizeof(trading::Greeks))});
+        // P&L written, copied to the sort buffer, then sorted in place
+        double mc_bytes = 3.0 * positions.size() * sizeof(double) +
+                          4.0 * mem_sims * sizeof(double);
+        rows.push_back({"MC VaR (fresh)", trading::measure_phase([&]() {
+            checksum += trading::run_monte_carlo_multi(mc_inputs, mem_sims, num_threads, 42).var_99;
+        }, mc_bytes)});
+        rows.push_back({"MC VaR (workspace)", trading::measure_phase([&]() {
+            checksum += trading::run_monte_carlo_multi(mc_inputs, mem_sims, workspace, 42).var_99;
+        }, mc_bytes)});
+        rows.push_back({"Aggregation (fresh)", trading::measure_phase([&]() {
+            checksum += trading::aggregate_positions_multi(positions, num_threads).net_exposure;
+        }, position_bytes)});
+        rows.push_back({"Aggregation (wksp)", trading::measure_phase([&]() {
+            trading::aggregate_positions_multi(positions, workspace, &exposure);
+            checksum += exposure.net_exposure;
+        }, position_bytes)});
+        // Second pass over the workspace: the steady state
+        rows.push_back({"Workspace rerun", trading::measure_phase([&]() {
+            trading::calculate_all_greeks_multi(positions, workspace, greeks.data());
+            checksum += trading::run_monte_carlo_multi(mc_inputs, mem_sims, workspace, 43).var_99;
+            trading::aggregate_positions_multi(positions, workspace, &exposure);
+        }, 2.0 * position_bytes + positions.size() * sizeof(trading::Greeks) + mc_bytes)});
+
+        std::cout << "  " << std::left << std::setw(20) << "Phase" << std::right
+                  << std::setw(9) << "ms" << std::setw(9) << "GB/s" << std::setw(8) << "%peak"
+                  << std::setw(9) << "allocs" << std::setw(10) << "MB alloc"
+                  << std::setw(9) << "minflt" << std::setw(7) << "majflt"
+                  << std::setw(10) << "RSS +MB" << "\n";
+        for (const auto& row : rows) {
+            const trading::PhaseMemory& phase = row.phase;
+            std::cout << "  " << std::left << std::setw(20) << row.name << std::right
+                      << std::setprecision(2) << std::setw(9) << phase.elapsed_ms
+                      << std::setw(9) << phase.bandwidth_gbps()
+                      << std::setprecision(1) << std::setw(7)
+                      << (peak_gbps > 0.0 ? 100.0 * phase.bandwidth_gbps() / peak_gbps : 0.0) << "%"
+                      << std::setw(9) << phase.allocations
+                      << std::setw(10) << phase.bytes_allocated / 1048576.0
+                      << std::setw(9) << phase.minor_faults
+                      << std::setw(7) << phase.major_faults
+                      << std::setw(10) << phase.rss_change_kb / 1024.0 << "\n";
+        }
+        if (!trading::allocation_hook_installed()) {
+            std::cout << "  (allocation hook not linked: allocation columns are zero)\n";
+        }
+
+        trading::MemorySnapshot process = trading::memory_snapshot();
+        std::cout << "  Process: peak RSS " << process.peak_rss_kb / 1024.0 << " MB, current "
+                  << process.current_rss_kb / 1024.0 << " MB, " << process.minor_faults
+                  << " minor / " << process.major_faults << " major faults";
+        std::cout << (std::isfinite(checksum) ? "\n" : " (non-finite result)\n");
+    }
     std::cout << "\n";
 
     // Summary
@@ -199,10 +1327,15 @@ int main(int argc, char* argv[]) {
     std::cout << "  Portfolio Delta:  " << std::setw(14) << total_delta << "\n";
     std::cout << "  Net Exposure:     $" << std::setw(12) << agg_result.net_exposure << "\n";
     std::cout << "  Unique Symbols:   " << std::setw(14) << agg_result.by_symbol.size() << "\n";
+    std::cout << "  Worst Scenario:   $" << std::setw(12) << worst_scenario_pnl << "\n";
 
     // Total timing
-    double total_single = mc_single.elapsed_ms + greeks_single.elapsed_ms + agg_single.elapsed_ms;
-    double total_multi = mc_multi.elapsed_ms + greeks_multi.elapsed_ms + agg_multi.elapsed_ms;
+    double total_single = mc_single.elapsed_ms + greeks_single.elapsed_ms +
+                          agg_single.elapsed_ms + scen_single.elapsed_ms +
+                          iv_single.elapsed_ms + lattice_single.elapsed_ms;
+    double total_multi = mc_multi.elapsed_ms + greeks_multi.elapsed_ms +
+                         agg_multi.elapsed_ms + scen_multi.elapsed_ms +
+                         iv_multi.elapsed_ms + lattice_multi.elapsed_ms;
     double overall_speedup = total_single / total_multi;
 
     std::cout << "\n";
@@ -213,5 +1346,19 @@ int main(int argc, char* argv[]) {
     std::cout << "  Multi-threaded:  " << std::setw(8) << total_multi << " ms ("
               << overall_speedup << "x speedup)\n";
 
+    if (!latency_csv_path.empty()) {
+        std::ofstream csv(latency_csv_path);
+        if (!csv) {
+            std::cerr << "Error: cannot write " << latency_csv_path << "\n";
+            return 1;
+        }
+        trading::LatencyHistogram::write_csv_header(csv);
+        option_latency.write_csv(csv, "greeks_per_option");
+        table_latency.write_csv(csv, "table_lookup");
+        analytic_latency.write_csv(csv, "analytic_reprice");
+        md_engine.latency().write_csv(csv, "tick_to_greeks");
+        std::cout << "\nLatency histograms written to " << latency_csv_path << "\n";
+    }
+
     return 0;
 }
@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "lib/benchmark.h"
+#include "lib/risk_service.h"
+
+void print_usage() {
+    std::cout << "Usage: risk_client --socket PATH [options]\n"
+              << "\nLoad Options:\n"
+              << "  --socket PATH       Service socket (risk_benchmark --serve PATH)\n"
+              << "  --connections N     Concurrent client connections (default: 1)\n"
+              << "  --requests N        Requests per connection (default: 1000)\n"
+              << "  --type TYPE         ping | var | greeks | exposure (default: greeks)\n"
+              << "  --simulations N     Simulations per VAR request (default: service)\n"
+              << "  --shutdown          Send SHUTDOWN after the run\n"
+              << "  --help              Show this help message\n";
+}
+
+bool parse_request_type(const std::string& name, trading::RiskRequestType* type) {
+    if (name == "ping") {
+        *type = trading::RiskRequestType::PING;
+    } else if (name == "var") {
+        *type = trading::RiskRequestType::VAR;
+    } else if (name == "greeks") {
+        *type = trading::RiskRequestType::GREEKS;
+    } else if (name == "exposure") {
+        *type = trading::RiskRequestType::EXPOSURE;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    std::string socket_path;
+    int num_connections = 1;
+    int num_requests = 1000;
+    std::string type_name = "greeks";
+    uint32_t num_simulations = 0;
+    bool send_shutdown = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+
+        if (arg == "--socket" && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (arg == "--connections" && i + 1 < argc) {
+            num_connections = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--requests" && i + 1 < argc) {
+            num_requests = std::max(1, std::stoi(argv[++i]));
+        } else if (arg == "--type" && i + 1 < argc) {
+            type_name = argv[++i];
+        } else if (arg == "--simulations" && i + 1 < argc) {
+            num_simulations = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--shutdown") {
+            send_shutdown = true;
+        } else if (arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else {
+            std::cerr << "Unknown option: " << arg << "\n";
+            std::cerr << "Use --help for usage information.\n";
+            return 1;
+        }
+    }
+
+    trading::RiskRequestType type;
+    if (socket_path.empty() || !parse_request_type(type_name, &type)) {
+        print_usage();
+        return 1;
+    }
+
+    // One histogram per connection thread, merged after the run.
+    std::vector<trading::LatencyHistogram> latencies;
+    for (int c = 0; c < num_connections; ++c) {
+        latencies.emplace_back();
+    }
+    std::vector<int> failures(num_connections, 0);
+    std::vector<std::thread> threads;
+
+    auto wall_start = std::chrono::steady_clock::now();
+    for (int c = 0; c < num_connections; ++c) {
+        threads.emplace_back([&, c]() {
+            trading::RiskClient client;
+            if (!client.connect(socket_path)) {
+                failures[c] = num_requests;
+                return;
+            }
+
+            trading::RiskRequest request{static_cast<uint32_t>(type),
+                                         num_simulations,
+                                         static_cast<uint32_t>(42 + c), 0};
+            trading::RiskResponse response;
+
+            for (int r = 0; r < num_requests; ++r) {
+                uint64_t t0 = trading::TscClock::now();
+                bool ok = client.request(request, &response);
+                uint64_t t1 = trading::TscClock::now();
+                if (!ok || response.status != trading::kRiskStatusOk) {
+                    ++failures[c];
+                    if (!ok) break;
+                    continue;
+                }
+                latencies[c].record(trading::TscClock::to_ns(t1 - t0));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double wall_sec = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - wall_start).count();
+
+    trading::LatencyHistogram all;
+    int total_failures = 0;
+    for (int c = 0; c < num_connections; ++c) {
+        all.merge(latencies[c]);
+        total_failures += failures[c];
+    }
+
+    std::cout << "\n=== Risk Service Load Test ===\n";
+    std::cout << "Type: " << type_name
+              << " | Connections: " << num_connections
+              << " | Requests/conn: " << num_requests << "\n";
+    std::cout << std::string(50, '-') << "\n";
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "  Completed:       " << all.count()
+              << " (" << total_failures << " failed)\n";
+    std::cout << "  Throughput:      " << std::setw(10) << all.count() / wall_sec
+              << " req/s\n";
+    std::cout << "  Latency p50:     " << std::setw(10)
+              << all.value_at_percentile(50.0) / 1000.0 << " us\n";
+    std::cout << "  Latency p90:     " << std::setw(10)
+              << all.value_at_percentile(90.0) / 1000.0 << " us\n";
+    std::cout << "  Latency p99:     " << std::setw(10)
+              << all.value_at_percentile(99.0) / 1000.0 << " us\n";
+    std::cout << "  Latency p99.9:   " << std::setw(10)
+              << all.value_at_percentile(99.9) / 1000.0 << " us\n";
+    std::cout << "  Latency max:     " << std::setw(10)
+              << all.max() / 1000.0 << " us\n";
+
+    if (send_shutdown) {
+        trading::RiskClient client;
+        trading::RiskResponse response;
+        if (!client.connect(socket_path) ||
+            !client.request({static_cast<uint32_t>(trading::RiskRequestType::SHUTDOWN),
+                             0, 0, 0}, &response)) {
+            std::cerr << "Error: failed to send SHUTDOWN\n";
+            return 1;
+        }
+    }
+
+    return total_failures == 0 ? 0 : 1;
+}
@@ -1,7 +1,10 @@
 #include "lib/aggregator.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <functional>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <vector>
@@ -40,6 +43,17 @@ AggregationResult aggregate_positions_single(
     return result;
 }
 
+namespace {
+
+// Position notional with the product rounded to T.
+template <typename T>
+double notional_in(const Position& pos) {
+    return static_cast<T>(pos.quantity) * static_cast<T>(pos.price);
+}
+
+}  // namespace
+
+template <typename T>
 AggregationResult aggregate_positions_multi(
     const std::vector<Position>& positions,
     int num_threads) {
@@ -61,10 +75,10 @@ AggregationResult aggregate_positions_multi(
 
         for (size_t i = start; i < end; ++i) {
             const auto& pos = positions[i];
-            double notional = pos.quantity * pos.price;
+            double notional = notional_in<T>(pos);
 
             auto& exposure = local.by_symbol[pos.symbol];
-            exposure.quantity += pos.quantity;
+            exposure.quantity += static_cast<T>(pos.quantity);
             exposure.notional += notional;
             exposure.position_count++;
 
@@ -114,22 +128,576 @@ AggregationResult aggregate_positions_multi(
     return final_result;
 }
 
+template AggregationResult aggregate_positions_multi<double>(
+    const std::vector<Position>&, int);
+template AggregationResult aggregate_positions_multi<float>(
+    const std::vector<Position>&, int);
+
+namespace {
+
+struct ExposureTotals {
+    double long_exposure = 0.0;
+    double short_exposure = 0.0;
+    int positions = 0;
+
+    void add(double notional) {
+        if (notional > 0) {
+            long_exposure += notional;
+        } else {
+            short_exposure += std::abs(notional);
+        }
+        positions++;
+    }
+};
+
+template <typename Result>
+void set_totals(Result* result, const std::vector<ExposureTotals>& partials) {
+    result->total_long_exposure = 0.0;
+    result->total_short_exposure = 0.0;
+    result->total_positions = 0;
+    for (const auto& partial : partials) {
+        result->total_long_exposure += partial.long_exposure;
+        result->total_short_exposure += partial.short_exposure;
+        result->total_positions += partial.positions;
+    }
+    result->net_exposure = result->total_long_exposure - result->total_short_exposure;
+}
+
+template <typename Worker>
+void run_chunks(size_t count, int num_threads, Worker worker) {
+    std::vector<std::thread> threads;
+    size_t chunk_size = (count + num_threads - 1) / num_threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        size_t start = t * chunk_size;
+        size_t end = std::min(start + chunk_size, count);
+        threads.emplace_back(worker, t, start, end);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void splice_shards(std::vector<std::unordered_map<std::string, NetExposure>>& shards,
+                   AggregationResult* result) {
+    size_t num_symbols = 0;
+    for (const auto& shard : shards) {
+        num_symbols += shard.size();
+    }
+    result->by_symbol.reserve(num_symbols);
+    for (auto& shard : shards) {
+        result->by_symbol.merge(shard);
+    }
+}
+
+size_t symbol_shard(const std::string& symbol, size_t num_shards) {
+    return std::hash<std::string>{}(symbol) % num_shards;
+}
+
+// Running sums that are either plain (compensation stays zero) or
+// Neumaier-compensated, chosen per call.
+void add_term(NeumaierSum& total, double x, bool compensated) {
+    if (compensated) {
+        total.add(x);
+    } else {
+        total.sum += x;
+    }
+}
+
+void merge_term(NeumaierSum& total, const NeumaierSum& other, bool compensated) {
+    if (compensated) {
+        total.merge(other);
+    } else {
+        total.sum += other.sum;
+    }
+}
+
+struct CompensatedTotals {
+    NeumaierSum long_exposure;
+    NeumaierSum short_exposure;
+    NeumaierSum net_exposure;
+    int positions = 0;
+
+    void add(double notional, bool compensated) {
+        if (notional > 0) {
+            add_term(long_exposure, notional, compensated);
+        } else {
+            add_term(short_exposure, std::abs(notional), compensated);
+        }
+        add_term(net_exposure, notional, compensated);
+        positions++;
+    }
+
+    void merge(const CompensatedTotals& other, bool compensated) {
+        merge_term(long_exposure, other.long_exposure, compensated);
+        merge_term(short_exposure, other.short_exposure, compensated);
+        merge_term(net_exposure, other.net_exposure, compensated);
+        positions += other.positions;
+    }
+};
+
+struct CompensatedExposure {
+    NeumaierSum quantity;
+    NeumaierSum notional;
+    int position_count = 0;
+
+    void add(double qty, double value, bool compensated) {
+        add_term(quantity, qty, compensated);
+        add_term(notional, value, compensated);
+        position_count++;
+    }
+
+    NetExposure value() const {
+        NetExposure exposure{quantity.value(), notional.value(), 0.0, position_count};
+        if (exposure.quantity != 0.0) {
+            exposure.avg_price = exposure.notional / exposure.quantity;
+        }
+        return exposure;
+    }
+};
+
+void atomic_add(std::atomic<double>& target, double value) {
+    double current = target.load(std::memory_order_relaxed);
+    while (!target.compare_exchange_weak(current, current + value,
+                                         std::memory_order_relaxed)) {
+    }
+}
+
+// Fixed-capacity linear-probing table keyed by the positions' own symbol
+// strings. A slot is claimed by CAS on its key pointer; once set, the key
+// never changes, so probes compare strings without locking.
+class ConcurrentExposureTable {
+public:
+    explicit ConcurrentExposureTable(size_t max_symbols) {
+        capacity_ = 16;
+        while (capacity_ < 2 * max_symbols) {
+            capacity_ <<= 1;
+        }
+        mask_ = capacity_ - 1;
+        slots_.reset(new Slot[capacity_]);
+    }
+
+    // False if the symbol is new and the table is full.
+    bool add(const std::string& symbol, double quantity, double notional) {
+        Slot* slot = find_or_claim(symbol);
+        if (slot == nullptr) return false;
+        atomic_add(slot->quantity, quantity);
+        atomic_add(slot->notional, notional);
+        slot->position_count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (size_t i = 0; i < capacity_; ++i) {
+            const std::string* key = slots_[i].key.load(std::memory_order_acquire);
+            if (key != nullptr) {
+                fn(*key, slots_[i]);
+            }
+        }
+    }
+
+    struct Slot {
+        std::atomic<const std::string*> key{nullptr};
+        std::atomic<double> quantity{0.0};
+        std::atomic<double> notional{0.0};
+        std::atomic<int> position_count{0};
+    };
+
+private:
+    Slot* find_or_claim(const std::string& symbol) {
+        size_t i = std::hash<std::string>{}(symbol) & mask_;
+        for (size_t probe = 0; probe < capacity_; ++probe) {
+            Slot& slot = slots_[i];
+            const std::string* key = slot.key.load(std::memory_order_acquire);
+            if (key == nullptr) {
+                if (slot.key.compare_exchange_strong(key, &symbol,
+                                                     std::memory_order_acq_rel)) {
+                    size_.fetch_add(1, std::memory_order_relaxed);
+                    return &slot;
+                }
+                // Lost the race; `key` now holds the winner's symbol.
+            }
+            if (key == &symbol || *key == symbol) {
+                return &slot;
+            }
+            i = (i + 1) & mask_;
+        }
+        return nullptr;
+    }
+
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    std::atomic<size_t> size_{0};
+};
+
+}  // namespace
+
+size_t ShardedExposure::shard_of(const std::string& symbol) const {
+    return symbol_shard(symbol, shards.size());
+}
+
+const NetExposure* ShardedExposure::find(const std::string& symbol) const {
+    if (shards.empty()) return nullptr;
+    const auto& shard = shards[shard_of(symbol)];
+    auto it = shard.find(symbol);
+    return it == shard.end() ? nullptr : &it->second;
+}
+
+size_t ShardedExposure::num_symbols() const {
+    size_t count = 0;
+    for (const auto& shard : shards) {
+        count += shard.size();
+    }
+    return count;
+}
+
+AggregationResult ShardedExposure::flatten() {
+    AggregationResult result;
+    splice_shards(shards, &result);
+    result.total_long_exposure = total_long_exposure;
+    result.total_short_exposure = total_short_exposure;
+    result.net_exposure = net_exposure;
+    result.total_positions = total_positions;
+    return result;
+}
+
+ShardedExposure aggregate_positions_into_shards(
+    const std::vector<Position>& positions,
+    int num_threads) {
+
+    size_t num_shards = num_threads;
+
+    // shard_indices[chunk][shard]: positions of `chunk` whose symbol hashes
+    // to `shard`, in book order.
+    std::vector<std::vector<std::vector<uint32_t>>> shard_indices(
+        num_threads, std::vector<std::vector<uint32_t>>(num_shards));
+    std::vector<ExposureTotals> totals(num_threads);
+
+    run_chunks(positions.size(), num_threads,
+               [&](int thread_id, size_t start, size_t end) {
+        auto& buckets = shard_indices[thread_id];
+        for (size_t i = start; i < end; ++i) {
+            const auto& pos = positions[i];
+            buckets[symbol_shard(pos.symbol, num_shards)].push_back(
+                static_cast<uint32_t>(i));
+            totals[thread_id].add(pos.quantity * pos.price);
+        }
+    });
+
+    ShardedExposure result;
+    auto& shards = result.shards;
+    shards.resize(num_shards);
+    run_chunks(num_shards, num_threads,
+               [&](int, size_t start, size_t end) {
+        for (size_t s = start; s < end; ++s) {
+            auto& shard = shards[s];
+            for (int chunk = 0; chunk < num_threads; ++chunk) {
+                for (uint32_t i : shard_indices[chunk][s]) {
+                    const auto& pos = positions[i];
+                    auto& exposure = shard[pos.symbol];
+                    exposure.quantity += pos.quantity;
+                    exposure.notional += pos.quantity * pos.price;
+                    exposure.position_count++;
+                }
+            }
+            for (auto& [symbol, exp] : shard) {
+                if (exp.quantity != 0.0) {
+                    exp.avg_price = exp.notional / exp.quantity;
+                }
+            }
+        }
+    });
+
+    set_totals(&result, totals);
+    return result;
+}
+
+AggregationResult aggregate_positions_sharded(
+    const std::vector<Position>& positions,
+    int num_threads) {
+    return aggregate_positions_into_shards(positions, num_threads).flatten();
+}
+
+template <typename T>
+AggregationResult aggregate_positions_deterministic(
+    const std::vector<Position>& positions,
+    int num_threads,
+    Summation mode) {
+
+    size_t num_shards = num_threads;
+    std::hash<std::string> hasher;
+    size_t num_blocks = (positions.size() + kReductionBlock - 1) / kReductionBlock;
+    std::vector<CompensatedTotals> block_totals(num_blocks);
+    bool compensated = (mode == Summation::NEUMAIER);
+
+    // Threads take whole blocks, so block totals do not depend on the
+    // thread count, and each shard's indices stay in book order.
+    std::vector<std::vector<std::vector<uint32_t>>> shard_indices(
+        num_threads, std::vector<std::vector<uint32_t>>(num_shards));
+
+    run_chunks(num_blocks, num_threads,
+               [&](int thread_id, size_t first, size_t last) {
+        auto& buckets = shard_indices[thread_id];
+        for (size_t b = first; b < last; ++b) {
+            size_t start = b * kReductionBlock;
+            size_t end = std::min(start + kReductionBlock, positions.size());
+            CompensatedTotals& totals = block_totals[b];
+            for (size_t i = start; i < end; ++i) {
+                const auto& pos = positions[i];
+                buckets[hasher(pos.symbol) % num_shards].push_back(
+                    static_cast<uint32_t>(i));
+                totals.add(notional_in<T>(pos), compensated);
+            }
+        }
+    });
+
+    std::vector<std::unordered_map<std::string, NetExposure>> shards(num_shards);
+    run_chunks(num_shards, num_threads,
+               [&](int, size_t start, size_t end) {
+        for (size_t s = start; s < end; ++s) {
+            std::unordered_map<std::string, CompensatedExposure> accumulators;
+            for (int chunk = 0; chunk < num_threads; ++chunk) {
+                for (uint32_t i : shard_indices[chunk][s]) {
+                    const auto& pos = positions[i];
+                    accumulators[pos.symbol].add(static_cast<T>(pos.quantity),
+                                                 notional_in<T>(pos), compensated);
+                }
+            }
+            auto& shard = shards[s];
+            shard.reserve(accumulators.size());
+            while (!accumulators.empty()) {
+                auto node = accumulators.extract(accumulators.begin());
+                shard.emplace(std::move(node.key()), node.mapped().value());
+            }
+        }
+    });
+
+    AggregationResult result;
+    splice_shards(shards, &result);
+
+    if (block_totals.empty()) {
+        block_totals.emplace_back();
+    }
+    tree_reduce(block_totals, [compensated](CompensatedTotals& a,
+                                            const CompensatedTotals& b) {
+        a.merge(b, compensated);
+    });
+    const CompensatedTotals& totals = block_totals[0];
+    result.total_long_exposure = totals.long_exposure.value();
+    result.total_short_exposure = totals.short_exposure.value();
+    result.net_exposure = totals.net_exposure.value();
+    result.total_positions = totals.positions;
+    return result;
+}
+
+template AggregationResult aggregate_positions_deterministic<double>(
+    const std::vector<Position>&, int, Summation);
+template AggregationResult aggregate_positions_deterministic<float>(
+    const std::vector<Position>&, int, Summation);
+
+AggregationResult aggregate_positions_concurrent(
+    const std::vector<Position>& positions,
+    int num_threads,
+    size_t expected_symbols) {
+
+    ConcurrentExposureTable table(
+        expected_symbols > 0 ? expected_symbols : positions.size());
+    std::vector<ExposureTotals> totals(num_threads);
+    std::atomic<bool> overflow{false};
+
+    run_chunks(positions.size(), num_threads,
+               [&](int thread_id, size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            const auto& pos = positions[i];
+            double notional = pos.quantity * pos.price;
+            if (!table.add(pos.symbol, pos.quantity, notional)) {
+                overflow.store(true, std::memory_order_relaxed);
+                return;
+            }
+            totals[thread_id].add(notional);
+        }
+    });
+
+    // expected_symbols was too low; the table cannot grow in place.
+    if (overflow.load(std::memory_order_relaxed)) {
+        return aggregate_positions_sharded(positions, num_threads);
+    }
+
+    AggregationResult result;
+    result.by_symbol.reserve(table.size());
+    table.for_each([&](const std::string& symbol,
+                       const ConcurrentExposureTable::Slot& slot) {
+        NetExposure exposure;
+        exposure.quantity = slot.quantity.load(std::memory_order_relaxed);
+        exposure.notional = slot.notional.load(std::memory_order_relaxed);
+        exposure.position_count = slot.position_count.load(std::memory_order_relaxed);
+        exposure.avg_price = exposure.quantity != 0.0
+            ? exposure.notional / exposure.quantity : 0.0;
+        result.by_symbol.emplace(symbol, exposure);
+    });
+    set_totals(&result, totals);
+    return result;
+}
+
+namespace {
+
+using ExposureEntry = std::unordered_map<std::string, NetExposure>::value_type;
+
+// True if a ranks ahead of b.
+bool ranks_before(const ExposureEntry* a, const ExposureEntry* b) {
+    double abs_a = std::abs(a->second.notional);
+    double abs_b = std::abs(b->second.notional);
+    if (abs_a != abs_b) return abs_a > abs_b;
+    return a->first < b->first;
+}
+
+// Min-heap on rank: the front is the weakest of the current top_n.
+class TopSelector {
+public:
+    explicit TopSelector(size_t top_n) : top_n_(top_n) {
+        heap_.reserve(top_n);
+    }
+
+    void offer(const ExposureEntry* entry) {
+        if (top_n_ == 0) return;
+        if (heap_.size() < top_n_) {
+            heap_.push_back(entry);
+            std::push_heap(heap_.begin(), heap_.end(), ranks_before);
+        } else if (ranks_before(entry, heap_.front())) {
+            std::pop_heap(heap_.begin(), heap_.end(), ranks_before);
+            heap_.back() = entry;
+            std::push_heap(heap_.begin(), heap_.end(), ranks_before);
+        }
+    }
+
+    const std::vector<const ExposureEntry*>& candidates() const { return heap_; }
+
+    std::vector<std::pair<std::string, NetExposure>> take_sorted() {
+        std::sort_heap(heap_.begin(), heap_.end(), ranks_before);
+        std::vector<std::pair<std::string, NetExposure>> top;
+        top.reserve(heap_.size());
+        for (const ExposureEntry* entry : heap_) {
+            top.emplace_back(entry->first, entry->second);
+        }
+        return top;
+    }
+
+private:
+    size_t top_n_;
+    std::vector<const ExposureEntry*> heap_;
+};
+
+}  // namespace
+
 std::vector<std::pair<std::string, NetExposure>> get_top_exposures(
     const AggregationResult& result, size_t top_n) {
 
-    std::vector<std::pair<std::string, NetExposure>> exposures(
-        result.by_symbol.begin(), result.by_symbol.end());
+    TopSelector selector(std::min(top_n, result.by_symbol.size()));
+    for (const auto& entry : result.by_symbol) {
+        selector.offer(&entry);
+    }
+    return selector.take_sorted();
+}
+
+std::vector<std::pair<std::string, NetExposure>> get_top_exposures_multi(
+    const AggregationResult& result, size_t top_n, int num_threads) {
+
+    const auto& by_symbol = result.by_symbol;
+    top_n = std::min(top_n, by_symbol.size());
+    size_t num_buckets = by_symbol.bucket_count();
 
-    std::sort(exposures.begin(), exposures.end(),
-        [](const auto& a, const auto& b) {
-            return std::abs(a.second.notional) > std::abs(b.second.notional);
-        });
+    std::vector<TopSelector> shards(num_threads, TopSelector(top_n));
+    std::vector<std::thread> threads;
+    size_t chunk_size = (num_buckets + num_threads - 1) / num_threads;
+
+    auto worker = [&](int thread_id) {
+        size_t start = thread_id * chunk_size;
+        size_t end = std::min(start + chunk_size, num_buckets);
+        for (size_t b = start; b < end; ++b) {
+            for (auto it = by_symbol.begin(b); it != by_symbol.end(b); ++it) {
+                shards[thread_id].offer(&*it);
+            }
+        }
+    };
 
-    if (exposures.size() > top_n) {
-        exposures.resize(top_n);
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker, t);
     }
 
-    return exposures;
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    TopSelector merged(top_n);
+    for (const auto& shard : shards) {
+        for (const ExposureEntry* entry : shard.candidates()) {
+            merged.offer(entry);
+        }
+    }
+    return merged.take_sorted();
+}
+
+void TopExposureIndex::rebuild(const AggregationResult& result) {
+    ranking_.clear();
+    exposures_ = result.by_symbol;
+    for (const auto& entry : exposures_) {
+        ranking_.insert({std::abs(entry.second.notional), &entry});
+    }
+}
+
+void TopExposureIndex::set(Map::iterator it, const NetExposure& exposure) {
+    ranking_.erase({std::abs(it->second.notional), &*it});
+    it->second = exposure;
+    ranking_.insert({std::abs(exposure.notional), &*it});
+}
+
+void TopExposureIndex::update(const std::string& symbol,
+                              const NetExposure& exposure) {
+    auto [it, inserted] = exposures_.try_emplace(symbol, exposure);
+    if (inserted) {
+        ranking_.insert({std::abs(exposure.notional), &*it});
+    } else {
+        set(it, exposure);
+    }
+}
+
+void TopExposureIndex::apply(const Position& pos) {
+    auto [it, inserted] = exposures_.try_emplace(pos.symbol, NetExposure{});
+    NetExposure exposure = it->second;
+    exposure.quantity += pos.quantity;
+    exposure.notional += pos.quantity * pos.price;
+    exposure.position_count++;
+    if (exposure.quantity != 0.0) {
+        exposure.avg_price = exposure.notional / exposure.quantity;
+    }
+    if (inserted) {
+        it->second = exposure;
+        ranking_.insert({std::abs(exposure.notional), &*it});
+    } else {
+        set(it, exposure);
+    }
+}
+
+void TopExposureIndex::erase(const std::string& symbol) {
+    auto it = exposures_.find(symbol);
+    if (it == exposures_.end()) return;
+    ranking_.erase({std::abs(it->second.notional), &*it});
+    exposures_.erase(it);
+}
+
+std::vector<std::pair<std::string, NetExposure>> TopExposureIndex::top(
+    size_t top_n) const {
+    std::vector<std::pair<std::string, NetExposure>> top;
+    top.reserve(std::min(top_n, ranking_.size()));
+    for (auto it = ranking_.begin(); it != ranking_.end() && top.size() < top_n; ++it) {
+        top.emplace_back(it->entry->first, it->entry->second);
+    }
+    return top;
 }
 
 }  // namespace trading
@@ -2,7 +2,10 @@
 #define LIB_AGGREGATOR_H_
 
 #include "lib/position.h"
+#include "lib/reduction.h"
 
+#include <cstddef>
+#include <set>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -27,13 +30,136 @@ struct AggregationResult {
 AggregationResult aggregate_positions_single(
     const std::vector<Position>& positions);
 
+// Private map per thread, merged serially on the calling thread.
+//
+// T = float rounds each position's quantity and notional to single
+// precision, as aggregate_positions_deterministic does; the sums stay in
+// double. Instantiated for float and double.
+template <typename T = double>
 AggregationResult aggregate_positions_multi(
     const std::vector<Position>& positions,
     int num_threads);
 
+// Per-symbol exposure left in the hash shards it was aggregated in. The
+// shards hold disjoint symbols and a lookup hashes straight to the owning
+// one, so readers that only look symbols up never pay for a merged map.
+struct ShardedExposure {
+    std::vector<std::unordered_map<std::string, NetExposure>> shards;
+    double total_long_exposure = 0.0;
+    double total_short_exposure = 0.0;
+    double net_exposure = 0.0;
+    int total_positions = 0;
+
+    size_t shard_of(const std::string& symbol) const;
+    // nullptr if the symbol is not in the book.
+    const NetExposure* find(const std::string& symbol) const;
+    size_t num_symbols() const;
+
+    template <typename Fn>
+    void for_each(Fn fn) const {
+        for (const auto& shard : shards) {
+            for (const auto& entry : shard) {
+                fn(entry.first, entry.second);
+            }
+        }
+    }
+
+    // Splices every shard into one map on the calling thread, leaving the
+    // shards empty. This is the serial step; skip it when lookups suffice.
+    AggregationResult flatten();
+};
+
+// Two parallel passes: each thread buckets its chunk's position indices by
+// symbol hash, then each thread owns one hash shard and aggregates it from
+// every chunk.
+ShardedExposure aggregate_positions_into_shards(
+    const std::vector<Position>& positions,
+    int num_threads);
+
+// aggregate_positions_into_shards(...).flatten().
+AggregationResult aggregate_positions_sharded(
+    const std::vector<Position>& positions,
+    int num_threads);
+
+// Bitwise-identical results for every num_threads. Per-symbol sums run in
+// book order (hash-sharded as above), so unless compensated they match
+// aggregate_positions_single exactly; totals always use the fixed block
+// tree of lib/reduction.h. NEUMAIER compensates both.
+//
+// T = float rounds each position's quantity and notional to single
+// precision; every sum still accumulates in double. Instantiated for
+// float and double.
+template <typename T = double>
+AggregationResult aggregate_positions_deterministic(
+    const std::vector<Position>& positions,
+    int num_threads,
+    Summation mode = Summation::PAIRWISE);
+
+// All threads accumulate into one lock-free open-addressing table (CAS on
+// the key slot, CAS-loop double adds). `expected_symbols` sizes the table
+// and should bound the distinct symbols; 0 sizes it for one symbol per
+// position. If the table fills up, falls back to the sharded strategy.
+AggregationResult aggregate_positions_concurrent(
+    const std::vector<Position>& positions,
+    int num_threads,
+    size_t expected_symbols = 0);
+
+// Largest |notional| first; ties go to the lower symbol so the order is
+// deterministic. Bounded heap selection, O(n log top_n), copying only the
+// winners.
 std::vector<std::pair<std::string, NetExposure>> get_top_exposures(
     const AggregationResult& result, size_t top_n);
 
+// Same selection with the map's hash buckets split into per-thread shards;
+// each shard keeps its own top_n and the candidates are merged at the end.
+std::vector<std::pair<std::string, NetExposure>> get_top_exposures_multi(
+    const AggregationResult& result, size_t top_n, int num_threads);
+
+// Per-symbol exposure kept ranked by |notional| as it changes, so a top-N
+// query walks N entries instead of selecting over every symbol. Updates
+// are O(log symbols).
+class TopExposureIndex {
+public:
+    TopExposureIndex() = default;
+    explicit TopExposureIndex(const AggregationResult& result) { rebuild(result); }
+
+    TopExposureIndex(const TopExposureIndex&) = delete;
+    TopExposureIndex& operator=(const TopExposureIndex&) = delete;
+
+    void rebuild(const AggregationResult& result);
+
+    // Replaces the symbol's exposure.
+    void update(const std::string& symbol, const NetExposure& exposure);
+    // Folds one position (or trade) into its symbol's exposure.
+    void apply(const Position& pos);
+    void erase(const std::string& symbol);
+
+    std::vector<std::pair<std::string, NetExposure>> top(size_t top_n) const;
+    size_t size() const { return exposures_.size(); }
+
+private:
+    using Map = std::unordered_map<std::string, NetExposure>;
+
+    struct Rank {
+        double abs_notional;      // As of insertion; the entry may be mid-update
+        const Map::value_type* entry;
+    };
+    struct RankOrder {
+        bool operator()(const Rank& a, const Rank& b) const {
+            if (a.abs_notional != b.abs_notional) {
+                return a.abs_notional > b.abs_notional;
+            }
+            return a.entry->first < b.entry->first;
+        }
+    };
+
+    void set(Map::iterator it, const NetExposure& exposure);
+
+    // Node-based, so the entry pointers held in ranking_ stay valid.
+    Map exposures_;
+    std::set<Rank, RankOrder> ranking_;
+};
+
 }  // namespace trading
 
 #endif  // LIB_AGGREGATOR_H_
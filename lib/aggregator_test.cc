@@ -1,6 +1,7 @@
 #include "lib/aggregator.h"
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <cmath>
 
 namespace trading {
@@ -52,6 +53,68 @@ TEST(AggregatorTest, MultiThreadedConsistency) {
                 multi_result.total_long_exposure, 0.01);
 }
 
+TEST(AggregatorTest, ShardedAndConcurrentMatchSingle) {
+    auto positions = generate_random_positions(20000, 9, 3000);
+    auto expected = aggregate_positions_single(positions);
+
+    // 50 expected symbols is too few for the concurrent table and takes the
+    // sharded fallback.
+    for (size_t expected_symbols : {size_t{0}, size_t{3000}, size_t{50}}) {
+        for (int threads : {1, 3, 8}) {
+            auto sharded = aggregate_positions_sharded(positions, threads);
+            auto concurrent = aggregate_positions_concurrent(positions, threads,
+                                                             expected_symbols);
+            for (const auto* result : {&sharded, &concurrent}) {
+                EXPECT_EQ(result->total_positions, expected.total_positions);
+                EXPECT_NEAR(result->net_exposure, expected.net_exposure,
+                            1e-6 * expected.total_long_exposure);
+                EXPECT_NEAR(result->total_short_exposure,
+                            expected.total_short_exposure,
+                            1e-6 * expected.total_short_exposure);
+                ASSERT_EQ(result->by_symbol.size(), expected.by_symbol.size());
+                for (const auto& [symbol, net] : expected.by_symbol) {
+                    const NetExposure& actual = result->by_symbol.at(symbol);
+                    EXPECT_EQ(actual.position_count, net.position_count);
+                    EXPECT_NEAR(actual.quantity, net.quantity, 1e-6);
+                    EXPECT_NEAR(actual.notional, net.notional, 1e-3);
+                }
+            }
+        }
+    }
+}
+
+TEST(AggregatorTest, ShardLookupNeedsNoMerge) {
+    auto positions = generate_random_positions(20000, 4, 2500);
+    auto expected = aggregate_positions_single(positions);
+
+    for (int threads : {1, 4, 7}) {
+        ShardedExposure shards = aggregate_positions_into_shards(positions, threads);
+        ASSERT_EQ(shards.shards.size(), static_cast<size_t>(threads));
+        EXPECT_EQ(shards.num_symbols(), expected.by_symbol.size());
+        EXPECT_EQ(shards.total_positions, expected.total_positions);
+        EXPECT_NEAR(shards.net_exposure, expected.net_exposure,
+                    1e-6 * expected.total_long_exposure);
+
+        for (const auto& [symbol, net] : expected.by_symbol) {
+            const NetExposure* actual = shards.find(symbol);
+            ASSERT_NE(actual, nullptr);
+            EXPECT_EQ(shards.shards[shards.shard_of(symbol)].count(symbol), 1u);
+            EXPECT_EQ(actual->position_count, net.position_count);
+            EXPECT_NEAR(actual->notional, net.notional, 1e-3);
+        }
+        EXPECT_EQ(shards.find("NOT_IN_BOOK"), nullptr);
+
+        size_t visited = 0;
+        shards.for_each([&](const std::string&, const NetExposure&) { ++visited; });
+        EXPECT_EQ(visited, expected.by_symbol.size());
+
+        AggregationResult flat = shards.flatten();
+        EXPECT_EQ(flat.by_symbol.size(), expected.by_symbol.size());
+        EXPECT_EQ(flat.total_positions, expected.total_positions);
+        EXPECT_EQ(shards.num_symbols(), 0u);
+    }
+}
+
 TEST(AggregatorTest, TopExposures) {
     auto positions = generate_random_positions(500, 42);
     auto result = aggregate_positions_single(positions);
@@ -65,5 +128,108 @@ TEST(AggregatorTest, TopExposures) {
     }
 }
 
+TEST(AggregatorTest, TopExposuresMatchFullSort) {
+    auto positions = generate_random_positions(5000, 7);
+    auto result = aggregate_positions_single(positions);
+
+    std::vector<std::pair<std::string, NetExposure>> sorted(
+        result.by_symbol.begin(), result.by_symbol.end());
+    std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) {
+        return std::abs(a.second.notional) > std::abs(b.second.notional);
+    });
+
+    for (size_t n : {size_t{0}, size_t{1}, size_t{25}, sorted.size() + 10}) {
+        auto single = get_top_exposures(result, n);
+        auto multi = get_top_exposures_multi(result, n, 4);
+        ASSERT_EQ(single.size(), std::min(n, sorted.size()));
+        ASSERT_EQ(multi.size(), single.size());
+        for (size_t i = 0; i < single.size(); ++i) {
+            EXPECT_EQ(single[i].first, sorted[i].first);
+            EXPECT_EQ(multi[i].first, sorted[i].first);
+        }
+    }
+}
+
+TEST(AggregatorTest, TopExposureIndexTracksUpdates) {
+    auto positions = generate_random_positions(2000, 3);
+    auto result = aggregate_positions_single(positions);
+    TopExposureIndex index(result);
+    EXPECT_EQ(index.size(), result.by_symbol.size());
+
+    auto expect_matches = [&]() {
+        auto expected = get_top_exposures(result, 10);
+        auto actual = index.top(10);
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i].first, expected[i].first);
+            EXPECT_DOUBLE_EQ(actual[i].second.notional, expected[i].second.notional);
+        }
+    };
+    expect_matches();
+
+    // A trade that pushes a small name to the top, then one that flattens it.
+    std::string symbol = get_top_exposures(result, result.by_symbol.size()).back().first;
+    Position trade{.symbol = symbol, .quantity = 1e6, .price = 100.0, .volatility = 0.2,
+                   .type = PositionType::STOCK, .strike = 0, .time_to_expiry = 0,
+                   .risk_free_rate = 0.05};
+    index.apply(trade);
+    auto& exposure = result.by_symbol[symbol];
+    exposure.quantity += trade.quantity;
+    exposure.notional += trade.quantity * trade.price;
+    exposure.position_count++;
+    EXPECT_EQ(index.top(1)[0].first, symbol);
+    expect_matches();
+
+    index.update(symbol, NetExposure{0.0, 0.0, 0.0, 0});
+    result.by_symbol[symbol] = NetExposure{0.0, 0.0, 0.0, 0};
+    expect_matches();
+
+    index.erase(symbol);
+    result.by_symbol.erase(symbol);
+    EXPECT_EQ(index.size(), result.by_symbol.size());
+    expect_matches();
+}
+
+TEST(AggregatorTest, FloatAggregationTracksDouble) {
+    auto positions = generate_random_positions(50000, 17);
+    auto reference = aggregate_positions_deterministic(positions, 3, Summation::NEUMAIER);
+    auto reduced = aggregate_positions_deterministic<float>(positions, 3,
+                                                            Summation::NEUMAIER);
+
+    // Quantity and price are each rounded to float and so is their product
+    // (relative 2^-24 apiece); the double sums add next to nothing.
+    ASSERT_EQ(reduced.by_symbol.size(), reference.by_symbol.size());
+    for (const auto& [symbol, exposure] : reference.by_symbol) {
+        const NetExposure& actual = reduced.by_symbol.at(symbol);
+        EXPECT_EQ(actual.position_count, exposure.position_count);
+        EXPECT_NEAR(actual.quantity, exposure.quantity,
+                    exposure.position_count * 1000.0 * 6e-8);
+        double gross = exposure.position_count * 1000.0 * 500.0;
+        EXPECT_NEAR(actual.notional, exposure.notional, gross * 2e-7);
+    }
+    EXPECT_NEAR(reduced.total_long_exposure, reference.total_long_exposure,
+                reference.total_long_exposure * 2e-7);
+    EXPECT_NEAR(reduced.net_exposure, reference.net_exposure,
+                (reference.total_long_exposure + reference.total_short_exposure) * 2e-7);
+}
+
+TEST(AggregatorTest, FloatMultiAggregationTracksDouble) {
+    auto positions = generate_random_positions(50000, 17);
+    auto reference = aggregate_positions_multi(positions, 3);
+    auto reduced = aggregate_positions_multi<float>(positions, 3);
+
+    // Same rounding as the deterministic path above, in chunk order.
+    ASSERT_EQ(reduced.by_symbol.size(), reference.by_symbol.size());
+    EXPECT_EQ(reduced.total_positions, reference.total_positions);
+    for (const auto& [symbol, exposure] : reference.by_symbol) {
+        const NetExposure& actual = reduced.by_symbol.at(symbol);
+        EXPECT_EQ(actual.position_count, exposure.position_count);
+        double gross = exposure.position_count * 1000.0 * 500.0;
+        EXPECT_NEAR(actual.notional, exposure.notional, gross * 2e-7);
+    }
+    EXPECT_NEAR(reduced.net_exposure, reference.net_exposure,
+                (reference.total_long_exposure + reference.total_short_exposure) * 2e-7);
+}
+
 }  // namespace
 }  // namespace trading
@@ -1,19 +1,32 @@
 #include "lib/benchmark.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
 
 namespace trading {
 
-Timer::Timer() : start_(std::chrono::high_resolution_clock::now()) {}
+Timer::Timer() : start_(TscClock::now()) {}
 
 void Timer::reset() {
-    start_ = std::chrono::high_resolution_clock::now();
+    start_ = TscClock::now();
+}
+
+int64_t Timer::elapsed_ns() const {
+    return TscClock::to_ns(TscClock::now() - start_);
 }
 
 double Timer::elapsed_ms() const {
-    auto now = std::chrono::high_resolution_clock::now();
-    return std::chrono::duration<double, std::milli>(now - start_).count();
+    return elapsed_ns() / 1e6;
 }
 
 double Timer::elapsed_seconds() const {
@@ -22,10 +35,10 @@ double Timer::elapsed_seconds() const {
 
 BenchmarkResult run_benchmark(const std::string& name,
                               std::function<double()> func) {
-    Timer timer;
+    uint64_t start = TscClock::start();
     double result = func();
-    double elapsed = timer.elapsed_ms();
-    return {name, elapsed, result};
+    uint64_t stop = TscClock::stop();
+    return {name, TscClock::to_ns(stop - start) / 1e6, result};
 }
 
 void print_comparison(const BenchmarkResult& single,
@@ -38,4 +51,333 @@ void print_comparison(const BenchmarkResult& single,
               << " ms (" << speedup << "x speedup)\n";
 }
 
+namespace {
+
+std::atomic<double> g_ticks_per_ns{1.0};
+std::atomic<double> g_overhead_ns{0.0};
+std::mutex g_clock_mutex;
+
+int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int floor_log2(uint64_t value) {
+    int result = 0;
+    while (value >>= 1) {
+        ++result;
+    }
+    return result;
+}
+
+// Raw counter, bypassing TscClock's source check so it can be used while
+// the source is being decided.
+uint64_t raw_ticks(bool tsc) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (tsc) return __rdtsc();
+#endif
+    (void)tsc;
+    return static_cast<uint64_t>(steady_ns());
+}
+
+double measure_ticks_per_ns(bool tsc, std::chrono::milliseconds duration) {
+    int64_t start_ns = steady_ns();
+    uint64_t start_ticks = raw_ticks(tsc);
+    std::this_thread::sleep_for(duration);
+    int64_t end_ns = steady_ns();
+    uint64_t end_ticks = raw_ticks(tsc);
+    return static_cast<double>(end_ticks - start_ticks) /
+           static_cast<double>(std::max<int64_t>(end_ns - start_ns, 1));
+}
+
+}  // namespace
+
+bool TscClock::invariant_tsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000000, &eax, &ebx, &ecx, &edx) && eax >= 0x80000007 &&
+        __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return (edx >> 8) & 1;
+    }
+#endif
+    return false;
+}
+
+int TscClock::initialize() {
+    std::lock_guard<std::mutex> lock(g_clock_mutex);
+    int state = state_.load(std::memory_order_acquire);
+    if (state != kUnknown) return state;
+
+    state = kSteady;
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int eax, ebx, ecx, edx;
+    has_rdtscp_ = __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx) &&
+                  ((edx >> 27) & 1);
+    if (invariant_tsc()) {
+        // Reject implausible rates (broken virtualized TSCs) up front.
+        double rate = measure_ticks_per_ns(true, std::chrono::milliseconds(20));
+        if (rate > 0.1 && rate < 20.0) {
+            g_ticks_per_ns.store(rate, std::memory_order_relaxed);
+            state = kTsc;
+        }
+    }
+#endif
+    state_.store(state, std::memory_order_release);
+    calibrate(std::chrono::milliseconds(0));
+    return state;
+}
+
+void TscClock::calibrate(std::chrono::milliseconds duration) {
+    bool tsc = use_tsc();
+    if (tsc && duration.count() > 0) {
+        g_ticks_per_ns.store(measure_ticks_per_ns(true, duration),
+                             std::memory_order_relaxed);
+    } else if (!tsc) {
+        g_ticks_per_ns.store(1.0, std::memory_order_relaxed);
+    }
+
+    uint64_t best = ~uint64_t{0};
+    for (int i = 0; i < 1000; ++i) {
+        uint64_t t0 = start();
+        uint64_t t1 = stop();
+        best = std::min(best, t1 - t0);
+    }
+    g_overhead_ns.store(best / ticks_per_ns(), std::memory_order_relaxed);
+}
+
+double TscClock::ticks_per_ns() {
+    use_tsc();
+    return g_ticks_per_ns.load(std::memory_order_relaxed);
+}
+
+double TscClock::overhead_ns() {
+    use_tsc();
+    return g_overhead_ns.load(std::memory_order_relaxed);
+}
+
+void TscClock::use_steady_clock() {
+    {
+        std::lock_guard<std::mutex> lock(g_clock_mutex);
+        state_.store(kSteady, std::memory_order_release);
+    }
+    calibrate(std::chrono::milliseconds(0));
+}
+
+LatencyHistogram::LatencyHistogram(int64_t lowest_ns, int64_t highest_ns,
+                                   int significant_digits)
+    : lowest_ns_(lowest_ns),
+      highest_ns_(highest_ns),
+      significant_digits_(significant_digits),
+      min_(std::numeric_limits<int64_t>::max()) {
+    if (lowest_ns < 1 || highest_ns < 2 * lowest_ns ||
+        significant_digits < 1 || significant_digits > 5) {
+        throw std::invalid_argument("invalid LatencyHistogram range");
+    }
+
+    // Enough linear sub-buckets per power of two to resolve 10^-digits.
+    int64_t largest_single_unit = 2 * static_cast<int64_t>(
+        std::pow(10.0, significant_digits));
+    int sub_bucket_count_magnitude =
+        static_cast<int>(std::ceil(std::log2(static_cast<double>(largest_single_unit))));
+    sub_bucket_half_count_magnitude_ = std::max(sub_bucket_count_magnitude, 1) - 1;
+    unit_magnitude_ = floor_log2(static_cast<uint64_t>(lowest_ns));
+
+    int64_t sub_bucket_count = int64_t{1} << (sub_bucket_half_count_magnitude_ + 1);
+    sub_bucket_half_count_ = sub_bucket_count / 2;
+    sub_bucket_mask_ = (sub_bucket_count - 1) << unit_magnitude_;
+
+    int64_t smallest_untrackable = sub_bucket_count << unit_magnitude_;
+    int buckets_needed = 1;
+    while (smallest_untrackable <= highest_ns) {
+        if (smallest_untrackable > std::numeric_limits<int64_t>::max() / 2) {
+            ++buckets_needed;
+            break;
+        }
+        smallest_untrackable <<= 1;
+        ++buckets_needed;
+    }
+    counts_length_ = static_cast<size_t>((buckets_needed + 1) * sub_bucket_half_count_);
+
+    counts_.reset(new std::atomic<uint64_t>[counts_length_]);
+    for (size_t i = 0; i < counts_length_; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+LatencyHistogram::LatencyHistogram(LatencyHistogram&& other) noexcept
+    : lowest_ns_(other.lowest_ns_),
+      highest_ns_(other.highest_ns_),
+      significant_digits_(other.significant_digits_),
+      unit_magnitude_(other.unit_magnitude_),
+      sub_bucket_half_count_magnitude_(other.sub_bucket_half_count_magnitude_),
+      sub_bucket_half_count_(other.sub_bucket_half_count_),
+      sub_bucket_mask_(other.sub_bucket_mask_),
+      counts_length_(other.counts_length_),
+      counts_(std::move(other.counts_)),
+      total_count_(other.total_count_.load(std::memory_order_relaxed)),
+      min_(other.min_.load(std::memory_order_relaxed)),
+      max_(other.max_.load(std::memory_order_relaxed)) {
+    other.counts_length_ = 0;
+    other.total_count_.store(0, std::memory_order_relaxed);
+}
+
+LatencyHistogram& LatencyHistogram::operator=(LatencyHistogram&& other) noexcept {
+    if (this != &other) {
+        lowest_ns_ = other.lowest_ns_;
+        highest_ns_ = other.highest_ns_;
+        significant_digits_ = other.significant_digits_;
+        unit_magnitude_ = other.unit_magnitude_;
+        sub_bucket_half_count_magnitude_ = other.sub_bucket_half_count_magnitude_;
+        sub_bucket_half_count_ = other.sub_bucket_half_count_;
+        sub_bucket_mask_ = other.sub_bucket_mask_;
+        counts_length_ = other.counts_length_;
+        counts_ = std::move(other.counts_);
+        total_count_.store(other.total_count_.load(std::memory_order_relaxed),
+                           std::memory_order_relaxed);
+        min_.store(other.min_.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+        max_.store(other.max_.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+        other.counts_length_ = 0;
+        other.total_count_.store(0, std::memory_order_relaxed);
+    }
+    return *this;
+}
+
+size_t LatencyHistogram::index_for(int64_t value) const {
+    int pow2_ceiling = floor_log2(static_cast<uint64_t>(value | sub_bucket_mask_)) + 1;
+    int bucket = pow2_ceiling - unit_magnitude_ -
+                 (sub_bucket_half_count_magnitude_ + 1);
+    int64_t sub_bucket = value >> (bucket + unit_magnitude_);
+    return static_cast<size_t>(
+        ((static_cast<int64_t>(bucket) + 1) << sub_bucket_half_count_magnitude_) +
+        (sub_bucket - sub_bucket_half_count_));
+}
+
+int64_t LatencyHistogram::value_from_index(size_t index) const {
+    int bucket = static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1;
+    int64_t sub_bucket = static_cast<int64_t>(index & (sub_bucket_half_count_ - 1)) +
+                         sub_bucket_half_count_;
+    if (bucket < 0) {
+        sub_bucket -= sub_bucket_half_count_;
+        bucket = 0;
+    }
+    return sub_bucket << (bucket + unit_magnitude_);
+}
+
+int64_t LatencyHistogram::highest_equivalent_value(size_t index) const {
+    int bucket = std::max(
+        static_cast<int>(index >> sub_bucket_half_count_magnitude_) - 1, 0);
+    return value_from_index(index) + (int64_t{1} << (bucket + unit_magnitude_)) - 1;
+}
+
+void LatencyHistogram::record_n(int64_t value_ns, uint64_t count) {
+    int64_t value = std::min(std::max<int64_t>(value_ns, 0), highest_ns_);
+    auto& bucket = counts_[index_for(value)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + count,
+                 std::memory_order_relaxed);
+    total_count_.store(total_count_.load(std::memory_order_relaxed) + count,
+                       std::memory_order_relaxed);
+    if (value < min_.load(std::memory_order_relaxed)) {
+        min_.store(value, std::memory_order_relaxed);
+    }
+    if (value > max_.load(std::memory_order_relaxed)) {
+        max_.store(value, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    if (other.counts_length_ != counts_length_ ||
+        other.unit_magnitude_ != unit_magnitude_ ||
+        other.sub_bucket_half_count_magnitude_ != sub_bucket_half_count_magnitude_) {
+        throw std::invalid_argument("cannot merge histograms with different layouts");
+    }
+
+    uint64_t added = 0;
+    for (size_t i = 0; i < counts_length_; ++i) {
+        uint64_t c = other.counts_[i].load(std::memory_order_relaxed);
+        if (c > 0) {
+            counts_[i].store(counts_[i].load(std::memory_order_relaxed) + c,
+                             std::memory_order_relaxed);
+            added += c;
+        }
+    }
+    if (added == 0) return;
+
+    total_count_.store(total_count_.load(std::memory_order_relaxed) + added,
+                       std::memory_order_relaxed);
+    min_.store(std::min(min_.load(std::memory_order_relaxed),
+                        other.min_.load(std::memory_order_relaxed)),
+               std::memory_order_relaxed);
+    max_.store(std::max(max_.load(std::memory_order_relaxed),
+                        other.max_.load(std::memory_order_relaxed)),
+               std::memory_order_relaxed);
+}
+
+void LatencyHistogram::reset() {
+    for (size_t i = 0; i < counts_length_; ++i) {
+        counts_[i].store(0, std::memory_order_relaxed);
+    }
+    total_count_.store(0, std::memory_order_relaxed);
+    min_.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+    max_.store(0, std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::min() const {
+    return count() == 0 ? 0 : min_.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::max() const {
+    return max_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const {
+    uint64_t total = count();
+    if (total == 0) return 0.0;
+    double sum = 0.0;
+    for (size_t i = 0; i < counts_length_; ++i) {
+        uint64_t c = counts_[i].load(std::memory_order_relaxed);
+        if (c > 0) {
+            double mid = 0.5 * (value_from_index(i) + highest_equivalent_value(i));
+            sum += mid * c;
+        }
+    }
+    return sum / total;
+}
+
+int64_t LatencyHistogram::value_at_percentile(double percentile) const {
+    uint64_t total = count();
+    if (total == 0) return 0;
+    double p = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t target = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(p / 100.0 * total)), 1);
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < counts_length_; ++i) {
+        cumulative += counts_[i].load(std::memory_order_relaxed);
+        if (cumulative >= target) {
+            return std::min(highest_equivalent_value(i), max());
+        }
+    }
+    return max();
+}
+
+void LatencyHistogram::write_csv_header(std::ostream& out) {
+    out << "name,value_ns,count,percentile\n";
+}
+
+void LatencyHistogram::write_csv(std::ostream& out, const std::string& name) const {
+    uint64_t total = count();
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < counts_length_; ++i) {
+        uint64_t c = counts_[i].load(std::memory_order_relaxed);
+        if (c == 0) continue;
+        cumulative += c;
+        out << name << "," << highest_equivalent_value(i) << "," << c << ","
+            << std::setprecision(6) << std::fixed
+            << 100.0 * cumulative / total << "\n";
+    }
+}
+
 }  // namespace trading
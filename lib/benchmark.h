@@ -1,21 +1,126 @@
 #ifndef LIB_BENCHMARK_H_
 #define LIB_BENCHMARK_H_
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <ostream>
 #include <string>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
 namespace trading {
 
+// Cycle-counter clock for ns-level timing. Uses the TSC when the CPU
+// reports an invariant TSC (constant rate across frequency changes, sleep
+// states and cores); otherwise every read falls back to steady_clock and a
+// tick is one nanosecond. Detection and calibration against steady_clock
+// run on first use.
+class TscClock {
+public:
+    enum class Source { TSC, STEADY_CLOCK };
+
+    static Source source() {
+        return use_tsc() ? Source::TSC : Source::STEADY_CLOCK;
+    }
+    // CPUID 0x80000007:EDX[8].
+    static bool invariant_tsc();
+
+    // Unserialized read; the CPU may reorder it with neighbouring work.
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        if (use_tsc()) return __rdtsc();
+#endif
+        return steady_ticks();
+    }
+
+    // Serialized reads bracketing a microbenchmark: start() waits for
+    // earlier instructions to retire, stop() waits for the timed code and
+    // holds back anything after it.
+    static uint64_t start() {
+#if defined(__x86_64__) || defined(__i386__)
+        if (use_tsc()) {
+            _mm_lfence();
+            uint64_t t = __rdtsc();
+            _mm_lfence();
+            return t;
+        }
+#endif
+        return steady_ticks();
+    }
+
+    static uint64_t stop() {
+#if defined(__x86_64__) || defined(__i386__)
+        if (use_tsc()) {
+            uint64_t t;
+            if (has_rdtscp_) {
+                unsigned int aux;
+                t = __rdtscp(&aux);
+            } else {
+                _mm_lfence();
+                t = __rdtsc();
+            }
+            _mm_lfence();
+            return t;
+        }
+#endif
+        return steady_ticks();
+    }
+
+    // Re-measures the tick rate over `duration`, blocking the caller.
+    static void calibrate(std::chrono::milliseconds duration =
+                              std::chrono::milliseconds(20));
+    static double ticks_per_ns();
+    // Cost of an empty start()/stop() pair, to subtract from tiny spans.
+    static double overhead_ns();
+
+    static int64_t to_ns(uint64_t ticks) {
+        return static_cast<int64_t>(ticks / ticks_per_ns());
+    }
+
+    // Forces the steady_clock fallback (e.g. on VMs whose TSC is not
+    // trustworthy). Call before taking any timestamps.
+    static void use_steady_clock();
+
+private:
+    static constexpr int kUnknown = 0;
+    static constexpr int kTsc = 1;
+    static constexpr int kSteady = 2;
+
+    static bool use_tsc() {
+        int state = state_.load(std::memory_order_acquire);
+        if (state == kUnknown) state = initialize();
+        return state == kTsc;
+    }
+
+    static int initialize();
+
+    static uint64_t steady_ticks() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count());
+    }
+
+    inline static std::atomic<int> state_{kUnknown};
+    inline static bool has_rdtscp_ = false;
+};
+
+// Wall-clock interval timer on top of TscClock.
 class Timer {
 public:
     Timer();
     void reset();
+    int64_t elapsed_ns() const;
     double elapsed_ms() const;
     double elapsed_seconds() const;
 
 private:
-    std::chrono::high_resolution_clock::time_point start_;
+    uint64_t start_;
 };
 
 struct BenchmarkResult {
@@ -30,6 +135,65 @@ BenchmarkResult run_benchmark(const std::string& name,
 void print_comparison(const BenchmarkResult& single,
                       const BenchmarkResult& multi);
 
+// HDR-style log-linear histogram of nanosecond latencies. Values keep
+// `significant_digits` of precision across [lowest_ns, highest_ns]; larger
+// values are clamped to highest_ns.
+//
+// Recording is single-writer: give each thread its own histogram and
+// merge() them afterwards. Counts are relaxed atomics, so another thread
+// may read or merge a histogram while its owner is still recording.
+class LatencyHistogram {
+public:
+    explicit LatencyHistogram(int64_t lowest_ns = 1,
+                              int64_t highest_ns = 10'000'000'000,
+                              int significant_digits = 3);
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    LatencyHistogram(LatencyHistogram&& other) noexcept;
+    LatencyHistogram& operator=(LatencyHistogram&& other) noexcept;
+
+    void record(int64_t value_ns) {
+        record_n(value_ns, 1);
+    }
+
+    void record_n(int64_t value_ns, uint64_t count);
+
+    // Adds another histogram's counts; both must share the same layout.
+    void merge(const LatencyHistogram& other);
+    void reset();
+
+    uint64_t count() const { return total_count_.load(std::memory_order_relaxed); }
+    int64_t min() const;
+    int64_t max() const;
+    double mean() const;
+    // Highest value equivalent to the bucket holding the p-th percentile.
+    int64_t value_at_percentile(double percentile) const;
+
+    // One "name,value_ns,count,percentile" row per non-empty bucket.
+    static void write_csv_header(std::ostream& out);
+    void write_csv(std::ostream& out, const std::string& name) const;
+
+private:
+    size_t index_for(int64_t value) const;
+    int64_t value_from_index(size_t index) const;
+    int64_t highest_equivalent_value(size_t index) const;
+
+    int64_t lowest_ns_;
+    int64_t highest_ns_;
+    int significant_digits_;
+    int unit_magnitude_;
+    int sub_bucket_half_count_magnitude_;
+    int64_t sub_bucket_half_count_;
+    int64_t sub_bucket_mask_;
+    size_t counts_length_;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+    std::atomic<uint64_t> total_count_{0};
+    std::atomic<int64_t> min_;
+    std::atomic<int64_t> max_{0};
+};
+
 }  // namespace trading
 
 #endif  // LIB_BENCHMARK_H_
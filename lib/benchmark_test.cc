@@ -0,0 +1,132 @@
+#include "lib/benchmark.h"
+
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+
+namespace trading {
+namespace {
+
+TEST(LatencyHistogramTest, PercentilesWithinPrecision) {
+    LatencyHistogram hist(1, 10'000'000'000, 3);
+    for (int64_t v = 1; v <= 100000; ++v) {
+        hist.record(v * 1000);  // 1 us .. 100 ms
+    }
+
+    EXPECT_EQ(hist.count(), 100000u);
+    EXPECT_EQ(hist.min(), 1000);
+    EXPECT_EQ(hist.max(), 100'000'000);
+    EXPECT_NEAR(hist.value_at_percentile(50.0), 50'000'000, 50'000'000 * 1e-3);
+    EXPECT_NEAR(hist.value_at_percentile(99.0), 99'000'000, 99'000'000 * 1e-3);
+    EXPECT_NEAR(hist.value_at_percentile(99.9), 99'900'000, 99'900'000 * 1e-3);
+    EXPECT_EQ(hist.value_at_percentile(100.0), hist.max());
+    EXPECT_NEAR(hist.mean(), 50'000'500, 50'000'500 * 1e-3);
+}
+
+TEST(LatencyHistogramTest, SmallValuesAreExact) {
+    LatencyHistogram hist;
+    hist.record(0);
+    hist.record(7);
+    hist.record_n(1500, 2);
+
+    EXPECT_EQ(hist.count(), 4u);
+    EXPECT_EQ(hist.value_at_percentile(25.0), 0);
+    EXPECT_EQ(hist.value_at_percentile(50.0), 7);
+    EXPECT_EQ(hist.value_at_percentile(100.0), 1500);
+}
+
+TEST(LatencyHistogramTest, ClampsAboveRange) {
+    LatencyHistogram hist(1, 1'000'000, 2);
+    hist.record(5'000'000);
+    EXPECT_EQ(hist.max(), 1'000'000);
+}
+
+TEST(LatencyHistogramTest, MergesPerThreadHistograms) {
+    std::vector<LatencyHistogram> per_thread;
+    for (int t = 0; t < 4; ++t) {
+        per_thread.emplace_back();
+    }
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&, t]() {
+            for (int i = 0; i < 10000; ++i) {
+                per_thread[t].record(1000 * (t + 1));
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    LatencyHistogram merged;
+    for (const auto& h : per_thread) {
+        merged.merge(h);
+    }
+    EXPECT_EQ(merged.count(), 40000u);
+    EXPECT_EQ(merged.min(), 1000);
+    EXPECT_EQ(merged.max(), 4000);
+    EXPECT_NEAR(merged.value_at_percentile(50.0), 2000, 2);
+
+    LatencyHistogram other_layout(1, 1000, 1);
+    EXPECT_THROW(merged.merge(other_layout), std::invalid_argument);
+}
+
+TEST(LatencyHistogramTest, CsvHasOneRowPerBucket) {
+    LatencyHistogram hist;
+    hist.record(100);
+    hist.record(100);
+    hist.record(200);
+
+    std::ostringstream out;
+    LatencyHistogram::write_csv_header(out);
+    hist.write_csv(out, "op");
+    EXPECT_EQ(out.str(),
+              "name,value_ns,count,percentile\n"
+              "op,100,2,66.666667\n"
+              "op,200,1,100.000000\n");
+}
+
+TEST(TscClockTest, ConvertsToNanoseconds) {
+    TscClock::calibrate(std::chrono::milliseconds(10));
+    uint64_t start = TscClock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    int64_t elapsed = TscClock::to_ns(TscClock::now() - start);
+
+    EXPECT_GE(elapsed, 19'000'000);
+    EXPECT_LT(elapsed, 500'000'000);
+}
+
+TEST(TscClockTest, SerializedReadsAreOrderedAndCheap) {
+    uint64_t t0 = TscClock::start();
+    uint64_t t1 = TscClock::stop();
+    EXPECT_GE(t1, t0);
+    EXPECT_GE(TscClock::overhead_ns(), 0.0);
+    EXPECT_LT(TscClock::overhead_ns(), 1000.0);
+
+    if (TscClock::source() == TscClock::Source::TSC) {
+        EXPECT_TRUE(TscClock::invariant_tsc());
+        EXPECT_GT(TscClock::ticks_per_ns(), 0.1);
+    }
+}
+
+TEST(TscClockTest, TimerUsesClock) {
+    Timer timer;
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    EXPECT_GE(timer.elapsed_ns(), 4'000'000);
+    EXPECT_NEAR(timer.elapsed_ms(), timer.elapsed_ns() / 1e6, 1.0);
+}
+
+// Switches the process-wide source, so keep it last.
+TEST(TscClockTest, SteadyClockFallback) {
+    TscClock::use_steady_clock();
+    EXPECT_EQ(TscClock::source(), TscClock::Source::STEADY_CLOCK);
+    EXPECT_DOUBLE_EQ(TscClock::ticks_per_ns(), 1.0);
+
+    uint64_t start = TscClock::now();
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    EXPECT_GE(TscClock::to_ns(TscClock::now() - start), 1'900'000);
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,373 @@
+#include "lib/chunked_mc.h"
+
+#include "lib/random.h"
+#include "lib/reduction.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+
+constexpr char kCheckpointMagic[8] = {'T', 'R', 'M', 'C', 'C', 'K', 'P', 'T'};
+constexpr uint32_t kCheckpointVersion = 1;
+
+uint64_t fnv1a(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Identifies the run a checkpoint belongs to. The batch size is part of
+// it because the moments are merged batch by batch.
+struct RunFingerprint {
+    uint64_t num_positions;
+    uint64_t num_simulations;
+    uint64_t batch_size;
+    uint64_t seed;
+    uint64_t inputs_hash;
+
+    bool operator==(const RunFingerprint& other) const {
+        return num_positions == other.num_positions &&
+               num_simulations == other.num_simulations &&
+               batch_size == other.batch_size && seed == other.seed &&
+               inputs_hash == other.inputs_hash;
+    }
+};
+
+RunFingerprint fingerprint(const McInputs& inputs, const ChunkedMcConfig& config) {
+    size_t bytes = inputs.notional.size() * sizeof(double);
+    uint64_t hash = fnv1a(inputs.drift.data(), bytes);
+    hash = fnv1a(inputs.vol_sqrt_t.data(), bytes, hash);
+    hash = fnv1a(inputs.notional.data(), bytes, hash);
+    return {inputs.notional.size(), config.num_simulations, config.batch_size,
+            config.seed, hash};
+}
+
+template <typename T>
+void put(std::string* out, const T& value) {
+    out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool get(const std::string& in, size_t* offset, T* value) {
+    if (in.size() - *offset < sizeof(T)) return false;
+    std::memcpy(value, in.data() + *offset, sizeof(T));
+    *offset += sizeof(T);
+    return true;
+}
+
+// Layout (native byte order): magic, version, fingerprint, next batch,
+// count, mean, M2, tail length, tail values, FNV-1a of everything before.
+std::string encode_checkpoint(const RunFingerprint& run, uint64_t next_batch,
+                              const PnlTail& tail) {
+    std::string bytes;
+    bytes.reserve(96 + tail.lowest().size() * sizeof(double));
+    bytes.append(kCheckpointMagic, sizeof(kCheckpointMagic));
+    put(&bytes, kCheckpointVersion);
+    put(&bytes, run);
+    put(&bytes, next_batch);
+    put(&bytes, tail.count());
+    put(&bytes, tail.mean());
+    put(&bytes, tail.m2());
+    put(&bytes, static_cast<uint64_t>(tail.lowest().size()));
+    bytes.append(reinterpret_cast<const char*>(tail.lowest().data()),
+                 tail.lowest().size() * sizeof(double));
+    put(&bytes, fnv1a(bytes.data(), bytes.size()));
+    return bytes;
+}
+
+void decode_checkpoint(const std::string& bytes, const std::string& path,
+                       const RunFingerprint& expected, uint64_t* next_batch,
+                       PnlTail* tail) {
+    auto corrupt = [&path]() {
+        return std::runtime_error("checkpoint " + path + " is corrupt");
+    };
+    uint64_t stored_hash;
+    if (bytes.size() < sizeof(kCheckpointMagic) + sizeof(stored_hash)) throw corrupt();
+    size_t body = bytes.size() - sizeof(stored_hash);
+    std::memcpy(&stored_hash, bytes.data() + body, sizeof(stored_hash));
+    if (std::memcmp(bytes.data(), kCheckpointMagic, sizeof(kCheckpointMagic)) != 0 ||
+        fnv1a(bytes.data(), body) != stored_hash) {
+        throw corrupt();
+    }
+
+    std::string content = bytes.substr(0, body);
+    size_t offset = sizeof(kCheckpointMagic);
+    uint32_t version;
+    RunFingerprint run;
+    uint64_t count;
+    double mean;
+    double m2;
+    uint64_t tail_size;
+    if (!get(content, &offset, &version) || version != kCheckpointVersion) throw corrupt();
+    if (!get(content, &offset, &run) || !get(content, &offset, next_batch) ||
+        !get(content, &offset, &count) || !get(content, &offset, &mean) ||
+        !get(content, &offset, &m2) || !get(content, &offset, &tail_size) ||
+        (content.size() - offset) / sizeof(double) != tail_size) {
+        throw corrupt();
+    }
+    if (!(run == expected)) {
+        throw std::runtime_error("checkpoint " + path + " was written by a different run");
+    }
+    std::vector<double> lowest(tail_size);
+    std::memcpy(lowest.data(), content.data() + offset, tail_size * sizeof(double));
+    tail->restore(count, mean, m2, std::move(lowest));
+}
+
+// Returns false if there is no checkpoint yet.
+bool read_file(const std::string& path, std::string* bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        if (errno == ENOENT) return false;
+        throw std::runtime_error("cannot open checkpoint " + path + ": " +
+                                 std::strerror(errno));
+    }
+    bytes->clear();
+    char buffer[1 << 16];
+    size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes->append(buffer, n);
+    }
+    bool failed = std::ferror(file);
+    std::fclose(file);
+    if (failed) throw std::runtime_error("cannot read checkpoint " + path);
+    return true;
+}
+
+// Writes to path.tmp, syncs it and renames it over path, so a crash leaves
+// either the previous checkpoint or the new one.
+void write_file_atomically(const std::string& path, const std::string& bytes) {
+    std::string tmp = path + ".tmp";
+    int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("cannot write checkpoint " + tmp + ": " +
+                                 std::strerror(errno));
+    }
+    size_t written = 0;
+    while (written < bytes.size()) {
+        ssize_t n = ::write(fd, bytes.data() + written, bytes.size() - written);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            int error = errno;
+            ::close(fd);
+            throw std::runtime_error("cannot write checkpoint " + tmp + ": " +
+                                     std::strerror(error));
+        }
+        written += static_cast<size_t>(n);
+    }
+    bool synced = ::fsync(fd) == 0;
+    bool closed = ::close(fd) == 0;
+    if (!synced || !closed || std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("cannot commit checkpoint " + path + ": " +
+                                 std::strerror(errno));
+    }
+}
+
+}  // namespace
+
+void simulate_pnl_scenarios(const McInputs& inputs, uint64_t seed,
+                            uint64_t first, size_t count, double* out) {
+    Philox4x32 rng(seed);
+    size_t n = inputs.notional.size();
+    const double* drift = inputs.drift.data();
+    const double* vol_sqrt_t = inputs.vol_sqrt_t.data();
+    const double* notional = inputs.notional.data();
+
+    for (size_t k = 0; k < count; ++k) {
+        uint64_t scenario = first + k;
+        double portfolio_pnl = 0.0;
+        for (size_t i = 0; i < n; i += 4) {
+            std::array<double, 4> z = normal_quad(rng(scenario, i / 4));
+            size_t lanes = std::min<size_t>(4, n - i);
+            for (size_t j = 0; j < lanes; ++j) {
+                double price_change_factor =
+                    std::exp(drift[i + j] + vol_sqrt_t[i + j] * z[j]);
+                portfolio_pnl += notional[i + j] * (price_change_factor - 1.0);
+            }
+        }
+        out[k] = portfolio_pnl;
+    }
+}
+
+size_t PnlTail::capacity_for(uint64_t num_simulations) {
+    return static_cast<size_t>(std::min<uint64_t>(
+        static_cast<uint64_t>(num_simulations * 0.05) + 1, num_simulations));
+}
+
+void PnlTail::add(const double* pnl, size_t count) {
+    if (count == 0) return;
+    double mean = reduce_sum(pnl, count, Summation::NEUMAIER) / count;
+    NeumaierSum m2;
+    for (size_t i = 0; i < count; ++i) {
+        m2.add((pnl[i] - mean) * (pnl[i] - mean));
+    }
+    merge_moments(count, mean, m2.value());
+
+    lowest_.insert(lowest_.end(), pnl, pnl + count);
+    if (lowest_.size() > 2 * capacity_) {
+        std::nth_element(lowest_.begin(), lowest_.begin() + capacity_, lowest_.end());
+        lowest_.resize(capacity_);
+    }
+}
+
+void PnlTail::merge(const PnlTail& other) {
+    if (other.count_ == 0) return;
+    merge_moments(other.count_, other.mean_, other.m2_);
+    lowest_.insert(lowest_.end(), other.lowest_.begin(), other.lowest_.end());
+    if (lowest_.size() > 2 * capacity_) {
+        std::nth_element(lowest_.begin(), lowest_.begin() + capacity_, lowest_.end());
+        lowest_.resize(capacity_);
+    }
+}
+
+void PnlTail::compact() {
+    if (lowest_.size() > capacity_) {
+        std::nth_element(lowest_.begin(), lowest_.begin() + capacity_, lowest_.end());
+        lowest_.resize(capacity_);
+    }
+    std::sort(lowest_.begin(), lowest_.end());
+}
+
+void PnlTail::merge_moments(uint64_t count, double mean, double m2) {
+    if (count_ == 0) {
+        count_ = count;
+        mean_ = mean;
+        m2_ = m2;
+        return;
+    }
+    double total = static_cast<double>(count_ + count);
+    double delta = mean - mean_;
+    mean_ += delta * (count / total);
+    m2_ += m2 + delta * delta * (count_ * (count / total));
+    count_ += count;
+}
+
+void PnlTail::restore(uint64_t count, double mean, double m2, std::vector<double> lowest) {
+    count_ = count;
+    mean_ = mean;
+    m2_ = m2;
+    lowest_ = std::move(lowest);
+}
+
+VaRResult PnlTail::var() const {
+    if (count_ == 0) {
+        return {0.0, 0.0, 0.0, 0.0, 0.0};
+    }
+
+    std::vector<double> sorted = lowest_;
+    std::sort(sorted.begin(), sorted.end());
+    size_t idx_95 = static_cast<size_t>(count_ * 0.05);
+    size_t idx_99 = static_cast<size_t>(count_ * 0.01);
+    if (idx_95 >= sorted.size()) {
+        throw std::logic_error("P&L tail too small for the 95% quantile");
+    }
+
+    VaRResult result;
+    result.var_95 = -sorted[idx_95];
+    result.var_99 = -sorted[idx_99];
+    result.expected_shortfall =
+        -reduce_sum(sorted.data(), idx_99 + 1, Summation::NEUMAIER) / (idx_99 + 1);
+    result.mean_pnl = mean_;
+    result.std_pnl = std::sqrt(m2_ / count_);
+    return result;
+}
+
+ChunkedMcResult run_monte_carlo_chunked(const McInputs& inputs,
+                                        const ChunkedMcConfig& config) {
+    uint64_t total = config.num_simulations;
+    size_t batch_size = std::max<size_t>(config.batch_size, 1);
+    uint64_t num_batches = (total + batch_size - 1) / batch_size;
+    size_t num_threads = static_cast<size_t>(std::max(config.num_threads, 1));
+    bool checkpointing = !config.checkpoint_path.empty();
+    RunFingerprint run = fingerprint(inputs, config);
+
+    ChunkedMcResult result{};
+    PnlTail tail(PnlTail::capacity_for(total));
+    uint64_t next_batch = 0;
+
+    std::string bytes;
+    if (checkpointing && read_file(config.checkpoint_path, &bytes)) {
+        decode_checkpoint(bytes, config.checkpoint_path, run, &next_batch, &tail);
+        result.resumed_from = tail.count();
+    }
+
+    // At most one write in flight; the state is serialized on this thread
+    // so the workers can keep folding batches while it is written.
+    std::future<void> pending_write;
+    auto write_checkpoint = [&]() {
+        tail.compact();
+        std::string snapshot = encode_checkpoint(run, next_batch, tail);
+        if (pending_write.valid()) pending_write.get();
+        pending_write = std::async(std::launch::async,
+                                   [path = config.checkpoint_path,
+                                    snapshot = std::move(snapshot)]() {
+            write_file_atomically(path, snapshot);
+        });
+        ++result.checkpoints_written;
+    };
+
+    std::vector<std::vector<double>> buffers(num_threads, std::vector<double>(batch_size));
+    std::vector<size_t> sizes(num_threads);
+    size_t batches_run = 0;
+    size_t since_checkpoint = 0;
+
+    while (next_batch < num_batches &&
+           (config.batch_limit == 0 || batches_run < config.batch_limit)) {
+        uint64_t round = std::min<uint64_t>(num_threads, num_batches - next_batch);
+        if (config.batch_limit > 0) {
+            round = std::min<uint64_t>(round, config.batch_limit - batches_run);
+        }
+
+        auto price = [&](size_t t) {
+            uint64_t first = (next_batch + t) * batch_size;
+            sizes[t] = static_cast<size_t>(std::min<uint64_t>(batch_size, total - first));
+            simulate_pnl_scenarios(inputs, config.seed, first, sizes[t], buffers[t].data());
+        };
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < round; ++t) {
+            threads.emplace_back(price, t);
+        }
+        price(0);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (size_t t = 0; t < round; ++t) {
+            tail.add(buffers[t].data(), sizes[t]);
+        }
+        next_batch += round;
+        batches_run += round;
+        since_checkpoint += round;
+
+        if (checkpointing && since_checkpoint >= config.checkpoint_every &&
+            next_batch < num_batches) {
+            write_checkpoint();
+            since_checkpoint = 0;
+        }
+    }
+
+    if (checkpointing && since_checkpoint > 0) {
+        write_checkpoint();
+    }
+    if (pending_write.valid()) pending_write.get();
+
+    result.var = tail.var();
+    result.scenarios_done = tail.count();
+    result.complete = (next_batch == num_batches);
+    return result;
+}
+
+}  // namespace trading
@@ -0,0 +1,97 @@
+#ifndef LIB_CHUNKED_MC_H_
+#define LIB_CHUNKED_MC_H_
+
+#include "lib/monte_carlo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// P&L of scenarios [first, first + count) into out[0, count). Shocks come
+// from Philox keyed by `seed`, indexed by (scenario, position / 4), so a
+// scenario's P&L does not depend on how the run is batched or threaded.
+void simulate_pnl_scenarios(const McInputs& inputs, uint64_t seed,
+                            uint64_t first, size_t count, double* out);
+
+// Mergeable summary of a P&L sample: count, mean and M2 (Chan et al.
+// pairwise update) plus the `capacity` lowest values, which is all VaR and
+// ES need. Holding ~5% of the scenarios instead of all of them is what
+// makes the state small enough to checkpoint.
+class PnlTail {
+public:
+    PnlTail() = default;
+    explicit PnlTail(size_t capacity) : capacity_(capacity) {}
+
+    // Smallest tail that still answers VaR(95%) over num_simulations.
+    static size_t capacity_for(uint64_t num_simulations);
+
+    void add(const double* pnl, size_t count);
+    void merge(const PnlTail& other);
+    // Trims to capacity and sorts ascending; add/merge leave the buffer in
+    // no particular order.
+    void compact();
+
+    // Same definitions as calculate_var; exact for VaR/ES as long as the
+    // capacity covers the 95% quantile of count().
+    VaRResult var() const;
+
+    uint64_t count() const { return count_; }
+    size_t capacity() const { return capacity_; }
+    double mean() const { return mean_; }
+    double m2() const { return m2_; }
+    const std::vector<double>& lowest() const { return lowest_; }
+
+    // Restores a compacted state (e.g. from a checkpoint).
+    void restore(uint64_t count, double mean, double m2, std::vector<double> lowest);
+
+private:
+    void merge_moments(uint64_t count, double mean, double m2);
+
+    size_t capacity_ = 0;
+    uint64_t count_ = 0;
+    double mean_ = 0.0;
+    double m2_ = 0.0;
+    std::vector<double> lowest_;
+};
+
+struct ChunkedMcConfig {
+    uint64_t num_simulations = 100000;
+    size_t batch_size = 1 << 16;   // Scenarios per batch
+    uint64_t seed = 42;
+    int num_threads = 1;           // Batches priced concurrently
+    std::string checkpoint_path;   // Empty: no checkpoints, no resume
+    size_t checkpoint_every = 64;  // Batches between checkpoints
+    size_t batch_limit = 0;        // Stop after this many batches; 0 = run to the end
+};
+
+struct ChunkedMcResult {
+    VaRResult var;                 // Over the scenarios done so far
+    uint64_t scenarios_done;
+    bool complete;
+    uint64_t resumed_from;         // Scenarios restored from the checkpoint
+    size_t checkpoints_written;
+};
+
+// Monte Carlo VaR in fixed-size batches with bounded memory. Batches are
+// priced num_threads at a time and folded into a PnlTail in batch order,
+// so the result is the same for every thread count. VaR and ES equal
+// calculate_var over the full P&L vector exactly; mean and std agree to
+// rounding.
+//
+// With a checkpoint path, the state (tail, moments and the next scenario
+// index) is written every checkpoint_every batches and at the end, on a
+// background thread while the next batches run; each write goes to a
+// temporary file renamed over the previous checkpoint. A run that finds a
+// checkpoint for the same inputs and configuration resumes from it and
+// finishes with exactly the result of an uninterrupted run. Throws
+// std::runtime_error for an unreadable checkpoint or one written by a
+// different run.
+ChunkedMcResult run_monte_carlo_chunked(const McInputs& inputs,
+                                        const ChunkedMcConfig& config);
+
+}  // namespace trading
+
+#endif  // LIB_CHUNKED_MC_H_
@@ -0,0 +1,164 @@
+#include "lib/chunked_mc.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace trading {
+namespace {
+
+std::string checkpoint_path(const std::string& name) {
+    std::string path = ::testing::TempDir() + "chunked_mc_" + name + ".ckpt";
+    std::remove(path.c_str());
+    return path;
+}
+
+void expect_same_var(const VaRResult& a, const VaRResult& b) {
+    EXPECT_EQ(a.var_95, b.var_95);
+    EXPECT_EQ(a.var_99, b.var_99);
+    EXPECT_EQ(a.expected_shortfall, b.expected_shortfall);
+    EXPECT_EQ(a.mean_pnl, b.mean_pnl);
+    EXPECT_EQ(a.std_pnl, b.std_pnl);
+}
+
+TEST(ChunkedMcTest, MatchesFullSampleVaR) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(30, 42), 1.0/252.0);
+    ChunkedMcConfig config;
+    config.num_simulations = 20011;
+    config.batch_size = 1000;
+    config.seed = 5;
+
+    std::vector<double> pnl(config.num_simulations);
+    simulate_pnl_scenarios(inputs, config.seed, 0, pnl.size(), pnl.data());
+    VaRResult expected = calculate_var(pnl);
+
+    ChunkedMcResult result = run_monte_carlo_chunked(inputs, config);
+    EXPECT_TRUE(result.complete);
+    EXPECT_EQ(result.scenarios_done, config.num_simulations);
+    EXPECT_EQ(result.var.var_95, expected.var_95);
+    EXPECT_EQ(result.var.var_99, expected.var_99);
+    EXPECT_EQ(result.var.expected_shortfall, expected.expected_shortfall);
+    EXPECT_NEAR(result.var.mean_pnl, expected.mean_pnl, 1e-9 * expected.std_pnl);
+    EXPECT_NEAR(result.var.std_pnl, expected.std_pnl, 1e-9 * expected.std_pnl);
+    EXPECT_GT(result.var.var_99, result.var.var_95);
+}
+
+TEST(ChunkedMcTest, ScenariosDoNotDependOnBatching) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(7, 3), 1.0/252.0);
+    std::vector<double> whole(100);
+    simulate_pnl_scenarios(inputs, 11, 0, whole.size(), whole.data());
+    std::vector<double> tail(40);
+    simulate_pnl_scenarios(inputs, 11, 60, tail.size(), tail.data());
+    for (size_t k = 0; k < tail.size(); ++k) {
+        EXPECT_EQ(tail[k], whole[60 + k]);
+    }
+}
+
+TEST(ChunkedMcTest, ThreadCountDoesNotChangeResult) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(20, 8), 1.0/252.0);
+    ChunkedMcConfig config;
+    config.num_simulations = 9000;
+    config.batch_size = 700;
+
+    VaRResult reference = run_monte_carlo_chunked(inputs, config).var;
+    for (int threads : {2, 3, 5}) {
+        config.num_threads = threads;
+        expect_same_var(run_monte_carlo_chunked(inputs, config).var, reference);
+    }
+}
+
+TEST(ChunkedMcTest, ResumedRunMatchesUninterruptedRun) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(25, 19), 1.0/252.0);
+    ChunkedMcConfig config;
+    config.num_simulations = 12345;
+    config.batch_size = 500;
+    config.num_threads = 3;
+    VaRResult uninterrupted = run_monte_carlo_chunked(inputs, config).var;
+
+    config.checkpoint_path = checkpoint_path("resume");
+    config.checkpoint_every = 2;
+    config.batch_limit = 7;
+    ChunkedMcResult first = run_monte_carlo_chunked(inputs, config);
+    EXPECT_FALSE(first.complete);
+    EXPECT_EQ(first.scenarios_done, 7u * 500u);
+    EXPECT_EQ(first.resumed_from, 0u);
+    EXPECT_GE(first.checkpoints_written, 2u);
+
+    // Resume with a different thread count; the limit applies per call.
+    config.num_threads = 2;
+    ChunkedMcResult second = run_monte_carlo_chunked(inputs, config);
+    EXPECT_EQ(second.resumed_from, 7u * 500u);
+    EXPECT_FALSE(second.complete);
+
+    config.batch_limit = 0;
+    ChunkedMcResult rest = run_monte_carlo_chunked(inputs, config);
+    EXPECT_TRUE(rest.complete);
+    EXPECT_EQ(rest.scenarios_done, config.num_simulations);
+    expect_same_var(rest.var, uninterrupted);
+
+    // A finished checkpoint just reports the result again.
+    ChunkedMcResult again = run_monte_carlo_chunked(inputs, config);
+    EXPECT_TRUE(again.complete);
+    EXPECT_EQ(again.resumed_from, config.num_simulations);
+    EXPECT_EQ(again.checkpoints_written, 0u);
+    expect_same_var(again.var, uninterrupted);
+    std::remove(config.checkpoint_path.c_str());
+}
+
+TEST(ChunkedMcTest, RejectsForeignOrCorruptCheckpoints) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(10, 2), 1.0/252.0);
+    ChunkedMcConfig config;
+    config.num_simulations = 2000;
+    config.batch_size = 250;
+    config.checkpoint_path = checkpoint_path("reject");
+    config.batch_limit = 2;
+    run_monte_carlo_chunked(inputs, config);
+
+    ChunkedMcConfig other_seed = config;
+    other_seed.seed = 43;
+    EXPECT_THROW(run_monte_carlo_chunked(inputs, other_seed), std::runtime_error);
+    auto other_inputs = prepare_mc_inputs(generate_random_positions(10, 3), 1.0/252.0);
+    EXPECT_THROW(run_monte_carlo_chunked(other_inputs, config), std::runtime_error);
+
+    {
+        std::fstream file(config.checkpoint_path,
+                          std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(40);
+        file.put('\x7f');
+    }
+    EXPECT_THROW(run_monte_carlo_chunked(inputs, config), std::runtime_error);
+    std::remove(config.checkpoint_path.c_str());
+}
+
+TEST(PnlTailTest, MergeKeepsLowestValuesAndMoments) {
+    std::vector<double> values(1000);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = std::sin(i * 0.37) * 100.0;
+    }
+    PnlTail whole(PnlTail::capacity_for(values.size()));
+    whole.add(values.data(), values.size());
+
+    PnlTail left(PnlTail::capacity_for(values.size()));
+    PnlTail right(PnlTail::capacity_for(values.size()));
+    left.add(values.data(), 400);
+    right.add(values.data() + 400, 600);
+    left.merge(right);
+
+    VaRResult expected = calculate_var(values);
+    for (const PnlTail* tail : {&whole, &left}) {
+        VaRResult actual = tail->var();
+        EXPECT_EQ(actual.var_95, expected.var_95);
+        EXPECT_EQ(actual.var_99, expected.var_99);
+        EXPECT_EQ(actual.expected_shortfall, expected.expected_shortfall);
+        EXPECT_NEAR(actual.mean_pnl, expected.mean_pnl, 1e-12);
+        EXPECT_NEAR(actual.std_pnl, expected.std_pnl, 1e-12);
+    }
+    left.compact();
+    EXPECT_EQ(left.lowest().size(), PnlTail::capacity_for(values.size()));
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,49 @@
+// Replaces the global operator new/delete so that allocations feed the
+// counters in lib/memory_stats.h. Link it into a binary only when heap
+// traffic should be reported; it has no header and is always linked whole.
+
+#include "lib/memory_stats.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* counted_alloc(std::size_t size) {
+    trading::record_allocation(size);
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* counted_aligned_alloc(std::size_t size, std::align_val_t alignment) {
+    trading::record_allocation(size);
+    std::size_t align = static_cast<std::size_t>(alignment);
+    void* p = std::aligned_alloc(align, (size + align - 1) / align * align);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void counted_free(void* p) {
+    if (p) trading::record_deallocation();
+    std::free(p);
+}
+
+struct HookInstalled {
+    HookInstalled() { trading::mark_allocation_hook_installed(); }
+} hook_installed;
+
+}  // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void* operator new(std::size_t size, std::align_val_t a) { return counted_aligned_alloc(size, a); }
+void* operator new[](std::size_t size, std::align_val_t a) { return counted_aligned_alloc(size, a); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
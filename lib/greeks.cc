@@ -1,142 +1,257 @@
 #include "lib/greeks.h"
 
-#ifndef _USE_MATH_DEFINES
-#define _USE_MATH_DEFINES
-#endif
+#include "lib/lattice.h"
+#include "lib/reduction.h"
+
 #include <cmath>
 #include <future>
 #include <thread>
 #include <vector>
 
-// Fallback definitions for portability
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
-#ifndef M_SQRT1_2
-#define M_SQRT1_2 0.70710678118654752440
-#endif
-
 namespace trading {
 
 double normal_cdf(double x) {
-    return 0.5 * std::erfc(-x * M_SQRT1_2);
+    return PreciseNormal::cdf(x);
 }
 
 double normal_pdf(double x) {
-    return std::exp(-0.5 * x * x) / std::sqrt(2.0 * M_PI);
+    return PreciseNormal::pdf(x);
 }
 
+template <typename NormalPolicy>
 double black_scholes_price(double spot, double strike, double vol,
                            double rate, double time, bool is_call) {
-    if (time <= 0.0 || vol <= 0.0) {
-        double intrinsic = is_call ? std::max(spot - strike, 0.0)
-                                   : std::max(strike - spot, 0.0);
-        return intrinsic;
-    }
+    return is_call
+        ? black_scholes_price_typed<true, NormalPolicy>(spot, strike, vol, rate, time)
+        : black_scholes_price_typed<false, NormalPolicy>(spot, strike, vol, rate, time);
+}
 
-    double d1 = (std::log(spot / strike) + (rate + 0.5 * vol * vol) * time) /
-                (vol * std::sqrt(time));
-    double d2 = d1 - vol * std::sqrt(time);
+namespace {
 
-    if (is_call) {
-        return spot * normal_cdf(d1) -
-               strike * std::exp(-rate * time) * normal_cdf(d2);
-    } else {
-        return strike * std::exp(-rate * time) * normal_cdf(-d2) -
-               spot * normal_cdf(-d1);
-    }
+template <typename T>
+GreeksT<T> round_greeks(const Greeks& g) {
+    return {static_cast<T>(g.price), static_cast<T>(g.delta), static_cast<T>(g.gamma),
+            static_cast<T>(g.vega), static_cast<T>(g.theta)};
 }
 
-Greeks calculate_greeks(const Position& pos, double bump_size) {
-    Greeks result{};
+}  // namespace
 
+template <typename NormalPolicy, typename T>
+GreeksT<T> calculate_greeks(const Position& pos, double bump_size) {
     if (pos.type == PositionType::STOCK) {
-        result.price = pos.price;
-        result.delta = 1.0;
-        result.gamma = 0.0;
-        result.vega = 0.0;
-        result.theta = 0.0;
-        return result;
+        return calculate_greeks_typed<PositionType::STOCK, NormalPolicy, T>(pos, bump_size);
     }
 
-    bool is_call = (pos.type == PositionType::OPTION_CALL);
-    double spot = pos.price;
-    double strike = pos.strike;
-    double vol = pos.volatility;
-    double rate = pos.risk_free_rate;
-    double time = pos.time_to_expiry;
+    if (pos.exercise == ExerciseStyle::AMERICAN) {
+        return round_greeks<T>(calculate_lattice_greeks(
+            pos, kDefaultLatticeSteps, LatticeMethod::LEISEN_REIMER, bump_size));
+    }
 
-    result.price = black_scholes_price(spot, strike, vol, rate, time, is_call);
+    if (pos.type == PositionType::OPTION_CALL) {
+        return calculate_greeks_typed<PositionType::OPTION_CALL, NormalPolicy, T>(
+            pos, bump_size);
+    }
+    return calculate_greeks_typed<PositionType::OPTION_PUT, NormalPolicy, T>(pos, bump_size);
+}
 
-    double spot_up = spot * (1.0 + bump_size);
-    double spot_down = spot * (1.0 - bump_size);
-    double price_up = black_scholes_price(spot_up, strike, vol, rate, time, is_call);
-    double price_down = black_scholes_price(spot_down, strike, vol, rate, time, is_call);
+template <typename NormalPolicy, typename T>
+std::vector<GreeksT<T>> calculate_all_greeks_single(
+    const std::vector<Position>& positions, double bump_size) {
+    std::vector<GreeksT<T>> results(positions.size());
+    calculate_all_greeks_single<NormalPolicy, T>(positions, results.data(), bump_size);
+    return results;
+}
 
-    result.delta = (price_up - price_down) / (spot_up - spot_down);
-    result.gamma = (price_up - 2.0 * result.price + price_down) /
-                   ((spot * bump_size) * (spot * bump_size));
+template <typename NormalPolicy, typename T>
+void calculate_all_greeks_single(
+    const std::vector<Position>& positions, GreeksT<T>* out, double bump_size) {
+    for (size_t i = 0; i < positions.size(); ++i) {
+        out[i] = calculate_greeks<NormalPolicy, T>(positions[i], bump_size);
+    }
+}
 
-    double vol_up = vol + bump_size;
-    double price_vol_up = black_scholes_price(spot, strike, vol_up, rate, time, is_call);
-    result.vega = (price_vol_up - result.price) / bump_size;
+template <typename NormalPolicy, typename T>
+std::vector<GreeksT<T>> calculate_all_greeks_multi(
+    const std::vector<Position>& positions, int num_threads,
+    double bump_size) {
+    std::vector<GreeksT<T>> results(positions.size());
+    for_each_greeks_multi<NormalPolicy, T>(
+        positions, num_threads,
+        [&](int, size_t i, const GreeksT<T>& g) { results[i] = g; }, bump_size);
+    return results;
+}
 
-    double time_down = std::max(time - 1.0/365.0, 0.001);
-    double price_time_down = black_scholes_price(spot, strike, vol, rate, time_down, is_call);
-    result.theta = (price_time_down - result.price) * 365.0;
+TypePartition partition_by_type(const std::vector<Position>& positions) {
+    TypePartition partition;
+    partition.order.reserve(positions.size());
+    auto append = [&](auto matches) {
+        for (size_t i = 0; i < positions.size(); ++i) {
+            if (matches(positions[i])) {
+                partition.order.push_back(static_cast<uint32_t>(i));
+            }
+        }
+        return partition.order.size();
+    };
+    auto european = [](const Position& pos) {
+        return pos.exercise == ExerciseStyle::EUROPEAN;
+    };
 
-    return result;
+    partition.calls_end = append([&](const Position& pos) {
+        return pos.type == PositionType::OPTION_CALL && european(pos);
+    });
+    partition.puts_end = append([&](const Position& pos) {
+        return pos.type == PositionType::OPTION_PUT && european(pos);
+    });
+    partition.stocks_end = append([](const Position& pos) {
+        return pos.type == PositionType::STOCK;
+    });
+    append([&](const Position& pos) {
+        return pos.type != PositionType::STOCK && !european(pos);
+    });
+    return partition;
 }
 
-std::vector<Greeks> calculate_all_greeks_single(
-    const std::vector<Position>& positions, double bump_size) {
-    std::vector<Greeks> results;
-    results.reserve(positions.size());
+namespace {
 
-    for (const auto& pos : positions) {
-        results.push_back(calculate_greeks(pos, bump_size));
+template <PositionType Type, typename NormalPolicy, typename T>
+void price_segment(const std::vector<Position>& positions, const uint32_t* indices,
+                   size_t count, double bump_size, GreeksT<T>* results) {
+    for (size_t k = 0; k < count; ++k) {
+        uint32_t i = indices[k];
+        results[i] = calculate_greeks_typed<Type, NormalPolicy, T>(positions[i], bump_size);
     }
+}
 
-    return results;
+// Prices partition.order[start, end), one specialized loop per type segment
+// the range overlaps.
+template <typename NormalPolicy, typename T>
+void price_partition_range(const std::vector<Position>& positions,
+                           const TypePartition& partition, size_t start, size_t end,
+                           double bump_size, GreeksT<T>* results) {
+    const uint32_t* order = partition.order.data();
+    auto clip = [&](size_t lo, size_t hi) {
+        lo = std::max(lo, start);
+        hi = std::min(hi, end);
+        return std::make_pair(lo, hi > lo ? hi - lo : 0);
+    };
+
+    auto [calls, num_calls] = clip(0, partition.calls_end);
+    price_segment<PositionType::OPTION_CALL, NormalPolicy>(
+        positions, order + calls, num_calls, bump_size, results);
+    auto [puts, num_puts] = clip(partition.calls_end, partition.puts_end);
+    price_segment<PositionType::OPTION_PUT, NormalPolicy>(
+        positions, order + puts, num_puts, bump_size, results);
+    auto [stocks, num_stocks] = clip(partition.puts_end, partition.stocks_end);
+    price_segment<PositionType::STOCK, NormalPolicy>(
+        positions, order + stocks, num_stocks, bump_size, results);
+    auto [american, num_american] = clip(partition.stocks_end, partition.order.size());
+    for (size_t k = 0; k < num_american; ++k) {
+        uint32_t i = order[american + k];
+        results[i] = round_greeks<T>(calculate_lattice_greeks(
+            positions[i], kDefaultLatticeSteps, LatticeMethod::LEISEN_REIMER, bump_size));
+    }
 }
 
-std::vector<Greeks> calculate_all_greeks_multi(
-    const std::vector<Position>& positions, int num_threads,
-    double bump_size) {
-    std::vector<Greeks> results(positions.size());
+}  // namespace
 
-    auto worker = [&](size_t start, size_t end) {
-        for (size_t i = start; i < end; ++i) {
-            results[i] = calculate_greeks(positions[i], bump_size);
-        }
-    };
+template <typename NormalPolicy, typename T>
+std::vector<GreeksT<T>> calculate_all_greeks_partitioned_single(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    double bump_size) {
+    std::vector<GreeksT<T>> results(positions.size());
+    price_partition_range<NormalPolicy>(positions, partition, 0, partition.order.size(),
+                                        bump_size, results.data());
+    return results;
+}
 
+template <typename NormalPolicy, typename T>
+std::vector<GreeksT<T>> calculate_all_greeks_partitioned_multi(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    int num_threads, double bump_size) {
+    std::vector<GreeksT<T>> results(positions.size());
     std::vector<std::thread> threads;
-    size_t chunk_size = (positions.size() + num_threads - 1) / num_threads;
+    size_t count = partition.order.size();
+    size_t chunk_size = (count + num_threads - 1) / num_threads;
 
     for (int t = 0; t < num_threads; ++t) {
         size_t start = t * chunk_size;
-        size_t end = std::min(start + chunk_size, positions.size());
+        size_t end = std::min(start + chunk_size, count);
         if (start < end) {
-            threads.emplace_back(worker, start, end);
+            threads.emplace_back([&, start, end]() {
+                price_partition_range<NormalPolicy>(positions, partition, start, end,
+                                                    bump_size, results.data());
+            });
         }
     }
 
     for (auto& thread : threads) {
         thread.join();
     }
-
     return results;
 }
 
-double total_portfolio_delta(const std::vector<Greeks>& greeks,
+template double black_scholes_price<PreciseNormal>(
+    double, double, double, double, double, bool);
+template double black_scholes_price<FastNormal>(
+    double, double, double, double, double, bool);
+template Greeks calculate_greeks<PreciseNormal, double>(const Position&, double);
+template Greeks calculate_greeks<FastNormal, double>(const Position&, double);
+template GreeksT<float> calculate_greeks<PreciseNormal, float>(const Position&, double);
+template GreeksT<float> calculate_greeks<FastNormal, float>(const Position&, double);
+template std::vector<Greeks> calculate_all_greeks_single<PreciseNormal, double>(
+    const std::vector<Position>&, double);
+template std::vector<Greeks> calculate_all_greeks_single<FastNormal, double>(
+    const std::vector<Position>&, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_single<PreciseNormal, float>(
+    const std::vector<Position>&, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_single<FastNormal, float>(
+    const std::vector<Position>&, double);
+template void calculate_all_greeks_single<PreciseNormal, double>(
+    const std::vector<Position>&, Greeks*, double);
+template void calculate_all_greeks_single<FastNormal, double>(
+    const std::vector<Position>&, Greeks*, double);
+template void calculate_all_greeks_single<PreciseNormal, float>(
+    const std::vector<Position>&, GreeksT<float>*, double);
+template void calculate_all_greeks_single<FastNormal, float>(
+    const std::vector<Position>&, GreeksT<float>*, double);
+template std::vector<Greeks> calculate_all_greeks_multi<PreciseNormal, double>(
+    const std::vector<Position>&, int, double);
+template std::vector<Greeks> calculate_all_greeks_multi<FastNormal, double>(
+    const std::vector<Position>&, int, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_multi<PreciseNormal, float>(
+    const std::vector<Position>&, int, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_multi<FastNormal, float>(
+    const std::vector<Position>&, int, double);
+template std::vector<Greeks> calculate_all_greeks_partitioned_single<PreciseNormal, double>(
+    const std::vector<Position>&, const TypePartition&, double);
+template std::vector<Greeks> calculate_all_greeks_partitioned_single<FastNormal, double>(
+    const std::vector<Position>&, const TypePartition&, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_partitioned_single<PreciseNormal, float>(
+    const std::vector<Position>&, const TypePartition&, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_partitioned_single<FastNormal, float>(
+    const std::vector<Position>&, const TypePartition&, double);
+template std::vector<Greeks> calculate_all_greeks_partitioned_multi<PreciseNormal, double>(
+    const std::vector<Position>&, const TypePartition&, int, double);
+template std::vector<Greeks> calculate_all_greeks_partitioned_multi<FastNormal, double>(
+    const std::vector<Position>&, const TypePartition&, int, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_partitioned_multi<PreciseNormal, float>(
+    const std::vector<Position>&, const TypePartition&, int, double);
+template std::vector<GreeksT<float>> calculate_all_greeks_partitioned_multi<FastNormal, float>(
+    const std::vector<Position>&, const TypePartition&, int, double);
+
+template <typename T>
+double total_portfolio_delta(const std::vector<GreeksT<T>>& greeks,
                              const std::vector<Position>& positions) {
-    double total = 0.0;
+    NeumaierSum total;
     for (size_t i = 0; i < greeks.size(); ++i) {
-        total += greeks[i].delta * positions[i].quantity;
+        total.add(static_cast<double>(greeks[i].delta) * positions[i].quantity);
     }
-    return total;
+    return total.value();
 }
 
+template double total_portfolio_delta<double>(const std::vector<Greeks>&,
+                                              const std::vector<Position>&);
+template double total_portfolio_delta<float>(const std::vector<GreeksT<float>>&,
+                                             const std::vector<Position>&);
+
 }  // namespace trading
@@ -1,36 +1,195 @@
 #ifndef LIB_GREEKS_H_
 #define LIB_GREEKS_H_
 
+#include "lib/normal.h"
 #include "lib/position.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <thread>
 #include <vector>
 
 namespace trading {
 
-struct Greeks {
-    double price;
-    double delta;
-    double gamma;
-    double vega;
-    double theta;
+// Kernels templated on the scalar type store their results in that type;
+// double is the reference precision.
+template <typename T>
+struct GreeksT {
+    T price;
+    T delta;
+    T gamma;
+    T vega;
+    T theta;
 };
 
+using Greeks = GreeksT<double>;
+
 double normal_cdf(double x);
 double normal_pdf(double x);
 
+// The pricing kernels take a normal-distribution policy (lib/normal.h);
+// instantiated for PreciseNormal and FastNormal.
+template <typename NormalPolicy = PreciseNormal>
 double black_scholes_price(double spot, double strike, double vol,
                            double rate, double time, bool is_call);
 
-Greeks calculate_greeks(const Position& pos, double bump_size = 0.01);
+// Call/put resolved at compile time; black_scholes_price dispatches here.
+// T is the compute precision of every intermediate.
+template <bool IsCall, typename NormalPolicy = PreciseNormal, typename T = double>
+inline T black_scholes_price_typed(T spot, T strike, T vol, T rate, T time) {
+    if (time <= T(0) || vol <= T(0)) {
+        if constexpr (IsCall) {
+            return std::max(spot - strike, T(0));
+        } else {
+            return std::max(strike - spot, T(0));
+        }
+    }
+
+    T d1 = (std::log(spot / strike) + (rate + T(0.5) * vol * vol) * time) /
+           (vol * std::sqrt(time));
+    T d2 = d1 - vol * std::sqrt(time);
+
+    if constexpr (IsCall) {
+        return spot * NormalPolicy::cdf(d1) -
+               strike * std::exp(-rate * time) * NormalPolicy::cdf(d2);
+    } else {
+        return strike * std::exp(-rate * time) * NormalPolicy::cdf(-d2) -
+               spot * NormalPolicy::cdf(-d1);
+    }
+}
+
+// Greeks for a position known to be of type `Type` (European exercise for
+// options). No runtime branch on the type; calculate_greeks dispatches here.
+// With T = float the position's fields are rounded to float first.
+template <PositionType Type, typename NormalPolicy = PreciseNormal, typename T = double>
+inline GreeksT<T> calculate_greeks_typed(const Position& pos, double bump_size = 0.01) {
+    if constexpr (Type == PositionType::STOCK) {
+        (void)bump_size;
+        return {static_cast<T>(pos.price), T(1), T(0), T(0), T(0)};
+    } else {
+        constexpr bool kIsCall = (Type == PositionType::OPTION_CALL);
+        T spot = static_cast<T>(pos.price);
+        T strike = static_cast<T>(pos.strike);
+        T vol = static_cast<T>(pos.volatility);
+        T rate = static_cast<T>(pos.risk_free_rate);
+        T time = static_cast<T>(pos.time_to_expiry);
+        T bump = static_cast<T>(bump_size);
+
+        GreeksT<T> result;
+        result.price = black_scholes_price_typed<kIsCall, NormalPolicy>(
+            spot, strike, vol, rate, time);
+
+        T spot_up = spot * (T(1) + bump);
+        T spot_down = spot * (T(1) - bump);
+        T price_up = black_scholes_price_typed<kIsCall, NormalPolicy>(
+            spot_up, strike, vol, rate, time);
+        T price_down = black_scholes_price_typed<kIsCall, NormalPolicy>(
+            spot_down, strike, vol, rate, time);
 
-std::vector<Greeks> calculate_all_greeks_single(
+        result.delta = (price_up - price_down) / (spot_up - spot_down);
+        result.gamma = (price_up - T(2) * result.price + price_down) /
+                       ((spot * bump) * (spot * bump));
+
+        T price_vol_up = black_scholes_price_typed<kIsCall, NormalPolicy>(
+            spot, strike, vol + bump, rate, time);
+        result.vega = (price_vol_up - result.price) / bump;
+
+        T time_down = std::max(time - T(1.0/365.0), T(0.001));
+        T price_time_down = black_scholes_price_typed<kIsCall, NormalPolicy>(
+            spot, strike, vol, rate, time_down);
+        result.theta = (price_time_down - result.price) * T(365);
+
+        return result;
+    }
+}
+
+// T is the compute and result precision, with the same treatment of
+// American options as the partitioned kernels below. Instantiated for
+// float and double.
+template <typename NormalPolicy = PreciseNormal, typename T = double>
+GreeksT<T> calculate_greeks(const Position& pos, double bump_size = 0.01);
+
+template <typename NormalPolicy = PreciseNormal, typename T = double>
+std::vector<GreeksT<T>> calculate_all_greeks_single(
     const std::vector<Position>& positions, double bump_size = 0.01);
 
-std::vector<Greeks> calculate_all_greeks_multi(
+// Same, into out[0, positions.size()).
+template <typename NormalPolicy = PreciseNormal, typename T = double>
+void calculate_all_greeks_single(
+    const std::vector<Position>& positions, GreeksT<T>* out, double bump_size = 0.01);
+
+template <typename NormalPolicy = PreciseNormal, typename T = double>
+std::vector<GreeksT<T>> calculate_all_greeks_multi(
     const std::vector<Position>& positions, int num_threads,
     double bump_size = 0.01);
 
-double total_portfolio_delta(const std::vector<Greeks>& greeks,
+// The multi-threaded overload writing into a caller buffer lives in
+// lib/risk_workspace.h, on a persistent worker pool.
+
+// Position indices grouped once by kernel: European calls, European puts,
+// stocks, then American options (lattice). Each group keeps book order.
+struct TypePartition {
+    std::vector<uint32_t> order;
+    size_t calls_end = 0;   // order[0, calls_end)
+    size_t puts_end = 0;    // order[calls_end, puts_end)
+    size_t stocks_end = 0;  // order[puts_end, stocks_end); American after
+};
+
+TypePartition partition_by_type(const std::vector<Position>& positions);
+
+// Same results as calculate_all_greeks_*, in book order, but each type
+// group runs its own specialized loop so the type branch disappears from
+// the inner loop. Reuse the partition for as long as the book's types do
+// not change.
+//
+// T = float runs the European kernels in single precision (half the
+// result memory, twice the SIMD lanes); American options are still priced
+// on the double lattice and rounded. Instantiated for float and double.
+template <typename NormalPolicy = PreciseNormal, typename T = double>
+std::vector<GreeksT<T>> calculate_all_greeks_partitioned_single(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    double bump_size = 0.01);
+
+template <typename NormalPolicy = PreciseNormal, typename T = double>
+std::vector<GreeksT<T>> calculate_all_greeks_partitioned_multi(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    int num_threads, double bump_size = 0.01);
+
+// Prices positions in contiguous per-thread chunks and passes each result
+// to visit(chunk, index, greeks) on the worker thread instead of storing
+// it, so callers can reduce in the same traversal. `chunk` is in
+// [0, num_threads) and no two threads share one. The greeks are GreeksT<T>.
+template <typename NormalPolicy = PreciseNormal, typename T = double, typename Visitor>
+void for_each_greeks_multi(const std::vector<Position>& positions,
+                           int num_threads, Visitor&& visit,
+                           double bump_size = 0.01) {
+    auto worker = [&](int chunk, size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            visit(chunk, i, calculate_greeks<NormalPolicy, T>(positions[i], bump_size));
+        }
+    };
+
+    std::vector<std::thread> threads;
+    size_t chunk_size = (positions.size() + num_threads - 1) / num_threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        size_t start = t * chunk_size;
+        size_t end = std::min(start + chunk_size, positions.size());
+        if (start < end) {
+            threads.emplace_back(worker, t, start, end);
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+// Accumulates in double whatever the Greeks' precision. Instantiated for
+// float and double.
+template <typename T>
+double total_portfolio_delta(const std::vector<GreeksT<T>>& greeks,
                              const std::vector<Position>& positions);
 
 }  // namespace trading
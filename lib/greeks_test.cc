@@ -72,5 +72,84 @@ TEST(GreeksTest, MultiThreadedConsistency) {
     }
 }
 
+TEST(GreeksTest, PartitionedKernelsMatchRuntimeDispatch) {
+    auto positions = generate_random_positions(3000, 77);
+    for (size_t i = 0; i < positions.size(); i += 97) {
+        if (positions[i].type != PositionType::STOCK) {
+            positions[i].exercise = ExerciseStyle::AMERICAN;
+        }
+    }
+
+    TypePartition partition = partition_by_type(positions);
+    ASSERT_EQ(partition.order.size(), positions.size());
+    for (size_t k = 0; k < partition.calls_end; ++k) {
+        EXPECT_EQ(positions[partition.order[k]].type, PositionType::OPTION_CALL);
+    }
+    for (size_t k = partition.puts_end; k < partition.stocks_end; ++k) {
+        EXPECT_EQ(positions[partition.order[k]].type, PositionType::STOCK);
+    }
+    for (size_t k = partition.stocks_end; k < partition.order.size(); ++k) {
+        EXPECT_EQ(positions[partition.order[k]].exercise, ExerciseStyle::AMERICAN);
+    }
+
+    auto expected = calculate_all_greeks_single(positions);
+    for (const auto& actual : {calculate_all_greeks_partitioned_single(positions, partition),
+                               calculate_all_greeks_partitioned_multi(positions, partition, 3)}) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(actual[i].price, expected[i].price);
+            EXPECT_EQ(actual[i].delta, expected[i].delta);
+            EXPECT_EQ(actual[i].theta, expected[i].theta);
+        }
+    }
+
+    EXPECT_NEAR((black_scholes_price_typed<false>(100.0, 105.0, 0.2, 0.05, 0.5)),
+                black_scholes_price(100.0, 105.0, 0.2, 0.05, 0.5, false), 1e-12);
+}
+
+TEST(GreeksTest, FloatKernelsTrackDouble) {
+    auto positions = generate_random_positions(3000, 5);
+    TypePartition partition = partition_by_type(positions);
+    auto reference = calculate_all_greeks_partitioned_single<FastNormal>(positions, partition);
+    auto reduced = calculate_all_greeks_partitioned_multi<FastNormal, float>(
+        positions, partition, 3);
+    ASSERT_EQ(reduced.size(), reference.size());
+
+    // Bounds scale with the spot: the finite differences lose float digits
+    // to cancellation, gamma (a second difference over a 1% bump) most of
+    // all, to around 1% of its value.
+    for (size_t i = 0; i < reference.size(); ++i) {
+        double spot = positions[i].price;
+        EXPECT_NEAR(reduced[i].price, reference[i].price, spot * 1e-6);
+        EXPECT_NEAR(reduced[i].delta, reference[i].delta, 1e-4);
+        EXPECT_NEAR(reduced[i].gamma, reference[i].gamma, 2e-2 / spot);
+        EXPECT_NEAR(reduced[i].vega, reference[i].vega, spot * 2e-4);
+        EXPECT_NEAR(reduced[i].theta, reference[i].theta, spot * 1e-3);
+    }
+
+    double delta = total_portfolio_delta(reference, positions);
+    EXPECT_NEAR(total_portfolio_delta(reduced, positions), delta,
+                1e-4 * positions.size() * 1000.0);
+}
+
+TEST(GreeksTest, FloatBatchEntryPointsMatchPartitionedKernels) {
+    auto positions = generate_random_positions(1000, 9);
+    auto partitioned = calculate_all_greeks_partitioned_single<FastNormal, float>(
+        positions, partition_by_type(positions));
+    auto single = calculate_all_greeks_single<FastNormal, float>(positions);
+    auto multi = calculate_all_greeks_multi<FastNormal, float>(positions, 3);
+    ASSERT_EQ(single.size(), partitioned.size());
+    ASSERT_EQ(multi.size(), partitioned.size());
+
+    // Same per-position kernels, only the traversal differs.
+    for (size_t i = 0; i < partitioned.size(); ++i) {
+        EXPECT_EQ(single[i].price, partitioned[i].price);
+        EXPECT_EQ(single[i].gamma, partitioned[i].gamma);
+        EXPECT_EQ(multi[i].delta, partitioned[i].delta);
+        EXPECT_EQ(multi[i].vega, partitioned[i].vega);
+        EXPECT_EQ(multi[i].theta, partitioned[i].theta);
+    }
+}
+
 }  // namespace
 }  // namespace trading
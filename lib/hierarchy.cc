@@ -0,0 +1,287 @@
+#include "lib/hierarchy.h"
+
+#include <algorithm>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <thread>
+
+namespace trading {
+
+uint32_t PositionHierarchy::add_desk(const std::string& name) {
+    desk_names_.push_back(name);
+    desk_books_.emplace_back();
+    return static_cast<uint32_t>(desk_names_.size() - 1);
+}
+
+uint32_t PositionHierarchy::add_book(const std::string& name, uint32_t desk_id) {
+    if (desk_id >= desk_names_.size()) {
+        throw std::invalid_argument("unknown desk id");
+    }
+    uint32_t id = static_cast<uint32_t>(book_names_.size());
+    book_names_.push_back(name);
+    book_desk_.push_back(desk_id);
+    book_accounts_.emplace_back();
+    desk_books_[desk_id].push_back(id);
+    return id;
+}
+
+uint32_t PositionHierarchy::add_account(const std::string& name, uint32_t book_id) {
+    if (book_id >= book_names_.size()) {
+        throw std::invalid_argument("unknown book id");
+    }
+    uint32_t id = static_cast<uint32_t>(account_names_.size());
+    account_names_.push_back(name);
+    account_book_.push_back(book_id);
+    book_accounts_[book_id].push_back(id);
+    return id;
+}
+
+PositionHierarchy make_synthetic_hierarchy(size_t num_desks, size_t books_per_desk,
+                                           size_t accounts_per_book) {
+    PositionHierarchy hierarchy;
+    for (size_t d = 0; d < num_desks; ++d) {
+        uint32_t desk = hierarchy.add_desk("DESK" + std::to_string(d));
+        for (size_t b = 0; b < books_per_desk; ++b) {
+            uint32_t book = hierarchy.add_book(
+                "BOOK" + std::to_string(hierarchy.num_books()), desk);
+            for (size_t a = 0; a < accounts_per_book; ++a) {
+                hierarchy.add_account(
+                    "ACCT" + std::to_string(hierarchy.num_accounts()), book);
+            }
+        }
+    }
+    return hierarchy;
+}
+
+void assign_random_accounts(std::vector<Position>* positions, size_t num_accounts,
+                            unsigned int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<uint32_t> account_dist(
+        0, static_cast<uint32_t>(num_accounts - 1));
+    for (auto& pos : *positions) {
+        pos.account_id = account_dist(rng);
+    }
+}
+
+namespace {
+
+uint64_t leaf_key(uint32_t account_id, uint32_t symbol_id) {
+    return (static_cast<uint64_t>(account_id) << 32) | symbol_id;
+}
+
+struct LeafDelta {
+    uint64_t key;
+    double quantity;
+    double notional;
+};
+
+// Positions [start, end) netted per (account, symbol), sorted by key.
+std::vector<AccountSymbolExposure> build_run(const std::vector<Position>& positions,
+                                             const std::vector<uint32_t>& symbol_ids,
+                                             size_t start, size_t end,
+                                             uint32_t* max_account) {
+    std::vector<LeafDelta> deltas;
+    deltas.reserve(end - start);
+    uint32_t max_id = 0;
+    for (size_t i = start; i < end; ++i) {
+        const auto& pos = positions[i];
+        max_id = std::max(max_id, pos.account_id);
+        deltas.push_back({leaf_key(pos.account_id, symbol_ids[i]), pos.quantity,
+                          pos.quantity * pos.price});
+    }
+    *max_account = max_id;
+
+    std::sort(deltas.begin(), deltas.end(),
+              [](const LeafDelta& a, const LeafDelta& b) { return a.key < b.key; });
+
+    std::vector<AccountSymbolExposure> run;
+    for (const auto& delta : deltas) {
+        if (run.empty() ||
+            leaf_key(run.back().account_id, run.back().symbol_id) != delta.key) {
+            run.push_back({static_cast<uint32_t>(delta.key >> 32),
+                           static_cast<uint32_t>(delta.key), 0.0, 0.0, 0});
+        }
+        run.back().quantity += delta.quantity;
+        run.back().notional += delta.notional;
+        run.back().position_count++;
+    }
+    return run;
+}
+
+// K-way merge of every run's slice for accounts [first, last). Fills the
+// account nodes and per-account leaf counts for that range only, so ranges
+// can be merged concurrently.
+std::vector<AccountSymbolExposure> merge_account_range(
+    const std::vector<std::vector<AccountSymbolExposure>>& runs,
+    uint32_t first, uint32_t last, HierarchyAggregation* result) {
+
+    auto by_key = [](const AccountSymbolExposure& e, uint64_t key) {
+        return leaf_key(e.account_id, e.symbol_id) < key;
+    };
+
+    struct Cursor {
+        const AccountSymbolExposure* next;
+        const AccountSymbolExposure* end;
+    };
+    std::vector<Cursor> cursors;
+    for (const auto& run : runs) {
+        auto lo = std::lower_bound(run.begin(), run.end(), leaf_key(first, 0), by_key);
+        auto hi = std::lower_bound(lo, run.end(), leaf_key(last, 0), by_key);
+        if (lo != hi) {
+            cursors.push_back({&*lo, &*lo + (hi - lo)});
+        }
+    }
+
+    using HeapEntry = std::pair<uint64_t, size_t>;  // (key, cursor)
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry>> heap;
+    for (size_t c = 0; c < cursors.size(); ++c) {
+        heap.push({leaf_key(cursors[c].next->account_id, cursors[c].next->symbol_id), c});
+    }
+
+    std::vector<AccountSymbolExposure> leaves;
+    while (!heap.empty()) {
+        auto [key, c] = heap.top();
+        heap.pop();
+        const AccountSymbolExposure& entry = *cursors[c].next++;
+        if (leaves.empty() ||
+            leaf_key(leaves.back().account_id, leaves.back().symbol_id) != key) {
+            leaves.push_back(entry);
+        } else {
+            leaves.back().quantity += entry.quantity;
+            leaves.back().notional += entry.notional;
+            leaves.back().position_count += entry.position_count;
+        }
+        if (cursors[c].next != cursors[c].end) {
+            heap.push({leaf_key(cursors[c].next->account_id, cursors[c].next->symbol_id),
+                       c});
+        }
+    }
+
+    for (const auto& leaf : leaves) {
+        ExposureNode& account = result->by_account[leaf.account_id];
+        account.notional += leaf.notional;
+        if (leaf.notional > 0) {
+            account.long_notional += leaf.notional;
+        } else {
+            account.short_notional -= leaf.notional;
+        }
+        account.position_count += leaf.position_count;
+        result->account_offsets[leaf.account_id + 1]++;
+    }
+    return leaves;
+}
+
+void add_node(ExposureNode& total, const ExposureNode& node) {
+    total.notional += node.notional;
+    total.long_notional += node.long_notional;
+    total.short_notional += node.short_notional;
+    total.position_count += node.position_count;
+}
+
+HierarchyAggregation aggregate_hierarchy(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids,
+    const PositionHierarchy& hierarchy,
+    int num_threads) {
+
+    size_t num_accounts = hierarchy.num_accounts();
+    std::vector<std::vector<AccountSymbolExposure>> runs(num_threads);
+    std::vector<uint32_t> max_accounts(num_threads, 0);
+    std::vector<std::thread> threads;
+
+    size_t chunk_size = (positions.size() + num_threads - 1) / num_threads;
+    auto build = [&](int t) {
+        size_t start = std::min(t * chunk_size, positions.size());
+        size_t end = std::min(start + chunk_size, positions.size());
+        runs[t] = build_run(positions, symbol_ids, start, end, &max_accounts[t]);
+    };
+
+    if (num_threads == 1) {
+        build(0);
+    } else {
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back(build, t);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        threads.clear();
+    }
+
+    if (!positions.empty() &&
+        *std::max_element(max_accounts.begin(), max_accounts.end()) >= num_accounts) {
+        throw std::invalid_argument("position account_id outside the hierarchy");
+    }
+
+    HierarchyAggregation result;
+    result.by_account.resize(num_accounts);
+    result.account_offsets.assign(num_accounts + 1, 0);
+
+    std::vector<std::vector<AccountSymbolExposure>> ranges(num_threads);
+    size_t accounts_per_range = (num_accounts + num_threads - 1) / num_threads;
+    auto merge = [&](int t) {
+        size_t first = std::min(t * accounts_per_range, num_accounts);
+        size_t last = std::min(first + accounts_per_range, num_accounts);
+        ranges[t] = merge_account_range(runs, static_cast<uint32_t>(first),
+                                        static_cast<uint32_t>(last), &result);
+    };
+
+    if (num_threads == 1) {
+        merge(0);
+    } else {
+        for (int t = 0; t < num_threads; ++t) {
+            threads.emplace_back(merge, t);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    size_t num_leaves = 0;
+    for (const auto& range : ranges) {
+        num_leaves += range.size();
+    }
+    result.by_account_symbol.reserve(num_leaves);
+    for (const auto& range : ranges) {
+        result.by_account_symbol.insert(result.by_account_symbol.end(),
+                                        range.begin(), range.end());
+    }
+    for (size_t a = 0; a < num_accounts; ++a) {
+        result.account_offsets[a + 1] += result.account_offsets[a];
+    }
+
+    result.by_book.resize(hierarchy.num_books());
+    result.by_desk.resize(hierarchy.num_desks());
+    for (size_t a = 0; a < num_accounts; ++a) {
+        add_node(result.by_book[hierarchy.book_of_account(static_cast<uint32_t>(a))],
+                 result.by_account[a]);
+    }
+    for (size_t b = 0; b < result.by_book.size(); ++b) {
+        add_node(result.by_desk[hierarchy.desk_of_book(static_cast<uint32_t>(b))],
+                 result.by_book[b]);
+    }
+    for (const auto& desk : result.by_desk) {
+        add_node(result.firm, desk);
+    }
+    return result;
+}
+
+}  // namespace
+
+HierarchyAggregation aggregate_hierarchy_single(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids,
+    const PositionHierarchy& hierarchy) {
+    return aggregate_hierarchy(positions, symbol_ids, hierarchy, 1);
+}
+
+HierarchyAggregation aggregate_hierarchy_multi(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids,
+    const PositionHierarchy& hierarchy,
+    int num_threads) {
+    return aggregate_hierarchy(positions, symbol_ids, hierarchy, num_threads);
+}
+
+}  // namespace trading
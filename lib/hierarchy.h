@@ -0,0 +1,114 @@
+#ifndef LIB_HIERARCHY_H_
+#define LIB_HIERARCHY_H_
+
+#include "lib/position.h"
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace trading {
+
+// Firm -> desk -> book -> account. Ids at each level are dense and assigned
+// in creation order; positions reference their account by
+// Position::account_id.
+class PositionHierarchy {
+public:
+    uint32_t add_desk(const std::string& name);
+    uint32_t add_book(const std::string& name, uint32_t desk_id);
+    uint32_t add_account(const std::string& name, uint32_t book_id);
+
+    size_t num_desks() const { return desk_names_.size(); }
+    size_t num_books() const { return book_names_.size(); }
+    size_t num_accounts() const { return account_names_.size(); }
+
+    const std::string& desk_name(uint32_t desk_id) const { return desk_names_[desk_id]; }
+    const std::string& book_name(uint32_t book_id) const { return book_names_[book_id]; }
+    const std::string& account_name(uint32_t account_id) const {
+        return account_names_[account_id];
+    }
+
+    uint32_t desk_of_book(uint32_t book_id) const { return book_desk_[book_id]; }
+    uint32_t book_of_account(uint32_t account_id) const { return account_book_[account_id]; }
+
+    const std::vector<uint32_t>& books_of_desk(uint32_t desk_id) const {
+        return desk_books_[desk_id];
+    }
+    const std::vector<uint32_t>& accounts_of_book(uint32_t book_id) const {
+        return book_accounts_[book_id];
+    }
+
+private:
+    std::vector<std::string> desk_names_;
+    std::vector<std::string> book_names_;
+    std::vector<std::string> account_names_;
+    std::vector<uint32_t> book_desk_;
+    std::vector<uint32_t> account_book_;
+    std::vector<std::vector<uint32_t>> desk_books_;
+    std::vector<std::vector<uint32_t>> book_accounts_;
+};
+
+// DESK<d>/BOOK<b>/ACCT<a> with a fixed fan-out at each level.
+PositionHierarchy make_synthetic_hierarchy(size_t num_desks, size_t books_per_desk,
+                                           size_t accounts_per_book);
+
+// Spreads positions uniformly over the hierarchy's accounts.
+void assign_random_accounts(std::vector<Position>* positions, size_t num_accounts,
+                            unsigned int seed = 42);
+
+// Above the symbol level, quantities in different symbols do not add, so
+// nodes carry notional only. Long/short are grossed up from the netted
+// account/symbol exposures below the node.
+struct ExposureNode {
+    double notional = 0.0;
+    double long_notional = 0.0;
+    double short_notional = 0.0;
+    int position_count = 0;
+};
+
+struct AccountSymbolExposure {
+    uint32_t account_id;
+    uint32_t symbol_id;
+    double quantity;
+    double notional;
+    int position_count;
+};
+
+// Every level of firm -> desk -> book -> account -> symbol. Desk, book and
+// account nodes are flat arrays indexed by hierarchy id; the symbol level
+// is sorted by (account, symbol) with CSR offsets per account.
+struct HierarchyAggregation {
+    ExposureNode firm;
+    std::vector<ExposureNode> by_desk;
+    std::vector<ExposureNode> by_book;
+    std::vector<ExposureNode> by_account;
+    std::vector<AccountSymbolExposure> by_account_symbol;
+    std::vector<uint32_t> account_offsets;  // num_accounts + 1
+
+    // Drill-down from an account to its symbols: [first, second) into
+    // by_account_symbol.
+    std::pair<size_t, size_t> symbols_of_account(uint32_t account_id) const {
+        return {account_offsets[account_id], account_offsets[account_id + 1]};
+    }
+};
+
+// One pass over the book: each chunk is reduced to a run sorted by
+// (account, symbol); the runs are k-way merged in parallel over disjoint
+// account ranges, filling the account level as they go, and books, desks
+// and the firm roll up from the accounts. Throws std::invalid_argument if
+// a position's account_id is outside the hierarchy.
+HierarchyAggregation aggregate_hierarchy_single(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids,
+    const PositionHierarchy& hierarchy);
+
+HierarchyAggregation aggregate_hierarchy_multi(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids,
+    const PositionHierarchy& hierarchy,
+    int num_threads);
+
+}  // namespace trading
+
+#endif  // LIB_HIERARCHY_H_
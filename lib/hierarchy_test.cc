@@ -0,0 +1,91 @@
+#include "lib/hierarchy.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+
+namespace trading {
+namespace {
+
+TEST(PositionHierarchyTest, BuildsParentAndChildLinks) {
+    PositionHierarchy hierarchy = make_synthetic_hierarchy(2, 3, 4);
+    EXPECT_EQ(hierarchy.num_desks(), 2u);
+    EXPECT_EQ(hierarchy.num_books(), 6u);
+    EXPECT_EQ(hierarchy.num_accounts(), 24u);
+    EXPECT_EQ(hierarchy.book_of_account(13), 3u);
+    EXPECT_EQ(hierarchy.desk_of_book(3), 1u);
+    EXPECT_EQ(hierarchy.accounts_of_book(3).size(), 4u);
+    EXPECT_EQ(hierarchy.books_of_desk(1).front(), 3u);
+    EXPECT_EQ(hierarchy.account_name(13), "ACCT13");
+    EXPECT_THROW(hierarchy.add_book("X", 5), std::invalid_argument);
+}
+
+TEST(HierarchyAggregationTest, MatchesBruteForceAtEveryLevel) {
+    auto positions = generate_random_positions(20000, 17, 200);
+    PositionHierarchy hierarchy = make_synthetic_hierarchy(3, 4, 5);
+    assign_random_accounts(&positions, hierarchy.num_accounts(), 5);
+    SymbolTable symbols;
+    auto ids = intern_symbols(positions, &symbols);
+
+    std::map<std::pair<uint32_t, uint32_t>, AccountSymbolExposure> leaves;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        auto& leaf = leaves[{positions[i].account_id, ids[i]}];
+        leaf.quantity += positions[i].quantity;
+        leaf.notional += positions[i].quantity * positions[i].price;
+        leaf.position_count++;
+    }
+    std::vector<ExposureNode> desks(hierarchy.num_desks());
+    for (const auto& [key, leaf] : leaves) {
+        uint32_t desk = hierarchy.desk_of_book(hierarchy.book_of_account(key.first));
+        desks[desk].notional += leaf.notional;
+        (leaf.notional > 0 ? desks[desk].long_notional : desks[desk].short_notional) +=
+            std::abs(leaf.notional);
+        desks[desk].position_count += leaf.position_count;
+    }
+
+    for (int threads : {1, 4, 7}) {
+        auto result = threads == 1
+            ? aggregate_hierarchy_single(positions, ids, hierarchy)
+            : aggregate_hierarchy_multi(positions, ids, hierarchy, threads);
+
+        ASSERT_EQ(result.by_account_symbol.size(), leaves.size());
+        size_t k = 0;
+        for (const auto& [key, leaf] : leaves) {
+            const auto& actual = result.by_account_symbol[k++];
+            EXPECT_EQ(actual.account_id, key.first);
+            EXPECT_EQ(actual.symbol_id, key.second);
+            EXPECT_EQ(actual.position_count, leaf.position_count);
+            EXPECT_NEAR(actual.notional, leaf.notional, 1e-6);
+        }
+
+        for (uint32_t d = 0; d < hierarchy.num_desks(); ++d) {
+            EXPECT_EQ(result.by_desk[d].position_count, desks[d].position_count);
+            EXPECT_NEAR(result.by_desk[d].long_notional, desks[d].long_notional, 1e-3);
+            EXPECT_NEAR(result.by_desk[d].short_notional, desks[d].short_notional, 1e-3);
+        }
+        EXPECT_EQ(result.firm.position_count, static_cast<int>(positions.size()));
+
+        // Drill down from an account to its symbols.
+        uint32_t account = hierarchy.accounts_of_book(5).back();
+        auto [first, last] = result.symbols_of_account(account);
+        int count = 0;
+        for (size_t j = first; j < last; ++j) {
+            EXPECT_EQ(result.by_account_symbol[j].account_id, account);
+            count += result.by_account_symbol[j].position_count;
+        }
+        EXPECT_EQ(count, result.by_account[account].position_count);
+    }
+}
+
+TEST(HierarchyAggregationTest, RejectsUnknownAccount) {
+    auto positions = generate_random_positions(10, 1);
+    positions[3].account_id = 9;
+    PositionHierarchy hierarchy = make_synthetic_hierarchy(1, 1, 2);
+    SymbolTable symbols;
+    auto ids = intern_symbols(positions, &symbols);
+    EXPECT_THROW(aggregate_hierarchy_multi(positions, ids, hierarchy, 2),
+                 std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,406 @@
+#include "lib/implied_vol.h"
+
+#include "lib/greeks.h"
+#include "lib/normal.h"
+
+#ifndef _USE_MATH_DEFINES
+#define _USE_MATH_DEFINES
+#endif
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+namespace trading {
+
+namespace {
+
+constexpr int kLanes = 8;
+constexpr int kMaxNewtonIterations = 12;
+constexpr double kMinVol = 1e-6;
+constexpr double kMaxVol = 10.0;
+
+struct SolveInput {
+    double price;
+    double spot;
+    double strike;
+    double rate;
+    double time;
+    bool is_call;
+};
+
+// Corrado-Miller closed-form estimate, applied to the equivalent call price.
+// Falls back to Brenner-Subrahmanyam when the square root goes negative.
+double initial_guess(const SolveInput& in, double discounted_strike) {
+    double call = in.is_call ? in.price
+                             : in.price + in.spot - discounted_strike;
+    double gap = in.spot - discounted_strike;
+    double a = call - 0.5 * gap;
+    double discriminant = a * a - gap * gap / M_PI;
+    double vol = std::sqrt(2.0 * M_PI) / (in.spot + discounted_strike) *
+                 (a + std::sqrt(std::max(discriminant, 0.0))) /
+                 std::sqrt(in.time);
+
+    if (!(vol > kMinVol)) {
+        vol = std::sqrt(2.0 * M_PI / in.time) * call / in.spot;
+    }
+    return std::min(std::max(vol, 0.01), kMaxVol);
+}
+
+// Brent's method on [lo, hi], which must bracket the root.
+double brent_solve(const SolveInput& in, double lo, double hi, double tolerance,
+                   int max_iterations, int& iterations, bool& converged) {
+    auto f = [&](double vol) {
+        return black_scholes_price(in.spot, in.strike, vol, in.rate, in.time,
+                                   in.is_call) - in.price;
+    };
+
+    double a = lo, b = hi, c = hi;
+    double fa = f(a), fb = f(b), fc = fb;
+    double d = b - a, e = d;
+    converged = false;
+
+    if ((fa > 0.0 && fb > 0.0) || (fa < 0.0 && fb < 0.0)) {
+        // A bracket narrower than the tolerance can lose its sign change to
+        // rounding; anything wider means the price is unreachable.
+        if (hi - lo <= tolerance) {
+            converged = true;
+            return 0.5 * (lo + hi);
+        }
+        return std::numeric_limits<double>::quiet_NaN();
+    }
+
+    for (int iter = 0; iter < max_iterations; ++iter) {
+        ++iterations;
+        if ((fb > 0.0 && fc > 0.0) || (fb < 0.0 && fc < 0.0)) {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (std::abs(fc) < std::abs(fb)) {
+            a = b; b = c; c = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+
+        double tol1 = 2.0 * std::numeric_limits<double>::epsilon() * std::abs(b) +
+                      0.5 * tolerance;
+        double xm = 0.5 * (c - b);
+        if (std::abs(xm) <= tol1 || fb == 0.0) {
+            converged = true;
+            return b;
+        }
+
+        if (std::abs(e) >= tol1 && std::abs(fa) > std::abs(fb)) {
+            double s = fb / fa;
+            double p, q;
+            if (a == c) {
+                p = 2.0 * xm * s;
+                q = 1.0 - s;
+            } else {
+                double qa = fa / fc;
+                double r = fb / fc;
+                p = s * (2.0 * xm * qa * (qa - r) - (b - a) * (r - 1.0));
+                q = (qa - 1.0) * (r - 1.0) * (s - 1.0);
+            }
+            if (p > 0.0) q = -q;
+            p = std::abs(p);
+            double min1 = 3.0 * xm * q - std::abs(tol1 * q);
+            double min2 = std::abs(e * q);
+            if (2.0 * p < std::min(min1, min2)) {
+                e = d;
+                d = p / q;
+            } else {
+                d = xm;
+                e = d;
+            }
+        } else {
+            d = xm;
+            e = d;
+        }
+
+        a = b;
+        fa = fb;
+        b += std::abs(d) > tol1 ? d : std::copysign(tol1, xm);
+        fb = f(b);
+    }
+
+    return b;
+}
+
+// Lane state for the FastNormal Newton stage, one slot per option in the
+// block. Empty and rejected lanes hold benign values so every lane can be
+// computed unconditionally.
+struct FastLanes {
+    double spot[kLanes];
+    double discounted_strike[kLanes];
+    double sign[kLanes];    // +1 for calls, -1 for puts
+    double target[kLanes];
+    double drift[kLanes];   // log(S/K) + r*t
+    double sqrt_t[kLanes];
+    double vol[kLanes];
+    double live[kLanes];    // 1.0 while the lane still iterates, else 0.0
+    double iterations[kLanes];
+};
+
+// Newton on the FastNormal price over all lanes at once. The lane loop has
+// a fixed trip count, no branches and no libm calls, so it compiles to SIMD;
+// converged lanes are masked out rather than skipped. It only has to land
+// within FastNormal's accuracy (about 1e-7 in price) of the root; the
+// precise stage takes it from there.
+void fast_newton(FastLanes& lanes) {
+    constexpr double kFastTolerance = 1e-7;
+    constexpr int kFastIterations = 8;
+    for (int iter = 0; iter < kFastIterations; ++iter) {
+        double any_live = 0.0;
+        for (int l = 0; l < kLanes; ++l) {
+            double vol_sqrt_t = lanes.vol[l] * lanes.sqrt_t[l];
+            double d1 = lanes.drift[l] / vol_sqrt_t + 0.5 * vol_sqrt_t;
+            double d2 = d1 - vol_sqrt_t;
+            double w = lanes.sign[l];
+            double price = w * (lanes.spot[l] * FastNormal::cdf(w * d1) -
+                                lanes.discounted_strike[l] * FastNormal::cdf(w * d2));
+            double vega = lanes.spot[l] * FastNormal::pdf(d1) * lanes.sqrt_t[l];
+
+            double step = (price - lanes.target[l]) / std::max(vega, 1e-300);
+            double next = std::min(std::max(lanes.vol[l] - step, kMinVol), kMaxVol);
+            bool moving = lanes.live[l] != 0.0 && std::abs(step) > kFastTolerance &&
+                          vega > 1e-12 && next == next;
+            lanes.iterations[l] += lanes.live[l];
+            lanes.vol[l] = moving ? next : lanes.vol[l];
+            lanes.live[l] = moving ? 1.0 : 0.0;
+            any_live += lanes.live[l];
+        }
+        if (any_live == 0.0) break;
+    }
+}
+
+// Solves up to kLanes options. A FastNormal Newton stage runs over all
+// lanes in SIMD (fast_newton); each lane then finishes on its own with
+// Newton on the precise Black-Scholes price, which needs libm's erfc and
+// so stays scalar. Lanes whose precise step leaves the bracket or whose
+// vega vanishes finish with Brent on the bracket Newton has narrowed.
+void solve_block(const SolveInput* in, int count, double tolerance,
+                 ImpliedVolSolve* out) {
+    FastLanes lanes;
+    double lo[kLanes], hi[kLanes];
+    bool active[kLanes], needs_brent[kLanes];
+
+    for (int l = 0; l < kLanes; ++l) {
+        lanes.spot[l] = 1.0;
+        lanes.discounted_strike[l] = 1.0;
+        lanes.sign[l] = 1.0;
+        lanes.target[l] = 0.1;
+        lanes.drift[l] = 0.0;
+        lanes.sqrt_t[l] = 1.0;
+        lanes.vol[l] = 0.2;
+        lanes.live[l] = 0.0;
+        lanes.iterations[l] = 0.0;
+        active[l] = false;
+        needs_brent[l] = false;
+    }
+
+    for (int l = 0; l < count; ++l) {
+        const SolveInput& q = in[l];
+        out[l] = {std::numeric_limits<double>::quiet_NaN(), 0, false};
+
+        if (q.time <= 0.0 || q.spot <= 0.0 || q.strike <= 0.0) continue;
+
+        double discounted_strike = q.strike * std::exp(-q.rate * q.time);
+        double lower = q.is_call ? std::max(q.spot - discounted_strike, 0.0)
+                                 : std::max(discounted_strike - q.spot, 0.0);
+        double upper = q.is_call ? q.spot : discounted_strike;
+        if (!(q.price > lower && q.price < upper)) continue;
+
+        lanes.spot[l] = q.spot;
+        lanes.discounted_strike[l] = discounted_strike;
+        lanes.sign[l] = q.is_call ? 1.0 : -1.0;
+        lanes.target[l] = q.price;
+        lanes.drift[l] = std::log(q.spot / q.strike) + q.rate * q.time;
+        lanes.sqrt_t[l] = std::sqrt(q.time);
+        lanes.vol[l] = initial_guess(q, discounted_strike);
+        lanes.live[l] = 1.0;
+        lo[l] = kMinVol;
+        hi[l] = kMaxVol;
+        active[l] = true;
+    }
+
+    fast_newton(lanes);
+
+    for (int l = 0; l < count; ++l) {
+        out[l].iterations = static_cast<int>(lanes.iterations[l]);
+    }
+
+    for (int iter = 0; iter < kMaxNewtonIterations; ++iter) {
+        bool any_active = false;
+        for (int l = 0; l < count; ++l) {
+            if (!active[l]) continue;
+
+            double vol = lanes.vol[l];
+            double vol_sqrt_t = vol * lanes.sqrt_t[l];
+            double d1 = lanes.drift[l] / vol_sqrt_t + 0.5 * vol_sqrt_t;
+            double d2 = d1 - vol_sqrt_t;
+            double w = lanes.sign[l];
+            double price = w * (lanes.spot[l] * normal_cdf(w * d1) -
+                                lanes.discounted_strike[l] * normal_cdf(w * d2));
+            double vega = lanes.spot[l] * normal_pdf(d1) * lanes.sqrt_t[l];
+
+            double diff = price - lanes.target[l];
+            if (diff > 0.0) {
+                hi[l] = vol;
+            } else {
+                lo[l] = vol;
+            }
+
+            double step = diff / vega;
+            double next = vol - step;
+            out[l].iterations++;
+
+            // Newton's error after this step is about |vomma / (2 vega)| *
+            // step^2, and vomma / vega = d1 * d2 / vol, so a lane arriving
+            // from the fast stage usually stops after one precise step.
+            double next_error = 0.5 * std::abs(d1 * d2 / vol) * step * step;
+            if (std::abs(step) <= tolerance ||
+                (std::abs(step) <= 1e-3 && next_error <= 0.5 * tolerance)) {
+                active[l] = false;
+                out[l].volatility = std::min(std::max(next, lo[l]), hi[l]);
+                out[l].converged = true;
+            } else if (!(vega > 1e-12) || !(next > lo[l] && next < hi[l])) {
+                active[l] = false;
+                needs_brent[l] = true;
+            } else {
+                lanes.vol[l] = next;
+                any_active = true;
+            }
+        }
+        if (!any_active) break;
+    }
+
+    for (int l = 0; l < count; ++l) {
+        if (!active[l] && !needs_brent[l]) continue;
+        out[l].volatility = brent_solve(
+            in[l], lo[l], hi[l], tolerance,
+            kImpliedVolMaxIterations - out[l].iterations,
+            out[l].iterations, out[l].converged);
+    }
+}
+
+void solve_range(const std::vector<Position>& positions,
+                 const std::vector<double>& market_prices,
+                 size_t start, size_t end, double tolerance,
+                 ImpliedVolBatchResult& result,
+                 std::vector<size_t>& histogram,
+                 size_t& num_solved, size_t& num_failed) {
+    SolveInput block[kLanes];
+    size_t block_index[kLanes];
+    ImpliedVolSolve solved[kLanes];
+    int count = 0;
+
+    auto flush = [&]() {
+        solve_block(block, count, tolerance, solved);
+        for (int l = 0; l < count; ++l) {
+            size_t i = block_index[l];
+            result.volatilities[i] = solved[l].volatility;
+            result.iterations[i] = solved[l].iterations;
+            if (solved[l].converged) {
+                histogram[std::min(solved[l].iterations,
+                                   kImpliedVolMaxIterations)]++;
+                num_solved++;
+            } else {
+                num_failed++;
+            }
+        }
+        count = 0;
+    };
+
+    for (size_t i = start; i < end; ++i) {
+        const auto& pos = positions[i];
+        if (pos.type == PositionType::STOCK) continue;
+
+        block[count] = {market_prices[i], pos.price, pos.strike,
+                        pos.risk_free_rate, pos.time_to_expiry,
+                        pos.type == PositionType::OPTION_CALL};
+        block_index[count] = i;
+        if (++count == kLanes) flush();
+    }
+    if (count > 0) flush();
+}
+
+ImpliedVolBatchResult make_result(size_t count) {
+    ImpliedVolBatchResult result;
+    result.volatilities.assign(count, std::numeric_limits<double>::quiet_NaN());
+    result.iterations.assign(count, 0);
+    result.iteration_histogram.assign(kImpliedVolMaxIterations + 1, 0);
+    result.num_solved = 0;
+    result.num_failed = 0;
+    return result;
+}
+
+}  // namespace
+
+ImpliedVolSolve implied_volatility(double price, double spot, double strike,
+                                   double rate, double time, bool is_call,
+                                   double tolerance) {
+    SolveInput in{price, spot, strike, rate, time, is_call};
+    ImpliedVolSolve out;
+    solve_block(&in, 1, tolerance, &out);
+    return out;
+}
+
+ImpliedVolBatchResult solve_implied_vols_single(
+    const std::vector<Position>& positions,
+    const std::vector<double>& market_prices,
+    double tolerance) {
+    ImpliedVolBatchResult result = make_result(positions.size());
+    solve_range(positions, market_prices, 0, positions.size(), tolerance,
+                result, result.iteration_histogram,
+                result.num_solved, result.num_failed);
+    return result;
+}
+
+ImpliedVolBatchResult solve_implied_vols_multi(
+    const std::vector<Position>& positions,
+    const std::vector<double>& market_prices,
+    int num_threads,
+    double tolerance) {
+    ImpliedVolBatchResult result = make_result(positions.size());
+
+    std::vector<std::vector<size_t>> histograms(
+        num_threads, std::vector<size_t>(kImpliedVolMaxIterations + 1, 0));
+    std::vector<size_t> solved(num_threads, 0);
+    std::vector<size_t> failed(num_threads, 0);
+
+    std::vector<std::thread> threads;
+    size_t chunk_size = (positions.size() + num_threads - 1) / num_threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        size_t start = t * chunk_size;
+        size_t end = std::min(start + chunk_size, positions.size());
+        if (start < end) {
+            threads.emplace_back([&, t, start, end]() {
+                solve_range(positions, market_prices, start, end, tolerance,
+                            result, histograms[t], solved[t], failed[t]);
+            });
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (int t = 0; t < num_threads; ++t) {
+        for (size_t k = 0; k < histograms[t].size(); ++k) {
+            result.iteration_histogram[k] += histograms[t][k];
+        }
+        result.num_solved += solved[t];
+        result.num_failed += failed[t];
+    }
+
+    return result;
+}
+
+}  // namespace trading
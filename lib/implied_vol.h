@@ -0,0 +1,44 @@
+#ifndef LIB_IMPLIED_VOL_H_
+#define LIB_IMPLIED_VOL_H_
+
+#include "lib/position.h"
+
+#include <vector>
+
+namespace trading {
+
+constexpr int kImpliedVolMaxIterations = 64;
+
+struct ImpliedVolSolve {
+    double volatility;  // NaN when the price violates no-arbitrage bounds
+    int iterations;     // Fast and precise Newton plus Brent iterations
+    bool converged;
+};
+
+struct ImpliedVolBatchResult {
+    std::vector<double> volatilities;  // NaN for stocks and failed solves
+    std::vector<int> iterations;
+    // iteration_histogram[k] = options solved in exactly k iterations
+    std::vector<size_t> iteration_histogram;
+    size_t num_solved;
+    size_t num_failed;
+};
+
+ImpliedVolSolve implied_volatility(double price, double spot, double strike,
+                                   double rate, double time, bool is_call,
+                                   double tolerance = 1e-8);
+
+ImpliedVolBatchResult solve_implied_vols_single(
+    const std::vector<Position>& positions,
+    const std::vector<double>& market_prices,
+    double tolerance = 1e-8);
+
+ImpliedVolBatchResult solve_implied_vols_multi(
+    const std::vector<Position>& positions,
+    const std::vector<double>& market_prices,
+    int num_threads,
+    double tolerance = 1e-8);
+
+}  // namespace trading
+
+#endif  // LIB_IMPLIED_VOL_H_
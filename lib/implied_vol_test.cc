@@ -0,0 +1,85 @@
+#include "lib/implied_vol.h"
+
+#include "lib/greeks.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+TEST(ImpliedVolTest, RoundTripAtTheMoney) {
+    double price = black_scholes_price(100.0, 100.0, 0.2, 0.05, 1.0, true);
+    auto solve = implied_volatility(price, 100.0, 100.0, 0.05, 1.0, true);
+
+    EXPECT_TRUE(solve.converged);
+    EXPECT_NEAR(solve.volatility, 0.2, 1e-8);
+    EXPECT_LE(solve.iterations, 6);
+}
+
+TEST(ImpliedVolTest, RoundTripDeepOutOfTheMoney) {
+    double price = black_scholes_price(100.0, 60.0, 0.15, 0.05, 0.1, false);
+    auto solve = implied_volatility(price, 100.0, 60.0, 0.05, 0.1, false);
+
+    EXPECT_TRUE(solve.converged);
+    EXPECT_NEAR(solve.volatility, 0.15, 1e-6);
+}
+
+TEST(ImpliedVolTest, RejectsPriceBelowIntrinsic) {
+    auto solve = implied_volatility(1.0, 120.0, 100.0, 0.05, 1.0, true);
+
+    EXPECT_FALSE(solve.converged);
+    EXPECT_TRUE(std::isnan(solve.volatility));
+}
+
+TEST(ImpliedVolTest, BatchRoundTrip) {
+    auto positions = generate_random_positions(1000, 42);
+    std::vector<double> prices;
+    for (const auto& pos : positions) {
+        prices.push_back(black_scholes_price(
+            pos.price, pos.strike, pos.volatility, pos.risk_free_rate,
+            pos.time_to_expiry, pos.type == PositionType::OPTION_CALL));
+    }
+
+    auto result = solve_implied_vols_single(positions, prices);
+
+    size_t histogram_total = 0;
+    for (size_t count : result.iteration_histogram) {
+        histogram_total += count;
+    }
+    EXPECT_EQ(histogram_total, result.num_solved);
+    EXPECT_EQ(result.num_failed, 0);
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (positions[i].type == PositionType::STOCK) {
+            EXPECT_TRUE(std::isnan(result.volatilities[i]));
+        } else {
+            EXPECT_NEAR(result.volatilities[i], positions[i].volatility, 1e-6);
+        }
+    }
+}
+
+TEST(ImpliedVolTest, MultiThreadedConsistency) {
+    auto positions = generate_random_positions(500, 7);
+    std::vector<double> prices;
+    for (const auto& pos : positions) {
+        prices.push_back(black_scholes_price(
+            pos.price, pos.strike, pos.volatility * 1.1, pos.risk_free_rate,
+            pos.time_to_expiry, pos.type == PositionType::OPTION_CALL));
+    }
+
+    auto single_result = solve_implied_vols_single(positions, prices);
+    auto multi_result = solve_implied_vols_multi(positions, prices, 4);
+
+    EXPECT_EQ(single_result.num_solved, multi_result.num_solved);
+    EXPECT_EQ(single_result.iteration_histogram, multi_result.iteration_histogram);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        if (positions[i].type != PositionType::STOCK) {
+            EXPECT_NEAR(single_result.volatilities[i],
+                        multi_result.volatilities[i], 1e-12);
+        }
+    }
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,209 @@
+#include "lib/incremental_var.h"
+
+#include "lib/chunked_mc.h"
+#include "lib/random.h"
+#include "lib/reduction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace trading {
+
+namespace {
+
+// Runs fn(begin, end) over [0, total) split into one contiguous range per
+// thread; the calling thread takes the last range.
+template <typename Fn>
+void for_each_range(size_t total, int num_threads, Fn fn) {
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(num_threads, total));
+    size_t per_chunk = total / chunks;
+    size_t remainder = total % chunks;
+
+    std::vector<std::thread> threads;
+    size_t begin = 0;
+    for (size_t c = 0; c < chunks; ++c) {
+        size_t end = begin + per_chunk + (c < remainder ? 1 : 0);
+        if (c + 1 == chunks) {
+            fn(begin, end);
+        } else {
+            threads.emplace_back(fn, begin, end);
+        }
+        begin = end;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace
+
+VaRResult select_var(std::vector<double>& pnl) {
+    if (pnl.empty()) {
+        return {0.0, 0.0, 0.0, 0.0, 0.0};
+    }
+
+    size_t n = pnl.size();
+    size_t idx_95 = static_cast<size_t>(n * 0.05);
+    size_t idx_99 = static_cast<size_t>(n * 0.01);
+
+    // Moments first, in the same order calculate_var sums them.
+    VaRResult result;
+    result.mean_pnl = reduce_sum(pnl.data(), n, Summation::NEUMAIER) / n;
+    NeumaierSum sq_sum;
+    for (double value : pnl) {
+        sq_sum.add((value - result.mean_pnl) * (value - result.mean_pnl));
+    }
+    result.std_pnl = std::sqrt(sq_sum.value() / n);
+
+    std::nth_element(pnl.begin(), pnl.begin() + idx_95, pnl.end());
+    result.var_95 = -pnl[idx_95];
+    std::nth_element(pnl.begin(), pnl.begin() + idx_99, pnl.begin() + idx_95 + 1);
+    result.var_99 = -pnl[idx_99];
+    result.expected_shortfall =
+        -reduce_sum(pnl.data(), idx_99 + 1, Summation::NEUMAIER) / (idx_99 + 1);
+    return result;
+}
+
+template <typename T>
+IncrementalVaR<T>::IncrementalVaR(const std::vector<Position>& positions,
+                                  size_t num_simulations, double time_horizon,
+                                  uint64_t seed, int num_threads)
+    : time_horizon_(time_horizon),
+      seed_(seed),
+      num_threads_(std::max(num_threads, 1)),
+      inputs_(prepare_mc_inputs(positions, time_horizon)),
+      pnl_(num_simulations) {
+    rebuild();
+}
+
+template <typename T>
+void IncrementalVaR<T>::rebuild() {
+    static constexpr size_t kBatch = 4096;
+    for_each_range(pnl_.size(), num_threads_, [this](size_t begin, size_t end) {
+        std::vector<double> batch(std::min(kBatch, end - begin));
+        for (size_t first = begin; first < end; first += kBatch) {
+            size_t count = std::min(kBatch, end - first);
+            simulate_pnl_scenarios(inputs_, seed_, first, count, batch.data());
+            for (size_t k = 0; k < count; ++k) {
+                pnl_[first + k] = static_cast<T>(batch[k]);
+            }
+        }
+    });
+}
+
+template <typename T>
+VaRResult IncrementalVaR<T>::var() const {
+    std::vector<double> scratch(pnl_.begin(), pnl_.end());
+    return select_var(scratch);
+}
+
+template <typename T>
+VaRResult IncrementalVaR<T>::what_if_add(const Position& position) const {
+    return what_if(num_slots(), SlotTerms{}, terms_for(position));
+}
+
+template <typename T>
+VaRResult IncrementalVaR<T>::what_if_replace(size_t slot, const Position& position) const {
+    check_slot(slot);
+    return what_if(slot, slot_terms(slot), terms_for(position));
+}
+
+template <typename T>
+VaRResult IncrementalVaR<T>::what_if_remove(size_t slot) const {
+    check_slot(slot);
+    return what_if(slot, slot_terms(slot), SlotTerms{});
+}
+
+template <typename T>
+size_t IncrementalVaR<T>::add(const Position& position) {
+    size_t slot = num_slots();
+    inputs_.drift.push_back(0.0);
+    inputs_.vol_sqrt_t.push_back(0.0);
+    inputs_.notional.push_back(0.0);
+    apply(slot, SlotTerms{}, terms_for(position));
+    return slot;
+}
+
+template <typename T>
+void IncrementalVaR<T>::replace(size_t slot, const Position& position) {
+    check_slot(slot);
+    apply(slot, slot_terms(slot), terms_for(position));
+}
+
+template <typename T>
+void IncrementalVaR<T>::remove(size_t slot) {
+    check_slot(slot);
+    apply(slot, slot_terms(slot), SlotTerms{});
+}
+
+template <typename T>
+typename IncrementalVaR<T>::SlotTerms IncrementalVaR<T>::terms_for(
+    const Position& position) const {
+    // Same helper as prepare_mc_inputs, so a rebuild agrees.
+    GbmTerms terms = gbm_terms(position, time_horizon_, std::sqrt(time_horizon_));
+    return {terms.drift, terms.vol_sqrt_t, terms.notional};
+}
+
+template <typename T>
+typename IncrementalVaR<T>::SlotTerms IncrementalVaR<T>::slot_terms(size_t slot) const {
+    return {inputs_.drift[slot], inputs_.vol_sqrt_t[slot], inputs_.notional[slot]};
+}
+
+template <typename T>
+void IncrementalVaR<T>::set_slot_terms(size_t slot, const SlotTerms& terms) {
+    inputs_.drift[slot] = terms.drift;
+    inputs_.vol_sqrt_t[slot] = terms.vol_sqrt_t;
+    inputs_.notional[slot] = terms.notional;
+}
+
+template <typename T>
+void IncrementalVaR<T>::check_slot(size_t slot) const {
+    if (slot >= num_slots()) {
+        throw std::invalid_argument("position slot out of range");
+    }
+}
+
+template <typename T>
+template <typename Out>
+void IncrementalVaR<T>::shifted_pnl(size_t slot, const SlotTerms& before,
+                                    const SlotTerms& after, Out* out) const {
+    uint64_t block = slot / 4;
+    size_t lane = slot % 4;
+    for_each_range(pnl_.size(), num_threads_, [&](size_t begin, size_t end) {
+        Philox4x32 rng(seed_);
+        for (size_t s = begin; s < end; ++s) {
+            double z = normal_lane(rng(s, block), lane);
+            double delta = 0.0;
+            if (before.notional != 0.0) {
+                delta -= before.notional * (std::exp(before.drift + before.vol_sqrt_t * z) - 1.0);
+            }
+            if (after.notional != 0.0) {
+                delta += after.notional * (std::exp(after.drift + after.vol_sqrt_t * z) - 1.0);
+            }
+            out[s] = static_cast<Out>(static_cast<double>(pnl_[s]) + delta);
+        }
+    });
+}
+
+template <typename T>
+VaRResult IncrementalVaR<T>::what_if(size_t slot, const SlotTerms& before,
+                                     const SlotTerms& after) const {
+    std::vector<double> scratch(pnl_.size());
+    shifted_pnl(slot, before, after, scratch.data());
+    return select_var(scratch);
+}
+
+template <typename T>
+void IncrementalVaR<T>::apply(size_t slot, const SlotTerms& before, const SlotTerms& after) {
+    // Each scenario is read and written by the same thread, so the cache
+    // can be updated in place.
+    shifted_pnl(slot, before, after, pnl_.data());
+    set_slot_terms(slot, after);
+}
+
+template class IncrementalVaR<double>;
+template class IncrementalVaR<float>;
+
+}  // namespace trading
@@ -0,0 +1,116 @@
+#include "lib/incremental_var.h"
+
+#include "lib/chunked_mc.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <stdexcept>
+#include <vector>
+
+namespace trading {
+namespace {
+
+VaRResult full_rerun(const std::vector<Position>& positions, size_t num_simulations,
+                     uint64_t seed) {
+    std::vector<double> pnl(num_simulations);
+    simulate_pnl_scenarios(prepare_mc_inputs(positions, 1.0/252.0), seed, 0,
+                           pnl.size(), pnl.data());
+    return calculate_var(pnl);
+}
+
+void expect_close(const VaRResult& actual, const VaRResult& expected, double rel) {
+    double scale = std::abs(expected.expected_shortfall);
+    EXPECT_NEAR(actual.var_95, expected.var_95, rel * scale);
+    EXPECT_NEAR(actual.var_99, expected.var_99, rel * scale);
+    EXPECT_NEAR(actual.expected_shortfall, expected.expected_shortfall, rel * scale);
+    EXPECT_NEAR(actual.mean_pnl, expected.mean_pnl, rel * scale);
+    EXPECT_NEAR(actual.std_pnl, expected.std_pnl, rel * scale);
+}
+
+TEST(IncrementalVaRTest, SelectVarMatchesCalculateVar) {
+    std::vector<double> pnl(10007);
+    for (size_t i = 0; i < pnl.size(); ++i) {
+        pnl[i] = std::sin(i * 1.7) * 1000.0 + std::cos(i * 0.3) * 50.0;
+    }
+    VaRResult expected = calculate_var(pnl);
+    VaRResult actual = select_var(pnl);
+    EXPECT_EQ(actual.var_95, expected.var_95);
+    EXPECT_EQ(actual.var_99, expected.var_99);
+    EXPECT_EQ(actual.mean_pnl, expected.mean_pnl);
+    EXPECT_EQ(actual.std_pnl, expected.std_pnl);
+    EXPECT_NEAR(actual.expected_shortfall, expected.expected_shortfall, 1e-9);
+
+    std::vector<double> empty;
+    EXPECT_EQ(select_var(empty).var_99, 0.0);
+}
+
+TEST(IncrementalVaRTest, CacheMatchesFullSimulation) {
+    auto positions = generate_random_positions(23, 6);
+    IncrementalVaR<> engine(positions, 5000, 1.0/252.0, 7, 3);
+
+    std::vector<double> pnl(5000);
+    simulate_pnl_scenarios(prepare_mc_inputs(positions, 1.0/252.0), 7, 0,
+                           pnl.size(), pnl.data());
+    EXPECT_EQ(engine.scenario_pnl(), pnl);
+    VaRResult expected = calculate_var(pnl);
+    EXPECT_EQ(engine.var().var_99, expected.var_99);
+    EXPECT_EQ(engine.num_slots(), positions.size());
+}
+
+TEST(IncrementalVaRTest, WhatIfAndUpdatesMatchFullRerun) {
+    const size_t kSims = 8000;
+    const uint64_t kSeed = 11;
+    auto positions = generate_random_positions(30, 17);
+    auto trades = generate_random_positions(2, 99);
+    IncrementalVaR<> engine(positions, kSims, 1.0/252.0, kSeed, 2);
+    VaRResult before = engine.var();
+
+    // Replace a position.
+    auto replaced = positions;
+    replaced[4] = trades[0];
+    VaRResult what_if = engine.what_if_replace(4, trades[0]);
+    expect_close(what_if, full_rerun(replaced, kSims, kSeed), 1e-9);
+    EXPECT_EQ(engine.var().var_99, before.var_99);  // Book unchanged
+    engine.replace(4, trades[0]);
+    EXPECT_EQ(engine.var().var_99, what_if.var_99);
+    EXPECT_EQ(engine.var().expected_shortfall, what_if.expected_shortfall);
+
+    // Add a new trade in the next slot.
+    auto added = replaced;
+    added.push_back(trades[1]);
+    expect_close(engine.what_if_add(trades[1]), full_rerun(added, kSims, kSeed), 1e-9);
+    EXPECT_EQ(engine.add(trades[1]), positions.size());
+    expect_close(engine.var(), full_rerun(added, kSims, kSeed), 1e-9);
+
+    // Remove one: the slot stays, with nothing in it.
+    auto removed = added;
+    removed[9].quantity = 0.0;
+    expect_close(engine.what_if_remove(9), full_rerun(removed, kSims, kSeed), 1e-9);
+    engine.remove(9);
+    EXPECT_EQ(engine.num_slots(), positions.size() + 1);
+    expect_close(engine.var(), full_rerun(removed, kSims, kSeed), 1e-9);
+
+    engine.rebuild();
+    expect_close(engine.var(), full_rerun(removed, kSims, kSeed), 1e-12);
+
+    EXPECT_THROW(engine.replace(engine.num_slots(), trades[0]), std::invalid_argument);
+    EXPECT_THROW(engine.what_if_remove(engine.num_slots()), std::invalid_argument);
+}
+
+TEST(IncrementalVaRTest, FloatCacheTracksDouble) {
+    auto positions = generate_random_positions(40, 3);
+    auto trades = generate_random_positions(20, 4);
+    IncrementalVaR<double> exact(positions, 4000, 1.0/252.0);
+    IncrementalVaR<float> compact(positions, 4000, 1.0/252.0);
+    for (size_t k = 0; k < trades.size(); ++k) {
+        exact.replace(k, trades[k]);
+        compact.replace(k, trades[k]);
+    }
+    // Each update rounds every scenario to float once more.
+    expect_close(compact.var(), exact.var(), 1e-5);
+    compact.rebuild();
+    expect_close(compact.var(), exact.var(), 1e-6);
+}
+
+}  // namespace
+}  // namespace trading
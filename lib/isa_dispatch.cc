@@ -0,0 +1,190 @@
+#include "lib/isa_dispatch.h"
+
+#include "lib/lattice.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace trading {
+
+// Kernels from lib/isa_kernels.cc, one namespace per compiled variant.
+#define TRADING_DECLARE_ISA_KERNELS(ns)                                          \
+    namespace ns {                                                               \
+    void price_european_range(const Position* positions, const uint32_t* order, \
+                              size_t calls_end, size_t puts_end,                \
+                              size_t stocks_end, size_t start, size_t end,      \
+                              double bump_size, Greeks* results);               \
+    void fast_normal_cdf_batch(const double* x, double* out, size_t n);         \
+    }
+
+TRADING_DECLARE_ISA_KERNELS(isa_baseline)
+#if defined(TRADING_HAVE_ISA_VARIANTS)
+TRADING_DECLARE_ISA_KERNELS(isa_v2)
+TRADING_DECLARE_ISA_KERNELS(isa_v3)
+TRADING_DECLARE_ISA_KERNELS(isa_v4)
+#endif
+
+#undef TRADING_DECLARE_ISA_KERNELS
+
+namespace {
+
+struct IsaKernels {
+    decltype(&isa_baseline::price_european_range) price_european_range;
+    decltype(&isa_baseline::fast_normal_cdf_batch) fast_normal_cdf_batch;
+};
+
+// Indexed by IsaLevel; null where the variant is not compiled.
+constexpr IsaKernels kKernels[] = {
+    {isa_baseline::price_european_range, isa_baseline::fast_normal_cdf_batch},
+#if defined(TRADING_HAVE_ISA_VARIANTS)
+    {isa_v2::price_european_range, isa_v2::fast_normal_cdf_batch},
+    {isa_v3::price_european_range, isa_v3::fast_normal_cdf_batch},
+    {isa_v4::price_european_range, isa_v4::fast_normal_cdf_batch},
+#else
+    {nullptr, nullptr},
+    {nullptr, nullptr},
+    {nullptr, nullptr},
+#endif
+};
+
+constexpr int kUnselected = -1;
+std::atomic<int> g_selected{kUnselected};
+
+bool usable(IsaLevel level) {
+    return isa_level_compiled(level) &&
+           static_cast<int>(level) <= static_cast<int>(detect_isa_level());
+}
+
+const IsaKernels& selected_kernels() {
+    return kKernels[static_cast<int>(selected_isa_level())];
+}
+
+void price_isa_range(const std::vector<Position>& positions,
+                     const TypePartition& partition, size_t start, size_t end,
+                     double bump_size, Greeks* results) {
+    const uint32_t* order = partition.order.data();
+    selected_kernels().price_european_range(
+        positions.data(), order, partition.calls_end, partition.puts_end,
+        partition.stocks_end, start, end, bump_size, results);
+
+    for (size_t k = std::max(start, partition.stocks_end); k < end; ++k) {
+        uint32_t i = order[k];
+        results[i] = calculate_lattice_greeks(positions[i], kDefaultLatticeSteps,
+                                              LatticeMethod::LEISEN_REIMER, bump_size);
+    }
+}
+
+}  // namespace
+
+const char* isa_level_name(IsaLevel level) {
+    switch (level) {
+        case IsaLevel::BASELINE: return "baseline";
+        case IsaLevel::X86_64_V2: return "x86-64-v2";
+        case IsaLevel::X86_64_V3: return "x86-64-v3";
+        case IsaLevel::X86_64_V4: return "x86-64-v4";
+    }
+    return "unknown";
+}
+
+bool parse_isa_level(const std::string& name, IsaLevel* level) {
+    if (name == "baseline") {
+        *level = IsaLevel::BASELINE;
+    } else if (name == "x86-64-v2" || name == "v2") {
+        *level = IsaLevel::X86_64_V2;
+    } else if (name == "x86-64-v3" || name == "v3") {
+        *level = IsaLevel::X86_64_V3;
+    } else if (name == "x86-64-v4" || name == "v4") {
+        *level = IsaLevel::X86_64_V4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+IsaLevel detect_isa_level() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    // Feature sets from the x86-64 psABI levels. __builtin_cpu_supports
+    // also checks that the OS saves the AVX/AVX-512 register state.
+    __builtin_cpu_init();
+    bool v2 = __builtin_cpu_supports("sse3") && __builtin_cpu_supports("ssse3") &&
+              __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("sse4.2") &&
+              __builtin_cpu_supports("popcnt");
+    bool v3 = v2 && __builtin_cpu_supports("avx") && __builtin_cpu_supports("avx2") &&
+              __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2") &&
+              __builtin_cpu_supports("fma");
+    bool v4 = v3 && __builtin_cpu_supports("avx512f") &&
+              __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512cd") &&
+              __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl");
+    if (v4) return IsaLevel::X86_64_V4;
+    if (v3) return IsaLevel::X86_64_V3;
+    if (v2) return IsaLevel::X86_64_V2;
+#endif
+    return IsaLevel::BASELINE;
+}
+
+bool isa_level_compiled(IsaLevel level) {
+    return kKernels[static_cast<int>(level)].price_european_range != nullptr;
+}
+
+IsaLevel selected_isa_level() {
+    int selected = g_selected.load(std::memory_order_acquire);
+    if (selected == kUnselected) {
+        IsaLevel best = IsaLevel::BASELINE;
+        for (IsaLevel level : {IsaLevel::X86_64_V2, IsaLevel::X86_64_V3,
+                               IsaLevel::X86_64_V4}) {
+            if (usable(level)) best = level;
+        }
+        int expected = kUnselected;
+        g_selected.compare_exchange_strong(expected, static_cast<int>(best),
+                                           std::memory_order_acq_rel);
+        selected = g_selected.load(std::memory_order_acquire);
+    }
+    return static_cast<IsaLevel>(selected);
+}
+
+bool set_isa_level(IsaLevel level) {
+    if (!usable(level)) return false;
+    g_selected.store(static_cast<int>(level), std::memory_order_release);
+    return true;
+}
+
+std::vector<Greeks> calculate_all_greeks_isa_single(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    double bump_size) {
+    std::vector<Greeks> results(positions.size());
+    price_isa_range(positions, partition, 0, partition.order.size(), bump_size,
+                    results.data());
+    return results;
+}
+
+std::vector<Greeks> calculate_all_greeks_isa_multi(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    int num_threads, double bump_size) {
+    std::vector<Greeks> results(positions.size());
+    std::vector<std::thread> threads;
+    size_t count = partition.order.size();
+    size_t chunk_size = (count + num_threads - 1) / num_threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        size_t start = t * chunk_size;
+        size_t end = std::min(start + chunk_size, count);
+        if (start < end) {
+            threads.emplace_back([&, start, end]() {
+                price_isa_range(positions, partition, start, end, bump_size,
+                                results.data());
+            });
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
+void normal_cdf_batch_isa(const double* x, double* out, size_t n) {
+    selected_kernels().fast_normal_cdf_batch(x, out, n);
+}
+
+}  // namespace trading
@@ -0,0 +1,51 @@
+#ifndef LIB_ISA_DISPATCH_H_
+#define LIB_ISA_DISPATCH_H_
+
+#include "lib/greeks.h"
+#include "lib/position.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// x86-64 microarchitecture levels the hot kernels are built for
+// (lib/isa_kernels.cc). BASELINE is whatever the rest of the build targets
+// and is the only level on other architectures.
+enum class IsaLevel { BASELINE, X86_64_V2, X86_64_V3, X86_64_V4 };
+
+const char* isa_level_name(IsaLevel level);
+// Accepts the names isa_level_name returns plus "v2"/"v3"/"v4".
+bool parse_isa_level(const std::string& name, IsaLevel* level);
+
+// Highest level this CPU (and OS, for the AVX state) supports.
+IsaLevel detect_isa_level();
+// Whether the build contains kernels for `level`.
+bool isa_level_compiled(IsaLevel level);
+
+// Level the dispatched kernels run at: the highest one that is both
+// compiled and supported, unless overridden.
+IsaLevel selected_isa_level();
+// Forces a level, e.g. to compare variants on one machine. Returns false
+// and keeps the current selection if the level is not compiled or not
+// supported here.
+bool set_isa_level(IsaLevel level);
+
+// calculate_all_greeks_partitioned_* with FastNormal, with the European
+// and stock segments priced by the selected variant. American options go
+// through the lattice at baseline.
+std::vector<Greeks> calculate_all_greeks_isa_single(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    double bump_size = 0.01);
+
+std::vector<Greeks> calculate_all_greeks_isa_multi(
+    const std::vector<Position>& positions, const TypePartition& partition,
+    int num_threads, double bump_size = 0.01);
+
+// normal_cdf_batch<FastNormal> through the selected variant.
+void normal_cdf_batch_isa(const double* x, double* out, size_t n);
+
+}  // namespace trading
+
+#endif  // LIB_ISA_DISPATCH_H_
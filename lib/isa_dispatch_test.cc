@@ -0,0 +1,91 @@
+#include "lib/isa_dispatch.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace trading {
+namespace {
+
+std::vector<IsaLevel> all_levels() {
+    return {IsaLevel::BASELINE, IsaLevel::X86_64_V2, IsaLevel::X86_64_V3,
+            IsaLevel::X86_64_V4};
+}
+
+TEST(IsaDispatchTest, NamesRoundTrip) {
+    for (IsaLevel level : all_levels()) {
+        IsaLevel parsed;
+        ASSERT_TRUE(parse_isa_level(isa_level_name(level), &parsed));
+        EXPECT_EQ(parsed, level);
+    }
+    IsaLevel parsed;
+    EXPECT_TRUE(parse_isa_level("v3", &parsed));
+    EXPECT_EQ(parsed, IsaLevel::X86_64_V3);
+    EXPECT_FALSE(parse_isa_level("sse2", &parsed));
+}
+
+TEST(IsaDispatchTest, SelectsBestUsableLevel) {
+    EXPECT_TRUE(isa_level_compiled(IsaLevel::BASELINE));
+    IsaLevel selected = selected_isa_level();
+    EXPECT_TRUE(isa_level_compiled(selected));
+    EXPECT_LE(static_cast<int>(selected), static_cast<int>(detect_isa_level()));
+
+    for (IsaLevel level : all_levels()) {
+        bool usable = isa_level_compiled(level) &&
+                      static_cast<int>(level) <= static_cast<int>(detect_isa_level());
+        EXPECT_EQ(set_isa_level(level), usable);
+        if (!usable) {
+            EXPECT_NE(selected_isa_level(), level);
+        } else {
+            EXPECT_EQ(selected_isa_level(), level);
+        }
+    }
+    ASSERT_TRUE(set_isa_level(selected));
+}
+
+// Variants may contract into FMAs, so they agree with the baseline to
+// rounding rather than bitwise.
+TEST(IsaDispatchTest, EveryUsableVariantMatchesPartitionedKernels) {
+    auto positions = generate_random_positions(2000, 91);
+    for (size_t i = 0; i < positions.size(); i += 101) {
+        if (positions[i].type != PositionType::STOCK) {
+            positions[i].exercise = ExerciseStyle::AMERICAN;
+        }
+    }
+    TypePartition partition = partition_by_type(positions);
+    auto expected = calculate_all_greeks_partitioned_single<FastNormal>(positions, partition);
+
+    std::vector<double> xs(1001);
+    for (size_t i = 0; i < xs.size(); ++i) {
+        xs[i] = -6.0 + 12.0 * i / (xs.size() - 1);
+    }
+    std::vector<double> cdf_expected(xs.size());
+    normal_cdf_batch<FastNormal>(xs.data(), cdf_expected.data(), xs.size());
+
+    IsaLevel original = selected_isa_level();
+    for (IsaLevel level : all_levels()) {
+        if (!set_isa_level(level)) continue;
+        SCOPED_TRACE(isa_level_name(level));
+
+        for (const auto& actual : {calculate_all_greeks_isa_single(positions, partition),
+                                   calculate_all_greeks_isa_multi(positions, partition, 3)}) {
+            ASSERT_EQ(actual.size(), expected.size());
+            for (size_t i = 0; i < expected.size(); ++i) {
+                double scale = 1.0 + std::abs(expected[i].price);
+                EXPECT_NEAR(actual[i].price, expected[i].price, 1e-10 * scale);
+                EXPECT_NEAR(actual[i].delta, expected[i].delta, 1e-8);
+                EXPECT_NEAR(actual[i].vega, expected[i].vega, 1e-6 * scale);
+            }
+        }
+
+        std::vector<double> cdf(xs.size());
+        normal_cdf_batch_isa(xs.data(), cdf.data(), xs.size());
+        for (size_t i = 0; i < xs.size(); ++i) {
+            EXPECT_NEAR(cdf[i], cdf_expected[i], 1e-14);
+        }
+    }
+    set_isa_level(original);
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,73 @@
+// Hot kernels compiled once per ISA level. The build compiles this file
+// several times with different -march flags, each time with
+// TRADING_ISA_VARIANT naming the namespace the kernels land in, and
+// lib/isa_dispatch.cc picks one at runtime.
+//
+// Every kernel is flattened so the inline helpers it uses (Black-Scholes,
+// the normal policies) are inlined rather than emitted as weak symbols:
+// a weak copy built for AVX-512 could otherwise win at link time and be
+// called from baseline code.
+
+#include "lib/greeks.h"
+#include "lib/normal.h"
+#include "lib/position.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef TRADING_ISA_VARIANT
+#error "Define TRADING_ISA_VARIANT to the kernel namespace (e.g. isa_v3)"
+#endif
+
+#if defined(__GNUC__)
+#define TRADING_ISA_KERNEL __attribute__((flatten))
+#else
+#define TRADING_ISA_KERNEL
+#endif
+
+namespace trading {
+namespace TRADING_ISA_VARIANT {
+
+namespace {
+
+template <PositionType Type>
+TRADING_ISA_KERNEL void price_segment(const Position* positions, const uint32_t* indices,
+                                      size_t count, double bump_size, Greeks* results) {
+    for (size_t k = 0; k < count; ++k) {
+        uint32_t i = indices[k];
+        results[i] = calculate_greeks_typed<Type, FastNormal>(positions[i], bump_size);
+    }
+}
+
+}  // namespace
+
+TRADING_ISA_KERNEL void price_european_range(
+    const Position* positions, const uint32_t* order, size_t calls_end,
+    size_t puts_end, size_t stocks_end, size_t start, size_t end,
+    double bump_size, Greeks* results) {
+    auto clip = [&](size_t lo, size_t hi) {
+        lo = std::max(lo, start);
+        hi = std::min(hi, end);
+        return std::make_pair(lo, hi > lo ? hi - lo : 0);
+    };
+
+    auto [calls, num_calls] = clip(0, calls_end);
+    price_segment<PositionType::OPTION_CALL>(positions, order + calls, num_calls,
+                                             bump_size, results);
+    auto [puts, num_puts] = clip(calls_end, puts_end);
+    price_segment<PositionType::OPTION_PUT>(positions, order + puts, num_puts,
+                                            bump_size, results);
+    auto [stocks, num_stocks] = clip(puts_end, stocks_end);
+    price_segment<PositionType::STOCK>(positions, order + stocks, num_stocks,
+                                       bump_size, results);
+}
+
+TRADING_ISA_KERNEL void fast_normal_cdf_batch(const double* x, double* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = FastNormal::cdf(x[i]);
+    }
+}
+
+}  // namespace TRADING_ISA_VARIANT
+}  // namespace trading
@@ -0,0 +1,183 @@
+#include "lib/lattice.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace trading {
+
+namespace {
+
+struct LatticeParams {
+    int steps;
+    double dt;
+    double up;
+    double down;
+    double p_up;
+    double discount;
+};
+
+// Layers 0..2 of the lattice, enough for price, delta, gamma and theta.
+struct LatticeRoot {
+    double v0;
+    double v2[3];
+};
+
+// Peizer-Pratt method 2 inversion of the binomial distribution.
+double peizer_pratt(double z, int n) {
+    double t = z / (n + 1.0 / 3.0 + 0.1 / (n + 1.0));
+    return 0.5 + std::copysign(0.5, z) *
+                     std::sqrt(1.0 - std::exp(-t * t * (n + 1.0 / 6.0)));
+}
+
+LatticeParams make_params(double spot, double strike, double vol, double rate,
+                          double time, int steps, LatticeMethod method) {
+    LatticeParams p;
+    if (method == LatticeMethod::LEISEN_REIMER && steps % 2 == 0) {
+        ++steps;
+    }
+    p.steps = std::max(steps, 3);
+    p.dt = time / p.steps;
+    double growth = std::exp(rate * p.dt);
+    p.discount = 1.0 / growth;
+
+    if (method == LatticeMethod::CRR) {
+        p.up = std::exp(vol * std::sqrt(p.dt));
+        p.down = 1.0 / p.up;
+        p.p_up = (growth - p.down) / (p.up - p.down);
+    } else {
+        double vol_sqrt_t = vol * std::sqrt(time);
+        double d1 = (std::log(spot / strike) + (rate + 0.5 * vol * vol) * time) /
+                    vol_sqrt_t;
+        double d2 = d1 - vol_sqrt_t;
+        double p_d2 = peizer_pratt(d2, p.steps);
+        double p_d1 = peizer_pratt(d1, p.steps);
+        p.up = growth * p_d1 / p_d2;
+        p.down = (growth - p_d2 * p.up) / (1.0 - p_d2);
+        p.p_up = p_d2;
+    }
+
+    return p;
+}
+
+// Node arrays are reused across calls on the same thread.
+std::vector<double>& lattice_values() {
+    thread_local std::vector<double> values;
+    return values;
+}
+
+std::vector<double>& lattice_spots() {
+    thread_local std::vector<double> spots;
+    return spots;
+}
+
+// Backward induction over SoA node arrays. Each layer is a straight loop
+// over contiguous values (and, for American exercise, spots walked back a
+// layer with one multiply), so the inner loops vectorize.
+LatticeRoot induct(const LatticeParams& p, double spot, double strike,
+                   bool is_call, bool american) {
+    int n = p.steps;
+    std::vector<double>& values = lattice_values();
+    std::vector<double>& spots = lattice_spots();
+    values.resize(n + 1);
+    spots.resize(n + 1);
+    double* v = values.data();
+    double* s = spots.data();
+
+    double omega = is_call ? 1.0 : -1.0;
+    double ratio = p.up / p.down;
+    s[0] = spot * std::pow(p.down, n);
+    for (int i = 1; i <= n; ++i) {
+        s[i] = s[i - 1] * ratio;
+    }
+    for (int i = 0; i <= n; ++i) {
+        v[i] = std::max(omega * (s[i] - strike), 0.0);
+    }
+
+    double pu = p.discount * p.p_up;
+    double pd = p.discount * (1.0 - p.p_up);
+    double inv_down = 1.0 / p.down;
+    LatticeRoot root;
+
+    for (int j = n - 1; j >= 0; --j) {
+        if (american) {
+            for (int i = 0; i <= j; ++i) {
+                s[i] *= inv_down;
+                double cont = pu * v[i + 1] + pd * v[i];
+                v[i] = std::max(cont, omega * (s[i] - strike));
+            }
+        } else {
+            for (int i = 0; i <= j; ++i) {
+                v[i] = pu * v[i + 1] + pd * v[i];
+            }
+        }
+
+        if (j == 2) {
+            std::copy(v, v + 3, root.v2);
+        }
+    }
+
+    root.v0 = v[0];
+    return root;
+}
+
+}  // namespace
+
+double lattice_price(double spot, double strike, double vol, double rate,
+                     double time, bool is_call, bool american, int steps,
+                     LatticeMethod method) {
+    if (time <= 0.0 || vol <= 0.0) {
+        return black_scholes_price(spot, strike, vol, rate, time, is_call);
+    }
+
+    LatticeParams p = make_params(spot, strike, vol, rate, time, steps, method);
+    return induct(p, spot, strike, is_call, american).v0;
+}
+
+Greeks calculate_lattice_greeks(const Position& pos, int steps,
+                                LatticeMethod method, double bump_size) {
+    if (pos.type == PositionType::STOCK || pos.time_to_expiry <= 0.0 ||
+        pos.volatility <= 0.0) {
+        // Nothing left to exercise early; the European path handles these.
+        Position european = pos;
+        european.exercise = ExerciseStyle::EUROPEAN;
+        return calculate_greeks(european, bump_size);
+    }
+
+    bool is_call = (pos.type == PositionType::OPTION_CALL);
+    bool american = (pos.exercise == ExerciseStyle::AMERICAN);
+    double spot = pos.price;
+    double strike = pos.strike;
+    double vol = pos.volatility;
+    double rate = pos.risk_free_rate;
+    double time = pos.time_to_expiry;
+
+    LatticeParams p = make_params(spot, strike, vol, rate, time, steps, method);
+    LatticeRoot root = induct(p, spot, strike, is_call, american);
+
+    double s20 = spot * p.down * p.down;
+    double s21 = spot * p.up * p.down;
+    double s22 = spot * p.up * p.up;
+
+    Greeks result{};
+    result.price = root.v0;
+    result.delta = (root.v2[2] - root.v2[0]) / (s22 - s20);
+    result.gamma = ((root.v2[2] - root.v2[1]) / (s22 - s21) -
+                    (root.v2[1] - root.v2[0]) / (s21 - s20)) /
+                   (0.5 * (s22 - s20));
+
+    // The middle node two steps in sits at spot only for CRR; remove the
+    // spot drift with delta/gamma before differencing in time.
+    double ds = s21 - spot;
+    result.theta = (root.v2[1] - root.v0 - result.delta * ds -
+                    0.5 * result.gamma * ds * ds) / (2.0 * p.dt);
+
+    LatticeParams bumped = make_params(spot, strike, vol + bump_size, rate,
+                                       time, steps, method);
+    double price_vol_up = induct(bumped, spot, strike, is_call, american).v0;
+    result.vega = (price_vol_up - result.price) / bump_size;
+
+    return result;
+}
+
+}  // namespace trading
@@ -0,0 +1,29 @@
+#ifndef LIB_LATTICE_H_
+#define LIB_LATTICE_H_
+
+#include "lib/greeks.h"
+#include "lib/position.h"
+
+namespace trading {
+
+enum class LatticeMethod {
+    CRR,           // Cox-Ross-Rubinstein
+    LEISEN_REIMER  // Peizer-Pratt inversion; rounds steps up to odd
+};
+
+constexpr int kDefaultLatticeSteps = 201;
+
+double lattice_price(double spot, double strike, double vol, double rate,
+                     double time, bool is_call, bool american, int steps,
+                     LatticeMethod method = LatticeMethod::LEISEN_REIMER);
+
+// Delta, gamma and theta come from the nodes of the pricing lattice itself;
+// only vega needs a second (bumped-vol) induction.
+Greeks calculate_lattice_greeks(
+    const Position& pos, int steps = kDefaultLatticeSteps,
+    LatticeMethod method = LatticeMethod::LEISEN_REIMER,
+    double bump_size = 0.01);
+
+}  // namespace trading
+
+#endif  // LIB_LATTICE_H_
@@ -0,0 +1,68 @@
+#include "lib/lattice.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+TEST(LatticeTest, EuropeanConvergesToBlackScholes) {
+    double bs = black_scholes_price(100.0, 105.0, 0.25, 0.05, 1.0, true);
+    double lr = lattice_price(100.0, 105.0, 0.25, 0.05, 1.0, true, false, 201,
+                              LatticeMethod::LEISEN_REIMER);
+    double crr = lattice_price(100.0, 105.0, 0.25, 0.05, 1.0, true, false, 1000,
+                               LatticeMethod::CRR);
+
+    EXPECT_NEAR(lr, bs, 1e-4);
+    EXPECT_NEAR(crr, bs, 1e-2);
+}
+
+TEST(LatticeTest, AmericanPutEarlyExercisePremium) {
+    double european = black_scholes_price(100.0, 110.0, 0.2, 0.05, 1.0, false);
+    double american = lattice_price(100.0, 110.0, 0.2, 0.05, 1.0, false, true, 501);
+
+    EXPECT_GT(american, european + 0.1);
+    EXPECT_GE(american, 10.0);
+}
+
+TEST(LatticeTest, AmericanCallEqualsEuropean) {
+    double european = black_scholes_price(100.0, 95.0, 0.3, 0.05, 0.5, true);
+    double american = lattice_price(100.0, 95.0, 0.3, 0.05, 0.5, true, true, 201);
+
+    EXPECT_NEAR(american, european, 1e-3);
+}
+
+TEST(LatticeTest, GreeksMatchBlackScholesForEuropean) {
+    Position option{.symbol = "AAPL", .quantity = 10, .price = 150.0,
+                    .volatility = 0.3, .type = PositionType::OPTION_PUT,
+                    .strike = 155.0, .time_to_expiry = 0.5, .risk_free_rate = 0.05};
+
+    Greeks analytic = calculate_greeks(option);
+    Greeks lattice = calculate_lattice_greeks(option, 501);
+
+    EXPECT_NEAR(lattice.price, analytic.price, 1e-3);
+    EXPECT_NEAR(lattice.delta, analytic.delta, 1e-3);
+    EXPECT_NEAR(lattice.gamma, analytic.gamma, 1e-3);
+    EXPECT_NEAR(lattice.vega, analytic.vega, 0.05);
+    EXPECT_NEAR(lattice.theta, analytic.theta, 0.1);
+}
+
+TEST(LatticeTest, CalculateGreeksDispatchesAmerican) {
+    Position option{.symbol = "AAPL", .quantity = 10, .price = 100.0,
+                    .volatility = 0.2, .type = PositionType::OPTION_PUT,
+                    .strike = 110.0, .time_to_expiry = 1.0, .risk_free_rate = 0.05,
+                    .exercise = ExerciseStyle::AMERICAN};
+
+    Greeks dispatched = calculate_greeks(option);
+    Greeks direct = calculate_lattice_greeks(option);
+    option.exercise = ExerciseStyle::EUROPEAN;
+    Greeks european = calculate_greeks(option);
+
+    EXPECT_EQ(dispatched.price, direct.price);
+    EXPECT_GT(dispatched.price, european.price);
+    EXPECT_LT(dispatched.delta, 0.0);
+    EXPECT_GT(dispatched.gamma, 0.0);
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,213 @@
+#include "lib/market_data.h"
+
+#include "lib/system.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace trading {
+
+namespace {
+
+int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+}  // namespace
+
+MarketDataEngine::MarketDataEngine(std::vector<Position> positions,
+                                   const MarketDataConfig& config)
+    : positions_(std::move(positions)),
+      config_(config),
+      shared_(config.ring_capacity) {
+    std::vector<uint32_t> position_symbol = intern_symbols(positions_, &symbols_);
+    reference_spots_.resize(symbols_.size());
+    for (size_t i = positions_.size(); i-- > 0;) {
+        reference_spots_[position_symbol[i]] = positions_[i].price;
+    }
+
+    size_t num_symbols = symbols_.size();
+    dependent_offsets_.assign(num_symbols + 1, 0);
+    for (uint32_t s : position_symbol) {
+        ++dependent_offsets_[s + 1];
+    }
+    for (size_t s = 0; s < num_symbols; ++s) {
+        dependent_offsets_[s + 1] += dependent_offsets_[s];
+    }
+    dependents_.resize(positions_.size());
+    std::vector<uint32_t> cursor(dependent_offsets_.begin(),
+                                 dependent_offsets_.end() - 1);
+    for (size_t i = 0; i < positions_.size(); ++i) {
+        dependents_[cursor[position_symbol[i]]++] = static_cast<uint32_t>(i);
+    }
+
+    base_prices_.resize(positions_.size());
+    for (size_t i = 0; i < positions_.size(); ++i) {
+        base_prices_[i] = positions_[i].price;
+    }
+    spots_ = reference_spots_;
+    dirty_.assign(num_symbols, 0);
+    dirty_symbols_.reserve(num_symbols);
+
+    greeks_.resize(positions_.size());
+    for (size_t i = 0; i < positions_.size(); ++i) {
+        greeks_[i] = reprice(positions_[i]);
+    }
+
+    size_t num_feeds = std::max<size_t>(config_.num_feeds, 1);
+    for (size_t f = 0; f < num_feeds; ++f) {
+        feeds_.push_back(std::make_unique<SpscRing<Tick>>(config_.ring_capacity));
+    }
+    batch_.resize(std::max<size_t>(config_.batch_size, 1));
+    TscClock::ticks_per_ns();  // Calibrate before the pricing thread needs it
+}
+
+MarketDataEngine::~MarketDataEngine() {
+    stop();
+}
+
+int MarketDataEngine::symbol_id(const std::string& symbol) const {
+    return symbols_.find(symbol);
+}
+
+bool MarketDataEngine::publish(size_t feed, const Tick& tick) {
+    return feeds_[feed]->try_push(tick);
+}
+
+bool MarketDataEngine::publish_shared(const Tick& tick) {
+    return shared_.try_push(tick);
+}
+
+void MarketDataEngine::start() {
+    if (running_.exchange(true)) return;
+    pricing_thread_ = std::thread(&MarketDataEngine::pricing_loop, this);
+}
+
+void MarketDataEngine::stop() {
+    if (!running_.exchange(false)) return;
+    pricing_thread_.join();
+}
+
+size_t MarketDataEngine::poll() {
+    return drain();
+}
+
+MarketDataStats MarketDataEngine::stats() const {
+    return {ticks_processed_.load(std::memory_order_relaxed),
+            batches_.load(std::memory_order_relaxed),
+            options_repriced_.load(std::memory_order_relaxed)};
+}
+
+void MarketDataEngine::pricing_loop() {
+    if (config_.pricing_cpu >= 0) {
+        set_thread_affinity(std::vector<int>{config_.pricing_cpu});
+    }
+
+    while (running_.load(std::memory_order_acquire)) {
+        if (drain() == 0) {
+            std::this_thread::yield();
+        }
+    }
+    while (drain() > 0) {
+    }
+}
+
+size_t MarketDataEngine::drain() {
+    size_t total = 0;
+    for (auto& feed : feeds_) {
+        size_t count = feed->pop_batch(batch_.data(), batch_.size());
+        if (count > 0) {
+            process(batch_.data(), count);
+            total += count;
+        }
+    }
+    size_t count = shared_.pop_batch(batch_.data(), batch_.size());
+    if (count > 0) {
+        process(batch_.data(), count);
+        total += count;
+    }
+    return total;
+}
+
+Greeks MarketDataEngine::reprice(const Position& pos) const {
+    return config_.fast_normal ? calculate_greeks<FastNormal>(pos)
+                               : calculate_greeks<PreciseNormal>(pos);
+}
+
+void MarketDataEngine::process(const Tick* ticks, size_t count) {
+    for (size_t k = 0; k < count; ++k) {
+        uint32_t s = ticks[k].symbol_id;
+        if (s >= spots_.size()) continue;
+        spots_[s] = ticks[k].price;
+        if (!dirty_[s]) {
+            dirty_[s] = 1;
+            dirty_symbols_.push_back(s);
+        }
+    }
+
+    uint64_t repriced = 0;
+    for (uint32_t s : dirty_symbols_) {
+        double move = spots_[s] / reference_spots_[s];
+        for (uint32_t j = dependent_offsets_[s]; j < dependent_offsets_[s + 1]; ++j) {
+            uint32_t i = dependents_[j];
+            Position& pos = positions_[i];
+            pos.price = base_prices_[i] * move;
+            greeks_[i] = reprice(pos);
+            repriced += (pos.type != PositionType::STOCK);
+        }
+        dirty_[s] = 0;
+    }
+    dirty_symbols_.clear();
+
+    uint64_t now = TscClock::now();
+    for (size_t k = 0; k < count; ++k) {
+        uint64_t published = ticks[k].publish_tsc;
+        latency_.record(now > published ? TscClock::to_ns(now - published) : 0);
+    }
+
+    ticks_processed_.fetch_add(count, std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    options_repriced_.fetch_add(repriced, std::memory_order_relaxed);
+}
+
+TickGeneratorResult run_synthetic_feed(MarketDataEngine& engine, size_t feed,
+                                       const TickGeneratorConfig& config) {
+    std::mt19937 rng(config.seed);
+    std::normal_distribution<double> move(0.0, config.tick_volatility);
+    std::uniform_int_distribution<uint32_t> symbol_dist(
+        0, static_cast<uint32_t>(engine.num_symbols() - 1));
+    std::vector<double> prices = engine.reference_spots();
+
+    TickGeneratorResult result{0, 0, 0.0};
+    if (prices.empty()) return result;
+
+    uint64_t total = static_cast<uint64_t>(config.ticks_per_second *
+                                           config.duration_seconds);
+    double interval_ns = 1e9 / config.ticks_per_second;
+    int64_t start = steady_now_ns();
+
+    for (uint64_t k = 0; k < total; ++k) {
+        int64_t due = start + static_cast<int64_t>(k * interval_ns);
+        int64_t now = steady_now_ns();
+        while (now < due) {
+            std::this_thread::yield();
+            now = steady_now_ns();
+        }
+
+        uint32_t s = symbol_dist(rng);
+        prices[s] *= 1.0 + move(rng);
+        if (engine.publish(feed, {s, prices[s], TscClock::now()})) {
+            ++result.published;
+        } else {
+            ++result.dropped;
+        }
+    }
+
+    result.elapsed_seconds = (steady_now_ns() - start) / 1e9;
+    return result;
+}
+
+}  // namespace trading
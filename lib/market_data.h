@@ -0,0 +1,134 @@
+#ifndef LIB_MARKET_DATA_H_
+#define LIB_MARKET_DATA_H_
+
+#include "lib/benchmark.h"
+#include "lib/greeks.h"
+#include "lib/position.h"
+#include "lib/ring_buffer.h"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace trading {
+
+struct Tick {
+    uint32_t symbol_id;
+    double price;
+    uint64_t publish_tsc;  // TscClock at publish, for tick-to-Greeks latency
+};
+
+struct MarketDataConfig {
+    size_t num_feeds = 1;           // One SPSC ring per feed
+    size_t ring_capacity = 1 << 16;
+    size_t batch_size = 256;        // Max ticks dequeued per ring per pass
+    int pricing_cpu = -1;           // Pin the pricing thread; -1 = unpinned
+    // Reprice with FastNormal instead of the PreciseNormal every other
+    // Greeks path uses; trades CDF accuracy for tick-to-Greeks latency.
+    bool fast_normal = false;
+};
+
+struct MarketDataStats {
+    uint64_t ticks_processed;
+    uint64_t batches;
+    uint64_t options_repriced;
+};
+
+// Streams spot updates into the book. Each feed owns an SPSC ring; ad-hoc
+// publishers share one MPSC ring. A single pricing thread drains all rings
+// in batches, applies the latest spot per symbol and reprices only the
+// positions on symbols that moved, once per batch. A symbol's reference
+// spot is the price of its first position in the book; every position on
+// the symbol moves by the same relative amount as the spot.
+class MarketDataEngine {
+public:
+    MarketDataEngine(std::vector<Position> positions, const MarketDataConfig& config);
+    ~MarketDataEngine();
+
+    MarketDataEngine(const MarketDataEngine&) = delete;
+    MarketDataEngine& operator=(const MarketDataEngine&) = delete;
+
+    // -1 if the symbol is not in the book.
+    int symbol_id(const std::string& symbol) const;
+    size_t num_symbols() const { return symbols_.size(); }
+    const SymbolTable& symbols() const { return symbols_; }
+    size_t num_feeds() const { return feeds_.size(); }
+    // Spots as loaded from the book; never updated, so safe to read while
+    // the pricing thread runs.
+    const std::vector<double>& reference_spots() const { return reference_spots_; }
+
+    // Each feed must have a single publishing thread.
+    bool publish(size_t feed, const Tick& tick);
+    // Safe from any thread.
+    bool publish_shared(const Tick& tick);
+
+    void start();
+    // Drains whatever is still queued, then joins the pricing thread.
+    void stop();
+    // One drain pass on the calling thread; only valid while stopped.
+    size_t poll();
+
+    // Only read these while the pricing thread is stopped.
+    const std::vector<Position>& positions() const { return positions_; }
+    const std::vector<Greeks>& greeks() const { return greeks_; }
+    double spot(int symbol_id) const { return spots_[symbol_id]; }
+    const LatencyHistogram& latency() const { return latency_; }
+
+    MarketDataStats stats() const;
+
+private:
+    size_t drain();
+    void process(const Tick* ticks, size_t count);
+    void pricing_loop();
+    Greeks reprice(const Position& pos) const;
+
+    std::vector<Position> positions_;
+    std::vector<Greeks> greeks_;
+    MarketDataConfig config_;
+
+    SymbolTable symbols_;
+    std::vector<double> reference_spots_;
+    std::vector<double> spots_;
+    // Positions per symbol in CSR form: dependents_[offsets_[s]..offsets_[s+1])
+    std::vector<uint32_t> dependent_offsets_;
+    std::vector<uint32_t> dependents_;
+    std::vector<double> base_prices_;  // Position price at reference spot
+    std::vector<uint8_t> dirty_;
+    std::vector<uint32_t> dirty_symbols_;
+
+    std::vector<std::unique_ptr<SpscRing<Tick>>> feeds_;
+    MpscRing<Tick> shared_;
+    std::vector<Tick> batch_;
+    LatencyHistogram latency_;
+
+    std::atomic<bool> running_{false};
+    std::thread pricing_thread_;
+    std::atomic<uint64_t> ticks_processed_{0};
+    std::atomic<uint64_t> batches_{0};
+    std::atomic<uint64_t> options_repriced_{0};
+};
+
+struct TickGeneratorConfig {
+    double ticks_per_second = 1e6;
+    double duration_seconds = 1.0;
+    double tick_volatility = 0.0005;  // Per-tick relative move
+    unsigned int seed = 42;
+};
+
+struct TickGeneratorResult {
+    uint64_t published;
+    uint64_t dropped;  // Ring full at the scheduled send time
+    double elapsed_seconds;
+};
+
+// Paced random-walk ticks over all symbols in the book, published on
+// `feed` from the calling thread.
+TickGeneratorResult run_synthetic_feed(MarketDataEngine& engine, size_t feed,
+                                       const TickGeneratorConfig& config);
+
+}  // namespace trading
+
+#endif  // LIB_MARKET_DATA_H_
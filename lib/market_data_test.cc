@@ -0,0 +1,103 @@
+#include "lib/market_data.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+std::vector<Position> two_symbol_book() {
+    return {
+        {.symbol = "AAPL", .quantity = 100, .price = 150.0, .volatility = 0.3,
+         .type = PositionType::STOCK, .strike = 0, .time_to_expiry = 0, .risk_free_rate = 0.05},
+        {.symbol = "AAPL", .quantity = 10, .price = 150.0, .volatility = 0.3,
+         .type = PositionType::OPTION_CALL, .strike = 155.0, .time_to_expiry = 0.5, .risk_free_rate = 0.05},
+        {.symbol = "MSFT", .quantity = -5, .price = 300.0, .volatility = 0.25,
+         .type = PositionType::OPTION_PUT, .strike = 290.0, .time_to_expiry = 1.0, .risk_free_rate = 0.05},
+    };
+}
+
+TEST(MarketDataTest, TickRepricesDependentsOnly) {
+    MarketDataEngine engine(two_symbol_book(), MarketDataConfig{});
+    int aapl = engine.symbol_id("AAPL");
+    ASSERT_GE(aapl, 0);
+    EXPECT_EQ(engine.symbol_id("GOOG"), -1);
+    Greeks msft_before = engine.greeks()[2];
+
+    ASSERT_TRUE(engine.publish(0, {static_cast<uint32_t>(aapl), 160.0, TscClock::now()}));
+    EXPECT_EQ(engine.poll(), 1u);
+
+    EXPECT_DOUBLE_EQ(engine.spot(aapl), 160.0);
+    EXPECT_DOUBLE_EQ(engine.positions()[0].price, 160.0);
+    EXPECT_DOUBLE_EQ(engine.greeks()[0].price, 160.0);
+
+    Position call = two_symbol_book()[1];
+    call.price = 160.0;
+    Greeks expected = calculate_greeks(call);
+    EXPECT_DOUBLE_EQ(engine.greeks()[1].price, expected.price);
+    EXPECT_DOUBLE_EQ(engine.greeks()[1].delta, expected.delta);
+
+    EXPECT_DOUBLE_EQ(engine.greeks()[2].price, msft_before.price);
+    EXPECT_EQ(engine.stats().options_repriced, 1u);
+    EXPECT_EQ(engine.latency().count(), 1u);
+}
+
+TEST(MarketDataTest, PositionsMoveRelativeToReferenceSpot) {
+    auto book = two_symbol_book();
+    book[1].price = 75.0;  // Recorded at a different spot than the stock
+    MarketDataEngine engine(book, MarketDataConfig{});
+
+    engine.publish_shared({static_cast<uint32_t>(engine.symbol_id("AAPL")), 165.0, 0});
+    engine.poll();
+
+    EXPECT_DOUBLE_EQ(engine.positions()[1].price, 75.0 * 1.1);
+}
+
+TEST(MarketDataTest, FastNormalIsOptIn) {
+    MarketDataConfig config;
+    config.fast_normal = true;
+    MarketDataEngine engine(two_symbol_book(), config);
+
+    engine.publish_shared({static_cast<uint32_t>(engine.symbol_id("AAPL")), 160.0, 0});
+    engine.poll();
+
+    Position call = two_symbol_book()[1];
+    call.price = 160.0;
+    EXPECT_DOUBLE_EQ(engine.greeks()[1].price, calculate_greeks<FastNormal>(call).price);
+    EXPECT_DOUBLE_EQ(engine.greeks()[1].delta, calculate_greeks<FastNormal>(call).delta);
+}
+
+TEST(MarketDataTest, PricingThreadAppliesLatestTick) {
+    MarketDataConfig config;
+    config.num_feeds = 2;
+    config.batch_size = 8;
+    MarketDataEngine engine(generate_random_positions(500), config);
+    engine.start();
+
+    TickGeneratorConfig gen;
+    gen.ticks_per_second = 50000;
+    gen.duration_seconds = 0.05;
+    auto result = run_synthetic_feed(engine, 1, gen);
+
+    // Feeds are not ordered against each other; let the generated ticks
+    // land before the final one.
+    while (engine.stats().ticks_processed < result.published) {
+        std::this_thread::yield();
+    }
+    uint32_t last_symbol = 3;
+    while (!engine.publish(0, {last_symbol, 123.0, TscClock::now()})) {
+        std::this_thread::yield();
+    }
+    engine.stop();
+
+    EXPECT_EQ(result.published + result.dropped, 2500u);
+    EXPECT_EQ(engine.stats().ticks_processed, result.published + 1);
+    EXPECT_DOUBLE_EQ(engine.spot(last_symbol), 123.0);
+    EXPECT_EQ(engine.latency().count(), result.published + 1);
+    for (const auto& g : engine.greeks()) {
+        EXPECT_TRUE(std::isfinite(g.price));
+    }
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,223 @@
+#include "lib/memory_stats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <fcntl.h>
+#endif
+
+namespace trading {
+
+namespace {
+
+std::atomic<bool> g_counting{false};
+std::atomic<bool> g_hook_installed{false};
+std::atomic<uint64_t> g_allocations{0};
+std::atomic<uint64_t> g_deallocations{0};
+std::atomic<uint64_t> g_bytes_allocated{0};
+
+// Reads /proc/self/statm with plain file descriptors: an ifstream would
+// allocate its buffer and show up in the phase being measured.
+size_t current_rss_kb() {
+#ifdef __linux__
+    int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd < 0) return 0;
+    char buf[128];
+    ssize_t len = read(fd, buf, sizeof(buf) - 1);
+    close(fd);
+    if (len <= 0) return 0;
+    buf[len] = '\0';
+    unsigned long total_pages = 0;
+    unsigned long resident_pages = 0;
+    if (std::sscanf(buf, "%lu %lu", &total_pages, &resident_pages) == 2) {
+        return resident_pages * static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+    }
+#endif
+    return 0;
+}
+
+// Runs fn(begin, end) over [0, total), one contiguous slice per thread.
+// The slices are the same for every call with the same arguments, so a
+// thread keeps touching the pages it first-touched.
+template <typename Fn>
+void for_each_slice(size_t total, int num_threads, Fn fn) {
+    size_t parts = static_cast<size_t>(std::max(num_threads, 1));
+    size_t chunk = (total + parts - 1) / parts;
+    std::vector<std::thread> threads;
+    threads.reserve(parts - 1);
+    for (size_t p = 1; p < parts; ++p) {
+        size_t begin = std::min(p * chunk, total);
+        size_t end = std::min(begin + chunk, total);
+        threads.emplace_back(fn, begin, end);
+    }
+    fn(size_t(0), std::min(chunk, total));
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+}  // namespace
+
+AllocationCounts allocation_counts() {
+    AllocationCounts counts;
+    counts.allocations = g_allocations.load(std::memory_order_relaxed);
+    counts.deallocations = g_deallocations.load(std::memory_order_relaxed);
+    counts.bytes_allocated = g_bytes_allocated.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void set_allocation_counting(bool enabled) {
+    g_counting.store(enabled, std::memory_order_relaxed);
+}
+
+bool allocation_counting_enabled() {
+    return g_counting.load(std::memory_order_relaxed);
+}
+
+bool allocation_hook_installed() {
+    return g_hook_installed.load(std::memory_order_relaxed);
+}
+
+void record_allocation(size_t bytes) {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_allocations.fetch_add(1, std::memory_order_relaxed);
+        g_bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+void record_deallocation() {
+    if (g_counting.load(std::memory_order_relaxed)) {
+        g_deallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void mark_allocation_hook_installed() {
+    g_hook_installed.store(true, std::memory_order_relaxed);
+}
+
+MemorySnapshot memory_snapshot() {
+    MemorySnapshot snapshot;
+#if defined(__linux__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        snapshot.peak_rss_kb = static_cast<size_t>(usage.ru_maxrss) / 1024;  // bytes
+#else
+        snapshot.peak_rss_kb = static_cast<size_t>(usage.ru_maxrss);  // KB
+#endif
+        snapshot.minor_faults = static_cast<uint64_t>(usage.ru_minflt);
+        snapshot.major_faults = static_cast<uint64_t>(usage.ru_majflt);
+    }
+#endif
+    snapshot.current_rss_kb = current_rss_kb();
+    snapshot.heap = allocation_counts();
+    return snapshot;
+}
+
+PhaseMemory diff_memory(const MemorySnapshot& before, const MemorySnapshot& after,
+                        double elapsed_ms, double bytes_moved) {
+    PhaseMemory phase;
+    phase.elapsed_ms = elapsed_ms;
+    phase.peak_rss_kb = after.peak_rss_kb;
+    phase.peak_rss_growth_kb = after.peak_rss_kb > before.peak_rss_kb
+                                   ? after.peak_rss_kb - before.peak_rss_kb : 0;
+    phase.rss_change_kb = static_cast<int64_t>(after.current_rss_kb) -
+                          static_cast<int64_t>(before.current_rss_kb);
+    phase.minor_faults = after.minor_faults - before.minor_faults;
+    phase.major_faults = after.major_faults - before.major_faults;
+    phase.allocations = after.heap.allocations - before.heap.allocations;
+    phase.bytes_allocated = after.heap.bytes_allocated - before.heap.bytes_allocated;
+    phase.bytes_moved = bytes_moved;
+    return phase;
+}
+
+double StreamResult::peak_gbps() const {
+    return std::max({copy_gbps, scale_gbps, add_gbps, triad_gbps});
+}
+
+StreamResult run_stream_probe(const StreamConfig& config) {
+    const size_t n = std::max<size_t>(config.array_elements, 1);
+    const int threads = std::max(config.num_threads, 1);
+    const int repetitions = std::max(config.repetitions, 1);
+    const double scalar = 3.0;
+
+    // Uninitialized storage, so the first touch happens below on the
+    // thread that owns each slice.
+    std::unique_ptr<double[]> a_buf(new double[n]);
+    std::unique_ptr<double[]> b_buf(new double[n]);
+    std::unique_ptr<double[]> c_buf(new double[n]);
+    double* a = a_buf.get();
+    double* b = b_buf.get();
+    double* c = c_buf.get();
+    for_each_slice(n, threads, [=](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; ++j) {
+            a[j] = 1.0;
+            b[j] = 2.0;
+            c[j] = 0.0;
+        }
+    });
+
+    auto best_ms = [&](double* best, auto kernel) {
+        Timer timer;
+        for_each_slice(n, threads, kernel);
+        *best = std::min(*best, timer.elapsed_ms());
+    };
+
+    double copy_ms = 1e300, scale_ms = 1e300, add_ms = 1e300, triad_ms = 1e300;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        best_ms(&copy_ms, [=](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) c[j] = a[j];
+        });
+        best_ms(&scale_ms, [=](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) b[j] = scalar * c[j];
+        });
+        best_ms(&add_ms, [=](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) c[j] = a[j] + b[j];
+        });
+        best_ms(&triad_ms, [=](size_t begin, size_t end) {
+            for (size_t j = begin; j < end; ++j) a[j] = b[j] + scalar * c[j];
+        });
+    }
+
+    StreamResult result;
+    result.array_bytes = n * sizeof(double);
+    double two_arrays = 2.0 * result.array_bytes;
+    double three_arrays = 3.0 * result.array_bytes;
+    result.copy_gbps = two_arrays / (copy_ms * 1e6);
+    result.scale_gbps = two_arrays / (scale_ms * 1e6);
+    result.add_gbps = three_arrays / (add_ms * 1e6);
+    result.triad_gbps = three_arrays / (triad_ms * 1e6);
+
+    // Replay the sequence on scalars and check every element against it.
+    double expect_a = 1.0, expect_b = 2.0, expect_c = 0.0;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        expect_c = expect_a;
+        expect_b = scalar * expect_c;
+        expect_c = expect_a + expect_b;
+        expect_a = expect_b + scalar * expect_c;
+    }
+    auto close = [](double actual, double expected) {
+        return std::abs(actual - expected) <= 1e-13 * std::abs(expected);
+    };
+    result.validated = true;
+    for (size_t j = 0; j < n; ++j) {
+        if (!close(a[j], expect_a) || !close(b[j], expect_b) || !close(c[j], expect_c)) {
+            result.validated = false;
+            break;
+        }
+    }
+    return result;
+}
+
+}  // namespace trading
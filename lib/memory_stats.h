@@ -0,0 +1,106 @@
+#ifndef LIB_MEMORY_STATS_H_
+#define LIB_MEMORY_STATS_H_
+
+#include "lib/benchmark.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace trading {
+
+// Process-wide heap allocation counters. They only move while counting is
+// enabled and a binary links the :counting_allocator hook, which replaces
+// the global operator new/delete; without it they stay at zero.
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t deallocations = 0;
+    uint64_t bytes_allocated = 0;
+};
+
+AllocationCounts allocation_counts();
+void set_allocation_counting(bool enabled);
+bool allocation_counting_enabled();
+// True when the replacement operator new is linked into this binary.
+bool allocation_hook_installed();
+
+// Called by the hook; not meant to be used directly.
+void record_allocation(size_t bytes);
+void record_deallocation();
+void mark_allocation_hook_installed();
+
+// Resident set size and page faults of the whole process (getrusage and
+// /proc/self/statm), plus the allocation counters at the same moment.
+struct MemorySnapshot {
+    size_t peak_rss_kb = 0;
+    size_t current_rss_kb = 0;
+    uint64_t minor_faults = 0;
+    uint64_t major_faults = 0;
+    AllocationCounts heap;
+};
+
+MemorySnapshot memory_snapshot();
+
+// What one phase cost in memory terms. bytes_moved is the caller's
+// estimate of the kernel's compulsory traffic (arrays read plus arrays
+// written), which turns elapsed time into achieved bandwidth.
+struct PhaseMemory {
+    double elapsed_ms = 0.0;
+    size_t peak_rss_kb = 0;
+    size_t peak_rss_growth_kb = 0;
+    int64_t rss_change_kb = 0;
+    uint64_t minor_faults = 0;
+    uint64_t major_faults = 0;
+    uint64_t allocations = 0;
+    uint64_t bytes_allocated = 0;
+    double bytes_moved = 0.0;
+
+    double bandwidth_gbps() const {
+        return elapsed_ms > 0.0 ? bytes_moved / (elapsed_ms * 1e6) : 0.0;
+    }
+};
+
+PhaseMemory diff_memory(const MemorySnapshot& before, const MemorySnapshot& after,
+                        double elapsed_ms, double bytes_moved);
+
+// Runs fn() once with allocation counting on and reports the difference.
+// Counting is restored to its previous state afterwards.
+template <typename Fn>
+PhaseMemory measure_phase(Fn&& fn, double bytes_moved = 0.0) {
+    bool was_counting = allocation_counting_enabled();
+    set_allocation_counting(true);
+    MemorySnapshot before = memory_snapshot();
+    Timer timer;
+    fn();
+    double elapsed_ms = timer.elapsed_ms();
+    MemorySnapshot after = memory_snapshot();
+    set_allocation_counting(was_counting);
+    return diff_memory(before, after, elapsed_ms, bytes_moved);
+}
+
+// STREAM-style sustainable bandwidth probe (McCalpin's copy, scale, add
+// and triad over three double arrays). Each thread first-touches and then
+// works on its own slice, and every kernel keeps its best repetition.
+// Bytes are counted as STREAM does: 16 per element for copy and scale,
+// 24 for add and triad, without write-allocate traffic.
+struct StreamConfig {
+    size_t array_elements = size_t(1) << 23;  // 64 MB per array
+    int num_threads = 1;
+    int repetitions = 5;
+};
+
+struct StreamResult {
+    double copy_gbps = 0.0;
+    double scale_gbps = 0.0;
+    double add_gbps = 0.0;
+    double triad_gbps = 0.0;
+    size_t array_bytes = 0;
+    bool validated = false;  // Final array contents match the closed form
+
+    double peak_gbps() const;
+};
+
+StreamResult run_stream_probe(const StreamConfig& config);
+
+}  // namespace trading
+
+#endif  // LIB_MEMORY_STATS_H_
@@ -0,0 +1,72 @@
+#include "lib/memory_stats.h"
+
+#include <gtest/gtest.h>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+namespace trading {
+namespace {
+
+TEST(MemoryStatsTest, HookCountsAllocationsOnlyWhileCounting) {
+    ASSERT_TRUE(allocation_hook_installed());
+
+    AllocationCounts before = allocation_counts();
+    { std::vector<int> idle(1000); }
+    EXPECT_EQ(allocation_counts().allocations, before.allocations);
+
+    PhaseMemory phase = measure_phase([]() {
+        std::vector<char> buffer(1 << 20);
+        auto extra = std::make_unique<double[]>(16);
+        buffer[0] = static_cast<char>(extra[0]);
+    });
+    EXPECT_EQ(phase.allocations, 2u);
+    EXPECT_EQ(phase.bytes_allocated, (1u << 20) + 16 * sizeof(double));
+    EXPECT_FALSE(allocation_counting_enabled());
+    EXPECT_GE(phase.elapsed_ms, 0.0);
+
+    AllocationCounts after = allocation_counts();
+    EXPECT_EQ(after.deallocations - before.deallocations, 2u);
+}
+
+TEST(MemoryStatsTest, TouchingFreshPagesShowsUpAsFaultsAndRss) {
+    const size_t kBytes = 64u << 20;
+    std::unique_ptr<char[]> block;
+    PhaseMemory phase = measure_phase([&]() {
+        block.reset(new char[kBytes]);
+        std::memset(block.get(), 1, kBytes);
+    });
+    EXPECT_GT(phase.peak_rss_kb, 0u);
+    EXPECT_GE(phase.rss_change_kb, static_cast<int64_t>(kBytes / 1024 / 2));
+    EXPECT_GT(phase.minor_faults, 0u);
+    EXPECT_EQ(phase.bytes_allocated, kBytes);
+}
+
+TEST(MemoryStatsTest, BandwidthFromBytesMoved) {
+    PhaseMemory phase;
+    phase.elapsed_ms = 2.0;
+    phase.bytes_moved = 8e9;
+    EXPECT_DOUBLE_EQ(phase.bandwidth_gbps(), 4000.0);
+    phase.elapsed_ms = 0.0;
+    EXPECT_EQ(phase.bandwidth_gbps(), 0.0);
+}
+
+TEST(MemoryStatsTest, StreamProbeValidatesAndReportsBandwidth) {
+    for (int threads : {1, 3}) {
+        StreamConfig config;
+        config.array_elements = 100003;
+        config.num_threads = threads;
+        config.repetitions = 3;
+        StreamResult result = run_stream_probe(config);
+        EXPECT_TRUE(result.validated);
+        EXPECT_EQ(result.array_bytes, 100003 * sizeof(double));
+        EXPECT_GT(result.copy_gbps, 0.0);
+        EXPECT_GT(result.scale_gbps, 0.0);
+        EXPECT_GT(result.add_gbps, 0.0);
+        EXPECT_GT(result.triad_gbps, 0.0);
+        EXPECT_GE(result.peak_gbps(), result.triad_gbps);
+    }
+}
+
+}  // namespace
+}  // namespace trading
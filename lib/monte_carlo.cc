@@ -1,53 +1,93 @@
 #include "lib/monte_carlo.h"
 
+#include "lib/reduction.h"
+
 #include <algorithm>
 #include <cmath>
-#include <numeric>
 #include <random>
 #include <thread>
 #include <vector>
 
 namespace trading {
 
+template <typename T>
+McInputsT<T> prepare_mc_inputs(const std::vector<Position>& positions,
+                               double time_horizon) {
+    McInputsT<T> inputs;
+    inputs.drift.resize(positions.size());
+    inputs.vol_sqrt_t.resize(positions.size());
+    inputs.notional.resize(positions.size());
+
+    double sqrt_t = std::sqrt(time_horizon);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        GbmTerms terms = gbm_terms(positions[i], time_horizon, sqrt_t);
+        inputs.drift[i] = static_cast<T>(terms.drift);
+        inputs.vol_sqrt_t[i] = static_cast<T>(terms.vol_sqrt_t);
+        inputs.notional[i] = static_cast<T>(terms.notional);
+    }
+    return inputs;
+}
+
+template <typename T>
 std::vector<double> simulate_portfolio_pnl(
-    const std::vector<Position>& positions,
+    const McInputsT<T>& inputs,
     size_t num_simulations,
-    double time_horizon,
     unsigned int seed) {
+    std::vector<double> pnl_values(num_simulations);
+    simulate_portfolio_pnl(inputs, num_simulations, seed, pnl_values.data());
+    return pnl_values;
+}
+
+template <typename T>
+void simulate_portfolio_pnl(
+    const McInputsT<T>& inputs,
+    size_t num_simulations,
+    unsigned int seed,
+    double* pnl_values) {
 
     std::mt19937 rng(seed);
     std::normal_distribution<double> normal(0.0, 1.0);
 
-    std::vector<double> pnl_values(num_simulations);
+    size_t n = inputs.notional.size();
+    const T* drift = inputs.drift.data();
+    const T* vol_sqrt_t = inputs.vol_sqrt_t.data();
+    const T* notional = inputs.notional.data();
 
     for (size_t sim = 0; sim < num_simulations; ++sim) {
         double portfolio_pnl = 0.0;
 
-        for (const auto& pos : positions) {
-            double z = normal(rng);
-            double drift = (pos.risk_free_rate - 0.5 * pos.volatility * pos.volatility) * time_horizon;
-            double diffusion = pos.volatility * std::sqrt(time_horizon) * z;
-            double price_change_factor = std::exp(drift + diffusion);
-            double new_price = pos.price * price_change_factor;
-            double position_pnl = pos.quantity * (new_price - pos.price);
-            portfolio_pnl += position_pnl;
+        for (size_t i = 0; i < n; ++i) {
+            T z = static_cast<T>(normal(rng));
+            T price_change_factor = std::exp(drift[i] + vol_sqrt_t[i] * z);
+            portfolio_pnl += notional[i] * (price_change_factor - T(1));
         }
 
         pnl_values[sim] = portfolio_pnl;
     }
+}
 
-    return pnl_values;
+std::vector<double> simulate_portfolio_pnl(
+    const std::vector<Position>& positions,
+    size_t num_simulations,
+    double time_horizon,
+    unsigned int seed) {
+    return simulate_portfolio_pnl(prepare_mc_inputs(positions, time_horizon),
+                                  num_simulations, seed);
 }
 
 VaRResult calculate_var(const std::vector<double>& pnl_values) {
-    if (pnl_values.empty()) {
+    std::vector<double> sorted_pnl(pnl_values.size());
+    return calculate_var(pnl_values.data(), pnl_values.size(), sorted_pnl.data());
+}
+
+VaRResult calculate_var(const double* pnl_values, size_t n, double* sorted_pnl) {
+    if (n == 0) {
         return {0.0, 0.0, 0.0, 0.0, 0.0};
     }
 
-    std::vector<double> sorted_pnl = pnl_values;
-    std::sort(sorted_pnl.begin(), sorted_pnl.end());
+    std::copy(pnl_values, pnl_values + n, sorted_pnl);
+    std::sort(sorted_pnl, sorted_pnl + n);
 
-    size_t n = sorted_pnl.size();
     size_t idx_95 = static_cast<size_t>(n * 0.05);
     size_t idx_99 = static_cast<size_t>(n * 0.01);
 
@@ -55,41 +95,49 @@ VaRResult calculate_var(const std::vector<double>& pnl_values) {
     result.var_95 = -sorted_pnl[idx_95];
     result.var_99 = -sorted_pnl[idx_99];
 
-    double es_sum = 0.0;
-    for (size_t i = 0; i <= idx_99; ++i) {
-        es_sum += sorted_pnl[i];
-    }
-    result.expected_shortfall = -es_sum / (idx_99 + 1);
+    result.expected_shortfall =
+        -reduce_sum(sorted_pnl, idx_99 + 1, Summation::NEUMAIER) / (idx_99 + 1);
 
-    double sum = std::accumulate(pnl_values.begin(), pnl_values.end(), 0.0);
-    result.mean_pnl = sum / n;
+    result.mean_pnl = reduce_sum(pnl_values, n, Summation::NEUMAIER) / n;
 
-    double sq_sum = 0.0;
-    for (double pnl : pnl_values) {
-        sq_sum += (pnl - result.mean_pnl) * (pnl - result.mean_pnl);
+    NeumaierSum sq_sum;
+    for (size_t i = 0; i < n; ++i) {
+        sq_sum.add((pnl_values[i] - result.mean_pnl) * (pnl_values[i] - result.mean_pnl));
     }
-    result.std_pnl = std::sqrt(sq_sum / n);
+    result.std_pnl = std::sqrt(sq_sum.value() / n);
 
     return result;
 }
 
+template <typename T>
 VaRResult run_monte_carlo_single(
     const std::vector<Position>& positions,
     size_t num_simulations,
     double time_horizon,
     unsigned int seed) {
 
-    auto pnl_values = simulate_portfolio_pnl(positions, num_simulations,
-                                              time_horizon, seed);
+    auto pnl_values = simulate_portfolio_pnl(prepare_mc_inputs<T>(positions, time_horizon),
+                                             num_simulations, seed);
     return calculate_var(pnl_values);
 }
 
+template <typename T>
 VaRResult run_monte_carlo_multi(
     const std::vector<Position>& positions,
     size_t num_simulations,
     double time_horizon,
     int num_threads,
     unsigned int seed) {
+    return run_monte_carlo_multi(prepare_mc_inputs<T>(positions, time_horizon),
+                                 num_simulations, num_threads, seed);
+}
+
+template <typename T>
+VaRResult run_monte_carlo_multi(
+    const McInputsT<T>& inputs,
+    size_t num_simulations,
+    int num_threads,
+    unsigned int seed) {
 
     std::vector<std::vector<double>> thread_results(num_threads);
     std::vector<std::thread> threads;
@@ -100,7 +148,7 @@ VaRResult run_monte_carlo_multi(
     auto worker = [&](int thread_id, size_t num_sims) {
         unsigned int thread_seed = seed + thread_id * 12345;
         thread_results[thread_id] = simulate_portfolio_pnl(
-            positions, num_sims, time_horizon, thread_seed);
+            inputs, num_sims, thread_seed);
     };
 
     for (int t = 0; t < num_threads; ++t) {
@@ -121,4 +169,27 @@ VaRResult run_monte_carlo_multi(
     return calculate_var(all_pnl);
 }
 
+template McInputs prepare_mc_inputs<double>(const std::vector<Position>&, double);
+template McInputsT<float> prepare_mc_inputs<float>(const std::vector<Position>&, double);
+template std::vector<double> simulate_portfolio_pnl<double>(
+    const McInputs&, size_t, unsigned int);
+template std::vector<double> simulate_portfolio_pnl<float>(
+    const McInputsT<float>&, size_t, unsigned int);
+template void simulate_portfolio_pnl<double>(
+    const McInputs&, size_t, unsigned int, double*);
+template void simulate_portfolio_pnl<float>(
+    const McInputsT<float>&, size_t, unsigned int, double*);
+template VaRResult run_monte_carlo_single<double>(
+    const std::vector<Position>&, size_t, double, unsigned int);
+template VaRResult run_monte_carlo_single<float>(
+    const std::vector<Position>&, size_t, double, unsigned int);
+template VaRResult run_monte_carlo_multi<double>(
+    const std::vector<Position>&, size_t, double, int, unsigned int);
+template VaRResult run_monte_carlo_multi<float>(
+    const std::vector<Position>&, size_t, double, int, unsigned int);
+template VaRResult run_monte_carlo_multi<double>(
+    const McInputs&, size_t, int, unsigned int);
+template VaRResult run_monte_carlo_multi<float>(
+    const McInputsT<float>&, size_t, int, unsigned int);
+
 }  // namespace trading
@@ -15,6 +15,56 @@ struct VaRResult {
     double std_pnl;
 };
 
+// GBM coefficients for one horizon, hoisted out of the simulation loop:
+// price factor = exp(drift + vol_sqrt_t * z), P&L = notional * (factor - 1).
+// T is the precision the per-position terms are computed in.
+template <typename T>
+struct McInputsT {
+    std::vector<T> drift;
+    std::vector<T> vol_sqrt_t;
+    std::vector<T> notional;
+};
+
+using McInputs = McInputsT<double>;
+
+// One position's GBM coefficients in double. Every path that fills
+// McInputs (prepare_mc_inputs, the fused risk pipeline, incremental VaR)
+// goes through this, so they agree bit for bit.
+struct GbmTerms {
+    double drift;
+    double vol_sqrt_t;
+    double notional;
+};
+
+inline GbmTerms gbm_terms(const Position& pos, double time_horizon, double sqrt_t) {
+    return {(pos.risk_free_rate - 0.5 * pos.volatility * pos.volatility) * time_horizon,
+            pos.volatility * sqrt_t,
+            pos.quantity * pos.price};
+}
+
+// Coefficients are computed in double and then rounded to T.
+template <typename T = double>
+McInputsT<T> prepare_mc_inputs(const std::vector<Position>& positions,
+                               double time_horizon);
+
+// Each scenario's per-position terms are evaluated in T and summed into a
+// double P&L. Both precisions consume the same normal draws for a given
+// seed, so their P&L vectors differ only by rounding. Instantiated for
+// float and double.
+template <typename T>
+std::vector<double> simulate_portfolio_pnl(
+    const McInputsT<T>& inputs,
+    size_t num_simulations,
+    unsigned int seed);
+
+// Same, into out[0, num_simulations).
+template <typename T>
+void simulate_portfolio_pnl(
+    const McInputsT<T>& inputs,
+    size_t num_simulations,
+    unsigned int seed,
+    double* out);
+
 std::vector<double> simulate_portfolio_pnl(
     const std::vector<Position>& positions,
     size_t num_simulations,
@@ -23,12 +73,17 @@ std::vector<double> simulate_portfolio_pnl(
 
 VaRResult calculate_var(const std::vector<double>& pnl_values);
 
+// Same, sorting a copy in scratch[0, count) instead of allocating one.
+VaRResult calculate_var(const double* pnl_values, size_t count, double* scratch);
+
+template <typename T = double>
 VaRResult run_monte_carlo_single(
     const std::vector<Position>& positions,
     size_t num_simulations,
     double time_horizon,
     unsigned int seed = 42);
 
+template <typename T = double>
 VaRResult run_monte_carlo_multi(
     const std::vector<Position>& positions,
     size_t num_simulations,
@@ -36,6 +91,13 @@ VaRResult run_monte_carlo_multi(
     int num_threads,
     unsigned int seed = 42);
 
+template <typename T>
+VaRResult run_monte_carlo_multi(
+    const McInputsT<T>& inputs,
+    size_t num_simulations,
+    int num_threads,
+    unsigned int seed = 42);
+
 }  // namespace trading
 
 #endif  // LIB_MONTE_CARLO_H_
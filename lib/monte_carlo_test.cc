@@ -53,5 +53,42 @@ TEST(MonteCarloTest, DeterministicSingleThread) {
     EXPECT_EQ(result1.var_99, result2.var_99);
 }
 
+TEST(MonteCarloTest, FloatKernelsTrackDoubleScenarioByScenario) {
+    auto positions = generate_random_positions(200, 42);
+    auto reference = simulate_portfolio_pnl(prepare_mc_inputs(positions, 1.0/252.0),
+                                            5000, 7);
+    auto reduced = simulate_portfolio_pnl(prepare_mc_inputs<float>(positions, 1.0/252.0),
+                                          5000, 7);
+    ASSERT_EQ(reduced.size(), reference.size());
+
+    // Same draws, so the only difference is float rounding of each term.
+    double gross = 0.0;
+    for (const auto& pos : positions) {
+        gross += std::abs(pos.quantity * pos.price);
+    }
+    double max_error = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        max_error = std::max(max_error, std::abs(reduced[i] - reference[i]));
+    }
+    EXPECT_LT(max_error, gross * 1e-6);
+
+    // An order statistic, and a tail mean, moves by at most the largest
+    // per-scenario change.
+    VaRResult var_double = calculate_var(reference);
+    VaRResult var_float = calculate_var(reduced);
+    EXPECT_LE(std::abs(var_float.var_99 - var_double.var_99), max_error);
+    EXPECT_LE(std::abs(var_float.var_95 - var_double.var_95), max_error);
+    EXPECT_LE(std::abs(var_float.expected_shortfall - var_double.expected_shortfall),
+              max_error);
+    EXPECT_LT(std::abs(var_float.var_99 - var_double.var_99), var_double.var_99 * 1e-4);
+
+    // The threaded engines draw per-thread streams, so only a relative bound
+    // carries over to them.
+    auto multi_double = run_monte_carlo_multi(positions, 5000, 1.0/252.0, 3, 7);
+    auto multi_float = run_monte_carlo_multi<float>(positions, 5000, 1.0/252.0, 3, 7);
+    EXPECT_LT(std::abs(multi_float.var_99 - multi_double.var_99),
+              multi_double.var_99 * 1e-4);
+}
+
 }  // namespace
 }  // namespace trading
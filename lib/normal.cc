@@ -0,0 +1,28 @@
+#include "lib/normal.h"
+
+namespace trading {
+
+template <typename Policy, typename T>
+void normal_cdf_batch(const T* x, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = Policy::cdf(x[i]);
+    }
+}
+
+template <typename Policy, typename T>
+void normal_pdf_batch(const T* x, T* out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        out[i] = Policy::pdf(x[i]);
+    }
+}
+
+template void normal_cdf_batch<PreciseNormal, double>(const double*, double*, size_t);
+template void normal_cdf_batch<PreciseNormal, float>(const float*, float*, size_t);
+template void normal_cdf_batch<FastNormal, double>(const double*, double*, size_t);
+template void normal_cdf_batch<FastNormal, float>(const float*, float*, size_t);
+template void normal_pdf_batch<PreciseNormal, double>(const double*, double*, size_t);
+template void normal_pdf_batch<PreciseNormal, float>(const float*, float*, size_t);
+template void normal_pdf_batch<FastNormal, double>(const double*, double*, size_t);
+template void normal_pdf_batch<FastNormal, float>(const float*, float*, size_t);
+
+}  // namespace trading
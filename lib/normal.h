@@ -0,0 +1,127 @@
+#ifndef LIB_NORMAL_H_
+#define LIB_NORMAL_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace trading {
+
+// Standard normal CDF/PDF policies. Kernels take one of these as a template
+// parameter so the precision/speed trade-off is fixed at compile time.
+
+namespace normal_detail {
+
+constexpr double kInvSqrt2Pi = 0.39894228040143267794;
+constexpr double kSqrt1_2 = 0.70710678118654752440;
+constexpr double kLog2e = 1.44269504088896340736;
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+
+// Branch-free exp: Cody-Waite range reduction, a polynomial on
+// |r| <= ln2/2 and the exponent written directly into the result bits.
+// Relative error is a few ulp; inputs are clamped to the normal range.
+inline double fast_exp(double x) {
+    constexpr double kShift = 6755399441055744.0;  // 1.5 * 2^52
+    x = std::min(std::max(x, -708.0), 709.0);
+    double t = x * kLog2e + kShift;
+    double k = t - kShift;
+    double r = x - k * kLn2Hi - k * kLn2Lo;
+
+    double p = 1.0 / 479001600.0;
+    p = p * r + 1.0 / 39916800.0;
+    p = p * r + 1.0 / 3628800.0;
+    p = p * r + 1.0 / 362880.0;
+    p = p * r + 1.0 / 40320.0;
+    p = p * r + 1.0 / 5040.0;
+    p = p * r + 1.0 / 720.0;
+    p = p * r + 1.0 / 120.0;
+    p = p * r + 1.0 / 24.0;
+    p = p * r + 1.0 / 6.0;
+    p = p * r + 0.5;
+    p = p * r + 1.0;
+    p = p * r + 1.0;
+
+    int64_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    int64_t scale_bits = (bits - 0x4338000000000000LL + 1023) << 52;
+    double scale;
+    std::memcpy(&scale, &scale_bits, sizeof(scale));
+    return p * scale;
+}
+
+inline float fast_exp(float x) {
+    constexpr float kShift = 12582912.0f;  // 1.5 * 2^23
+    x = std::min(std::max(x, -87.0f), 88.0f);
+    float t = x * static_cast<float>(kLog2e) + kShift;
+    float k = t - kShift;
+    float r = x - k * 0.693145751953125f - k * 1.428606765330187e-06f;
+
+    float p = 1.0f / 5040.0f;
+    p = p * r + 1.0f / 720.0f;
+    p = p * r + 1.0f / 120.0f;
+    p = p * r + 1.0f / 24.0f;
+    p = p * r + 1.0f / 6.0f;
+    p = p * r + 0.5f;
+    p = p * r + 1.0f;
+    p = p * r + 1.0f;
+
+    int32_t bits;
+    std::memcpy(&bits, &t, sizeof(bits));
+    int32_t scale_bits = (bits - 0x4B400000 + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &scale_bits, sizeof(scale));
+    return p * scale;
+}
+
+}  // namespace normal_detail
+
+// Full precision via libm erfc/exp.
+struct PreciseNormal {
+    template <typename T>
+    static T cdf(T x) {
+        return T(0.5) * std::erfc(-x * T(normal_detail::kSqrt1_2));
+    }
+
+    template <typename T>
+    static T pdf(T x) {
+        return T(normal_detail::kInvSqrt2Pi) * std::exp(T(-0.5) * x * x);
+    }
+};
+
+// Abramowitz-Stegun 26.2.17 rational approximation (|error| < 7.5e-8) on
+// top of the branch-free exp, so loops over it vectorize.
+struct FastNormal {
+    template <typename T>
+    static T cdf(T x) {
+        T ax = std::abs(x);
+        T t = T(1) / (T(1) + T(0.2316419) * ax);
+        T poly = T(1.330274429);
+        poly = poly * t + T(-1.821255978);
+        poly = poly * t + T(1.781477937);
+        poly = poly * t + T(-0.356563782);
+        poly = poly * t + T(0.319381530);
+        T tail = pdf(ax) * poly * t;
+        return T(0.5) + std::copysign(T(0.5) - tail, x);
+    }
+
+    template <typename T>
+    static T pdf(T x) {
+        return T(normal_detail::kInvSqrt2Pi) *
+               normal_detail::fast_exp(T(-0.5) * x * x);
+    }
+};
+
+// Batch evaluation over contiguous arrays. Instantiated for both policies
+// with float and double.
+template <typename Policy, typename T>
+void normal_cdf_batch(const T* x, T* out, size_t n);
+
+template <typename Policy, typename T>
+void normal_pdf_batch(const T* x, T* out, size_t n);
+
+}  // namespace trading
+
+#endif  // LIB_NORMAL_H_
@@ -0,0 +1,98 @@
+#include "lib/normal.h"
+
+#include "lib/greeks.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace trading {
+namespace {
+
+// Exhaustive sweep over [-12, 12] in 1e-5 steps.
+std::vector<double> sweep_points() {
+    std::vector<double> xs;
+    for (long i = -1200000; i <= 1200000; ++i) {
+        xs.push_back(i * 1e-5);
+    }
+    return xs;
+}
+
+TEST(NormalTest, PreciseMatchesLibm) {
+    EXPECT_EQ(PreciseNormal::cdf(0.0), 0.5);
+    EXPECT_NEAR(PreciseNormal::cdf(1.96), 0.9750021048517795, 1e-15);
+    EXPECT_NEAR(PreciseNormal::pdf(0.0), 0.3989422804014327, 1e-16);
+    EXPECT_NEAR(PreciseNormal::pdf(1.0), std::exp(-0.5) / std::sqrt(2.0 * M_PI),
+                1e-16);
+}
+
+TEST(NormalTest, FastCdfAccuracySweep) {
+    auto xs = sweep_points();
+    double max_error = 0.0;
+    for (double x : xs) {
+        max_error = std::max(max_error,
+                             std::abs(FastNormal::cdf(x) - PreciseNormal::cdf(x)));
+    }
+    EXPECT_LT(max_error, 1e-7);
+}
+
+TEST(NormalTest, FastPdfAccuracySweep) {
+    auto xs = sweep_points();
+    double max_rel_error = 0.0;
+    for (double x : xs) {
+        double precise = PreciseNormal::pdf(x);
+        max_rel_error = std::max(
+            max_rel_error, std::abs(FastNormal::pdf(x) - precise) / precise);
+    }
+    EXPECT_LT(max_rel_error, 1e-13);
+}
+
+TEST(NormalTest, FloatAccuracySweep) {
+    auto xs = sweep_points();
+    double max_cdf_error = 0.0;
+    double max_pdf_error = 0.0;
+    for (double x : xs) {
+        float xf = static_cast<float>(x);
+        max_cdf_error = std::max(max_cdf_error,
+            std::abs(FastNormal::cdf(xf) - PreciseNormal::cdf(static_cast<double>(xf))));
+        max_pdf_error = std::max(max_pdf_error,
+            std::abs(FastNormal::pdf(xf) - PreciseNormal::pdf(static_cast<double>(xf))));
+    }
+    EXPECT_LT(max_cdf_error, 5e-7);
+    EXPECT_LT(max_pdf_error, 1e-7);
+}
+
+TEST(NormalTest, BatchMatchesScalar) {
+    auto xs = sweep_points();
+    std::vector<double> cdf(xs.size());
+    std::vector<double> pdf(xs.size());
+
+    normal_cdf_batch<FastNormal>(xs.data(), cdf.data(), xs.size());
+    normal_pdf_batch<FastNormal>(xs.data(), pdf.data(), xs.size());
+
+    for (size_t i = 0; i < xs.size(); i += 997) {
+        EXPECT_NEAR(cdf[i], FastNormal::cdf(xs[i]), 1e-15);
+        EXPECT_NEAR(pdf[i], FastNormal::pdf(xs[i]), 1e-15);
+    }
+
+    normal_cdf_batch<PreciseNormal>(xs.data(), cdf.data(), xs.size());
+    for (size_t i = 0; i < xs.size(); i += 997) {
+        EXPECT_EQ(cdf[i], PreciseNormal::cdf(xs[i]));
+    }
+}
+
+TEST(NormalTest, FastGreeksCloseToPrecise) {
+    auto positions = generate_random_positions(200, 42);
+
+    auto precise = calculate_all_greeks_single<PreciseNormal>(positions);
+    auto fast = calculate_all_greeks_single<FastNormal>(positions);
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        double scale = positions[i].price;
+        EXPECT_NEAR(fast[i].price, precise[i].price, 1e-6 * scale);
+        EXPECT_NEAR(fast[i].delta, precise[i].delta, 1e-4);
+    }
+}
+
+}  // namespace
+}  // namespace trading
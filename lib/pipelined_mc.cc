@@ -0,0 +1,193 @@
+#include "lib/pipelined_mc.h"
+
+#include "lib/random.h"
+#include "lib/ring_buffer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+
+namespace trading {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// Pops from `ring`, yielding while it is empty. Time spent waiting is
+// added to *stalled; the clock is only read when the first try fails.
+size_t pop_waiting(MpmcRing<size_t>& ring, double* stalled) {
+    size_t slot;
+    if (ring.try_pop(slot)) return slot;
+    auto wait_start = Clock::now();
+    while (!ring.try_pop(slot)) {
+        std::this_thread::yield();
+    }
+    *stalled += seconds_since(wait_start);
+    return slot;
+}
+
+void push_waiting(MpmcRing<size_t>& ring, size_t slot) {
+    while (!ring.try_push(slot)) {
+        std::this_thread::yield();
+    }
+}
+
+struct ThreadTime {
+    double elapsed = 0.0;
+    double stalled = 0.0;
+};
+
+double stall_fraction(const std::vector<ThreadTime>& times) {
+    double elapsed = 0.0;
+    double stalled = 0.0;
+    for (const auto& t : times) {
+        elapsed += t.elapsed;
+        stalled += t.stalled;
+    }
+    return elapsed > 0.0 ? stalled / elapsed : 0.0;
+}
+
+}  // namespace
+
+void generate_scenario_shocks(size_t num_positions, uint64_t seed,
+                              uint64_t first, size_t count, double* shocks) {
+    Philox4x32 rng(seed);
+    for (size_t k = 0; k < count; ++k) {
+        uint64_t scenario = first + k;
+        double* row = shocks + k * num_positions;
+        for (size_t i = 0; i < num_positions; i += 4) {
+            std::array<double, 4> z = normal_quad(rng(scenario, i / 4));
+            size_t lanes = std::min<size_t>(4, num_positions - i);
+            for (size_t j = 0; j < lanes; ++j) {
+                row[i + j] = z[j];
+            }
+        }
+    }
+}
+
+void price_scenario_shocks(const McInputs& inputs, const double* shocks,
+                           size_t count, double* out) {
+    size_t n = inputs.notional.size();
+    const double* drift = inputs.drift.data();
+    const double* vol_sqrt_t = inputs.vol_sqrt_t.data();
+    const double* notional = inputs.notional.data();
+
+    for (size_t k = 0; k < count; ++k) {
+        const double* z = shocks + k * n;
+        double portfolio_pnl = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double price_change_factor = std::exp(drift[i] + vol_sqrt_t[i] * z[i]);
+            portfolio_pnl += notional[i] * (price_change_factor - 1.0);
+        }
+        out[k] = portfolio_pnl;
+    }
+}
+
+std::vector<double> simulate_pnl_pipelined(const McInputs& inputs,
+                                           const PipelinedMcConfig& config,
+                                           PipelineStats* stats) {
+    if (config.num_producers < 1 || config.num_consumers < 1) {
+        throw std::invalid_argument("pipeline needs at least one producer and one consumer");
+    }
+
+    size_t n = inputs.notional.size();
+    uint64_t num_sims = config.num_simulations;
+    size_t per_buffer = config.scenarios_per_buffer;
+    if (per_buffer == 0) {
+        size_t row_bytes = std::max<size_t>(n, 1) * sizeof(double);
+        per_buffer = std::max<size_t>(1, (size_t{1} << 20) / row_bytes);
+    }
+    per_buffer = static_cast<size_t>(
+        std::max<uint64_t>(1, std::min<uint64_t>(per_buffer, num_sims)));
+    uint64_t num_batches = (num_sims + per_buffer - 1) / per_buffer;
+    size_t num_buffers = config.num_buffers > 0
+        ? config.num_buffers
+        : 2 * static_cast<size_t>(config.num_consumers);
+
+    // Buffer indices circulate between the two queues; each queue can hold
+    // all of them, so a push never has to wait.
+    std::vector<std::vector<double>> shocks(num_buffers, std::vector<double>(per_buffer * n));
+    std::vector<uint64_t> batch_of(num_buffers);
+    MpmcRing<size_t> empty(std::max<size_t>(num_buffers, 2));
+    MpmcRing<size_t> full(std::max<size_t>(num_buffers, 2));
+    for (size_t slot = 0; slot < num_buffers; ++slot) {
+        empty.try_push(slot);
+    }
+
+    std::vector<double> pnl(num_sims);
+    std::atomic<uint64_t> next_to_fill{0};
+    std::atomic<uint64_t> next_to_price{0};
+    std::vector<ThreadTime> producer_times(config.num_producers);
+    std::vector<ThreadTime> consumer_times(config.num_consumers);
+
+    auto producer = [&](int id) {
+        auto start = Clock::now();
+        ThreadTime time;
+        for (;;) {
+            uint64_t batch = next_to_fill.fetch_add(1, std::memory_order_relaxed);
+            if (batch >= num_batches) break;
+            size_t slot = pop_waiting(empty, &time.stalled);
+            uint64_t first = batch * per_buffer;
+            size_t count = static_cast<size_t>(std::min<uint64_t>(per_buffer, num_sims - first));
+            generate_scenario_shocks(n, config.seed, first, count, shocks[slot].data());
+            batch_of[slot] = batch;
+            push_waiting(full, slot);
+        }
+        time.elapsed = seconds_since(start);
+        producer_times[id] = time;
+    };
+
+    // A consumer takes a ticket per batch so that exactly num_batches pops
+    // happen in total; which batch it ends up pricing does not matter.
+    auto consumer = [&](int id) {
+        auto start = Clock::now();
+        ThreadTime time;
+        for (;;) {
+            uint64_t ticket = next_to_price.fetch_add(1, std::memory_order_relaxed);
+            if (ticket >= num_batches) break;
+            size_t slot = pop_waiting(full, &time.stalled);
+            uint64_t first = batch_of[slot] * per_buffer;
+            size_t count = static_cast<size_t>(std::min<uint64_t>(per_buffer, num_sims - first));
+            price_scenario_shocks(inputs, shocks[slot].data(), count, pnl.data() + first);
+            push_waiting(empty, slot);
+        }
+        time.elapsed = seconds_since(start);
+        consumer_times[id] = time;
+    };
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < config.num_producers; ++p) {
+        threads.emplace_back(producer, p);
+    }
+    for (int c = 0; c < config.num_consumers; ++c) {
+        threads.emplace_back(consumer, c);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (stats) {
+        stats->buffers_handed_off = static_cast<size_t>(num_batches);
+        stats->scenarios_per_buffer = per_buffer;
+        stats->producer_stall_fraction = stall_fraction(producer_times);
+        stats->consumer_stall_fraction = stall_fraction(consumer_times);
+    }
+    return pnl;
+}
+
+PipelinedMcResult run_monte_carlo_pipelined(const McInputs& inputs,
+                                            const PipelinedMcConfig& config) {
+    PipelinedMcResult result;
+    auto pnl = simulate_pnl_pipelined(inputs, config, &result.stats);
+    result.var = calculate_var(pnl);
+    return result;
+}
+
+}  // namespace trading
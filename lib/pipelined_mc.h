@@ -0,0 +1,59 @@
+#ifndef LIB_PIPELINED_MC_H_
+#define LIB_PIPELINED_MC_H_
+
+#include "lib/monte_carlo.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+// Normal shocks of scenarios [first, first + count), one row of
+// num_positions per scenario, drawn exactly as simulate_pnl_scenarios
+// draws them (Philox keyed by seed, four normals per block).
+void generate_scenario_shocks(size_t num_positions, uint64_t seed,
+                              uint64_t first, size_t count, double* shocks);
+
+// P&L of `count` scenarios from their shock rows.
+void price_scenario_shocks(const McInputs& inputs, const double* shocks,
+                           size_t count, double* out);
+
+struct PipelinedMcConfig {
+    uint64_t num_simulations = 100000;
+    uint64_t seed = 42;
+    int num_producers = 1;            // Threads generating shocks
+    int num_consumers = 1;            // Threads pricing them
+    size_t num_buffers = 0;           // Shock buffers in flight; 0 = two per consumer
+    size_t scenarios_per_buffer = 0;  // 0 = about 1 MiB of shocks per buffer
+};
+
+struct PipelineStats {
+    size_t buffers_handed_off;
+    size_t scenarios_per_buffer;
+    double producer_stall_fraction;  // Producer time spent waiting for an empty buffer
+    double consumer_stall_fraction;  // Consumer time spent waiting for a filled buffer
+};
+
+// Monte Carlo with random number generation and pricing split across
+// threads. Producers claim batches and fill shock buffers while consumers
+// price previously filled ones; buffers cycle through two bounded
+// lock-free queues (empty -> full -> empty), so producers block once
+// num_buffers are waiting to be priced. Every scenario's P&L is the same
+// as simulate_pnl_scenarios gives, for any split and buffer count.
+// Throws std::invalid_argument for fewer than one producer or consumer.
+std::vector<double> simulate_pnl_pipelined(const McInputs& inputs,
+                                           const PipelinedMcConfig& config,
+                                           PipelineStats* stats = nullptr);
+
+struct PipelinedMcResult {
+    VaRResult var;
+    PipelineStats stats;
+};
+
+PipelinedMcResult run_monte_carlo_pipelined(const McInputs& inputs,
+                                            const PipelinedMcConfig& config);
+
+}  // namespace trading
+
+#endif  // LIB_PIPELINED_MC_H_
@@ -0,0 +1,72 @@
+#include "lib/pipelined_mc.h"
+
+#include "lib/chunked_mc.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace trading {
+namespace {
+
+TEST(PipelinedMcTest, ShocksAndPricingReproduceFusedScenarios) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(13, 4), 1.0/252.0);
+    size_t n = inputs.notional.size();
+    std::vector<double> shocks(9 * n);
+    generate_scenario_shocks(n, 17, 30, 9, shocks.data());
+    std::vector<double> pnl(9);
+    price_scenario_shocks(inputs, shocks.data(), 9, pnl.data());
+
+    std::vector<double> expected(9);
+    simulate_pnl_scenarios(inputs, 17, 30, 9, expected.data());
+    for (size_t k = 0; k < pnl.size(); ++k) {
+        EXPECT_EQ(pnl[k], expected[k]);
+    }
+}
+
+TEST(PipelinedMcTest, EverySplitMatchesFusedSimulation) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(40, 12), 1.0/252.0);
+    PipelinedMcConfig config;
+    config.num_simulations = 5003;
+    config.seed = 9;
+    config.scenarios_per_buffer = 64;
+
+    std::vector<double> expected(config.num_simulations);
+    simulate_pnl_scenarios(inputs, config.seed, 0, expected.size(), expected.data());
+
+    struct Split { int producers; int consumers; size_t buffers; };
+    for (Split split : {Split{1, 1, 2}, Split{1, 3, 0}, Split{3, 1, 1}, Split{2, 2, 8}}) {
+        config.num_producers = split.producers;
+        config.num_consumers = split.consumers;
+        config.num_buffers = split.buffers;
+        PipelineStats stats;
+        auto pnl = simulate_pnl_pipelined(inputs, config, &stats);
+        ASSERT_EQ(pnl, expected);
+        EXPECT_EQ(stats.buffers_handed_off, (5003u + 63u) / 64u);
+        EXPECT_GE(stats.producer_stall_fraction, 0.0);
+        EXPECT_LE(stats.producer_stall_fraction, 1.0);
+        EXPECT_GE(stats.consumer_stall_fraction, 0.0);
+        EXPECT_LE(stats.consumer_stall_fraction, 1.0);
+    }
+
+    PipelinedMcResult result = run_monte_carlo_pipelined(inputs, config);
+    VaRResult reference = calculate_var(expected);
+    EXPECT_EQ(result.var.var_95, reference.var_95);
+    EXPECT_EQ(result.var.var_99, reference.var_99);
+}
+
+TEST(PipelinedMcTest, HandlesTinyRunsAndRejectsEmptySides) {
+    auto inputs = prepare_mc_inputs(generate_random_positions(5, 1), 1.0/252.0);
+    PipelinedMcConfig config;
+    config.num_simulations = 3;
+    config.num_consumers = 4;
+    EXPECT_EQ(simulate_pnl_pipelined(inputs, config).size(), 3u);
+    config.num_simulations = 0;
+    EXPECT_TRUE(simulate_pnl_pipelined(inputs, config).empty());
+
+    config.num_producers = 0;
+    EXPECT_THROW(simulate_pnl_pipelined(inputs, config), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace trading
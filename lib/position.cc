@@ -1,17 +1,24 @@
 #include "lib/position.h"
 
+#include "lib/random.h"
+
+#include <algorithm>
+#include <cmath>
 #include <random>
+#include <stdexcept>
+#include <thread>
 
 namespace trading {
 
-std::vector<Position> generate_random_positions(size_t count, unsigned int seed) {
+std::vector<Position> generate_random_positions(size_t count, unsigned int seed,
+                                                size_t num_symbols) {
     std::mt19937 rng(seed);
     std::uniform_real_distribution<double> price_dist(10.0, 500.0);
     std::uniform_real_distribution<double> qty_dist(-1000.0, 1000.0);
     std::uniform_real_distribution<double> vol_dist(0.1, 0.8);
     std::uniform_real_distribution<double> expiry_dist(0.1, 2.0);
     std::uniform_int_distribution<int> type_dist(0, 2);
-    std::uniform_int_distribution<int> symbol_dist(0, 499);
+    std::uniform_int_distribution<int> symbol_dist(0, static_cast<int>(num_symbols) - 1);
 
     std::vector<Position> positions;
     positions.reserve(count);
@@ -45,4 +52,123 @@ double position_market_value(const Position& pos) {
     return pos.quantity * pos.price;
 }
 
+uint32_t SymbolTable::intern(const std::string& symbol) {
+    auto it = ids_.find(symbol);
+    if (it != ids_.end()) return it->second;
+    uint32_t id = static_cast<uint32_t>(names_.size());
+    ids_.emplace(symbol, id);
+    names_.push_back(symbol);
+    return id;
+}
+
+int SymbolTable::find(const std::string& symbol) const {
+    auto it = ids_.find(symbol);
+    return it == ids_.end() ? -1 : static_cast<int>(it->second);
+}
+
+GeneratedBook generate_book(size_t count, const BookProfile& profile,
+                            uint64_t seed, int num_threads) {
+    if (profile.num_symbols == 0) {
+        throw std::invalid_argument("book profile needs at least one symbol");
+    }
+    GeneratedBook book;
+    size_t num_symbols = profile.num_symbols;
+
+    std::vector<double> popularity(num_symbols);
+    for (size_t k = 0; k < num_symbols; ++k) {
+        popularity[k] = std::pow(static_cast<double>(k + 1), -profile.symbol_skew);
+    }
+    AliasTable symbol_table(popularity);
+
+    // Symbol attributes come from their own key so they do not shift when
+    // the per-position draws change.
+    Philox4x32 symbol_rng(seed ^ 0x5EED5EED5EED5EEDull);
+    std::vector<double> spots(num_symbols);
+    for (size_t k = 0; k < num_symbols; ++k) {
+        book.symbols.intern("SYM" + std::to_string(k));
+        double u = uniform_unit(symbol_rng(k, 0)[0]);
+        spots[k] = profile.min_spot + u * (profile.max_spot - profile.min_spot);
+    }
+
+    std::vector<double> expiry_cumulative;
+    for (const auto& bucket : profile.expiry_profile) {
+        double previous = expiry_cumulative.empty() ? 0.0 : expiry_cumulative.back();
+        expiry_cumulative.push_back(previous + bucket.weight);
+    }
+
+    book.positions.resize(count);
+    book.symbol_ids.resize(count);
+    Philox4x32 rng(seed);
+
+    auto worker = [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            Philox4x32::Block a = rng(i, 0);
+            Philox4x32::Block b = rng(i, 1);
+
+            uint32_t symbol = symbol_table.sample(uniform_unit(a[0]), uniform_unit(a[1]));
+            Position& pos = book.positions[i];
+            pos.symbol = book.symbols.name(symbol);
+            pos.price = spots[symbol];
+            pos.quantity = profile.max_quantity * (2.0 * uniform_unit(a[2]) - 1.0);
+            pos.volatility = profile.min_vol +
+                             uniform_unit(a[3]) * (profile.max_vol - profile.min_vol);
+            pos.risk_free_rate = 0.05;
+
+            double type = uniform_unit(b[0]);
+            if (type < profile.call_fraction) {
+                pos.type = PositionType::OPTION_CALL;
+            } else if (type < profile.call_fraction + profile.put_fraction) {
+                pos.type = PositionType::OPTION_PUT;
+            } else {
+                pos.type = PositionType::STOCK;
+            }
+
+            if (pos.type != PositionType::STOCK) {
+                double moneyness = profile.min_moneyness +
+                    uniform_unit(b[1]) * (profile.max_moneyness - profile.min_moneyness);
+                pos.strike = pos.price * moneyness;
+                double u = uniform_unit(b[2]);
+                if (expiry_cumulative.empty()) {
+                    pos.time_to_expiry = 0.1 + u * 1.9;
+                } else {
+                    size_t k = std::upper_bound(expiry_cumulative.begin(),
+                                                expiry_cumulative.end(),
+                                                u * expiry_cumulative.back()) -
+                               expiry_cumulative.begin();
+                    k = std::min(k, expiry_cumulative.size() - 1);
+                    pos.time_to_expiry = profile.expiry_profile[k].years;
+                }
+            } else {
+                pos.strike = 0.0;
+                pos.time_to_expiry = 0.0;
+            }
+            book.symbol_ids[i] = symbol;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    size_t chunk_size = (count + num_threads - 1) / num_threads;
+    for (int t = 0; t < num_threads; ++t) {
+        size_t start = std::min(t * chunk_size, count);
+        size_t end = std::min(start + chunk_size, count);
+        if (start < end) {
+            threads.emplace_back(worker, start, end);
+        }
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return book;
+}
+
+std::vector<uint32_t> intern_symbols(const std::vector<Position>& positions,
+                                     SymbolTable* table) {
+    std::vector<uint32_t> ids;
+    ids.reserve(positions.size());
+    for (const auto& pos : positions) {
+        ids.push_back(table->intern(pos.symbol));
+    }
+    return ids;
+}
+
 }  // namespace trading
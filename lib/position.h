@@ -1,7 +1,9 @@
 #ifndef LIB_POSITION_H_
 #define LIB_POSITION_H_
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace trading {
@@ -12,6 +14,11 @@ enum class PositionType {
     OPTION_PUT
 };
 
+enum class ExerciseStyle {
+    EUROPEAN,
+    AMERICAN
+};
+
 struct Position {
     std::string symbol;
     double quantity;
@@ -21,12 +28,70 @@ struct Position {
     double strike;
     double time_to_expiry;
     double risk_free_rate;
+    ExerciseStyle exercise = ExerciseStyle::EUROPEAN;
+    uint32_t account_id = 0;  // Leaf of the PositionHierarchy (lib/hierarchy.h)
 };
 
-std::vector<Position> generate_random_positions(size_t count, unsigned int seed = 42);
+// Symbols are drawn uniformly from SYM0..SYM<num_symbols - 1>.
+std::vector<Position> generate_random_positions(size_t count, unsigned int seed = 42,
+                                                size_t num_symbols = 500);
 
 double position_market_value(const Position& pos);
 
+// Interns symbol strings to dense ids 0..size()-1 in first-seen order, so
+// per-symbol results can live in flat arrays instead of string-keyed maps.
+class SymbolTable {
+public:
+    uint32_t intern(const std::string& symbol);
+    // -1 if the symbol was never interned.
+    int find(const std::string& symbol) const;
+    const std::string& name(uint32_t id) const { return names_[id]; }
+    size_t size() const { return names_.size(); }
+
+private:
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<std::string> names_;
+};
+
+// Symbol id of each position, aligned with `positions`.
+std::vector<uint32_t> intern_symbols(const std::vector<Position>& positions,
+                                     SymbolTable* table);
+
+struct ExpiryBucket {
+    double years;
+    double weight;
+};
+
+// Shape of a synthetic book for generate_book().
+struct BookProfile {
+    size_t num_symbols = 500;
+    double symbol_skew = 0.0;     // Zipf exponent of symbol popularity; 0 = uniform
+    double call_fraction = 1.0 / 3.0;
+    double put_fraction = 1.0 / 3.0;  // The rest are stock
+    // Options expire on these tenors with the given weights; empty means
+    // uniform over [0.1, 2.0] years.
+    std::vector<ExpiryBucket> expiry_profile;
+    double min_spot = 10.0;       // Per-symbol spot, shared by its positions
+    double max_spot = 500.0;
+    double max_quantity = 1000.0;  // Quantity uniform in [-max, max]
+    double min_vol = 0.1;
+    double max_vol = 0.8;
+    double min_moneyness = 0.8;   // Strike / spot
+    double max_moneyness = 1.2;
+};
+
+struct GeneratedBook {
+    std::vector<Position> positions;
+    SymbolTable symbols;              // Interned up front, SYM0..SYM<n-1>
+    std::vector<uint32_t> symbol_ids;  // Aligned with positions
+};
+
+// Parallel book generator. Position i draws from a counter-based RNG keyed
+// by (seed, i), so the book is identical for every num_threads; symbols are
+// interned once and sampled from an alias table.
+GeneratedBook generate_book(size_t count, const BookProfile& profile = {},
+                            uint64_t seed = 42, int num_threads = 1);
+
 }  // namespace trading
 
 #endif  // LIB_POSITION_H_
@@ -0,0 +1,57 @@
+#include "lib/position.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+TEST(GenerateBookTest, IndependentOfThreadCount) {
+    BookProfile profile;
+    profile.symbol_skew = 1.1;
+    auto reference = generate_book(20000, profile, 7, 1);
+    for (int threads : {2, 5}) {
+        auto book = generate_book(20000, profile, 7, threads);
+        ASSERT_EQ(book.positions.size(), reference.positions.size());
+        for (size_t i = 0; i < book.positions.size(); ++i) {
+            EXPECT_EQ(book.symbol_ids[i], reference.symbol_ids[i]);
+            EXPECT_EQ(book.positions[i].quantity, reference.positions[i].quantity);
+            EXPECT_EQ(book.positions[i].strike, reference.positions[i].strike);
+        }
+    }
+}
+
+TEST(GenerateBookTest, FollowsProfile) {
+    BookProfile profile;
+    profile.num_symbols = 100;
+    profile.symbol_skew = 1.0;
+    profile.call_fraction = 0.5;
+    profile.put_fraction = 0.0;
+    profile.expiry_profile = {{0.25, 1.0}, {1.0, 3.0}};
+    auto book = generate_book(40000, profile, 3, 4);
+
+    EXPECT_EQ(book.symbols.size(), 100u);
+    std::vector<int> per_symbol(100, 0);
+    int calls = 0;
+    int long_dated = 0;
+    for (size_t i = 0; i < book.positions.size(); ++i) {
+        const Position& pos = book.positions[i];
+        EXPECT_EQ(pos.symbol, book.symbols.name(book.symbol_ids[i]));
+        EXPECT_NE(pos.type, PositionType::OPTION_PUT);
+        ++per_symbol[book.symbol_ids[i]];
+        if (pos.type == PositionType::OPTION_CALL) {
+            ++calls;
+            EXPECT_TRUE(pos.time_to_expiry == 0.25 || pos.time_to_expiry == 1.0);
+            long_dated += (pos.time_to_expiry == 1.0);
+            EXPECT_GE(pos.strike / pos.price, 0.8);
+            EXPECT_LE(pos.strike / pos.price, 1.2);
+        }
+    }
+    EXPECT_NEAR(calls / 40000.0, 0.5, 0.02);
+    EXPECT_NEAR(long_dated / double(calls), 0.75, 0.02);
+    // Zipf(1): the top symbol is drawn about twice as often as the second.
+    EXPECT_NEAR(per_symbol[0] / double(per_symbol[1]), 2.0, 0.25);
+}
+
+}  // namespace
+}  // namespace trading
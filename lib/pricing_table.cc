@@ -0,0 +1,134 @@
+#include "lib/pricing_table.h"
+
+#include "lib/greeks.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace trading {
+
+namespace {
+
+constexpr double kErrorMargin = 0.5;
+constexpr int kSamplesPerCell = 8;
+
+double black_scholes_delta(double spot, double strike, double vol,
+                           double rate, double time, bool is_call) {
+    if (time <= 0.0 || vol <= 0.0) {
+        if (is_call) return spot > strike ? 1.0 : 0.0;
+        return spot < strike ? -1.0 : 0.0;
+    }
+    double d1 = (std::log(spot / strike) + (rate + 0.5 * vol * vol) * time) /
+                (vol * std::sqrt(time));
+    return is_call ? normal_cdf(d1) : normal_cdf(d1) - 1.0;
+}
+
+}  // namespace
+
+OptionPriceTable::OptionPriceTable(const Position& pos,
+                                   const PricingTableConfig& config)
+    : is_stock_(pos.type == PositionType::STOCK),
+      is_call_(pos.type == PositionType::OPTION_CALL),
+      strike_(pos.strike),
+      vol_(pos.volatility),
+      rate_(pos.risk_free_rate),
+      time_(pos.time_to_expiry) {
+    if (is_stock_) return;
+
+    double min_spot = pos.price * (1.0 - config.spot_range);
+    double max_spot = pos.price * (1.0 + config.spot_range);
+    size_t num_nodes = std::max<size_t>(config.initial_nodes, 2);
+
+    while (true) {
+        build(num_nodes, min_spot, max_spot);
+        max_error_ = measure_error();
+        // The error is sampled, not bounded, so the sampled maximum has to
+        // clear the tolerance with a margin for what falls between samples.
+        if (max_error_ <= kErrorMargin * config.error_tolerance) {
+            within_tolerance_ = true;
+            break;
+        }
+        if (num_nodes >= config.max_nodes) {
+            break;
+        }
+        num_nodes = std::min(num_nodes * 2, config.max_nodes);
+    }
+}
+
+void OptionPriceTable::build(size_t num_nodes, double min_spot,
+                             double max_spot) {
+    double step = (max_spot - min_spot) / static_cast<double>(num_nodes - 1);
+    min_spot_ = min_spot;
+    inv_step_ = 1.0 / step;
+    last_cell_ = static_cast<double>(num_nodes - 1);
+
+    nodes_.resize(2 * num_nodes);
+    for (size_t k = 0; k < num_nodes; ++k) {
+        double spot = min_spot + static_cast<double>(k) * step;
+        nodes_[2 * k] = black_scholes_price(spot, strike_, vol_, rate_, time_,
+                                            is_call_);
+        nodes_[2 * k + 1] = black_scholes_delta(spot, strike_, vol_, rate_,
+                                                time_, is_call_) * step;
+    }
+}
+
+// Samples each cell at kSamplesPerCell - 1 interior points. The Hermite
+// error vanishes at the nodes and, where the fourth derivative is smooth,
+// peaks near the middle; short-dated options near the strike are not
+// smooth on the cell scale, hence the dense sampling.
+double OptionPriceTable::measure_error() const {
+    double step = 1.0 / inv_step_;
+    size_t num_cells = num_nodes() - 1;
+    double max_error = 0.0;
+
+    for (size_t i = 0; i < num_cells; ++i) {
+        const double* node = &nodes_[2 * i];
+        for (int k = 1; k < kSamplesPerCell; ++k) {
+            double t = static_cast<double>(k) / kSamplesPerCell;
+            double spot = min_spot_ + (static_cast<double>(i) + t) * step;
+            double error = std::abs(interpolate(node, t) - fallback_price(spot));
+            max_error = std::max(max_error, error);
+        }
+    }
+
+    return max_error;
+}
+
+double OptionPriceTable::fallback_price(double spot) const {
+    if (is_stock_) return spot;
+    return black_scholes_price(spot, strike_, vol_, rate_, time_, is_call_);
+}
+
+std::vector<OptionPriceTable> build_price_tables(
+    const std::vector<Position>& positions,
+    const PricingTableConfig& config,
+    int num_threads) {
+    std::vector<OptionPriceTable> tables(positions.size());
+
+    auto worker = [&](size_t start, size_t end) {
+        for (size_t i = start; i < end; ++i) {
+            tables[i] = OptionPriceTable(positions[i], config);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    size_t chunk_size = (positions.size() + num_threads - 1) / num_threads;
+
+    for (int t = 0; t < num_threads; ++t) {
+        size_t start = t * chunk_size;
+        size_t end = std::min(start + chunk_size, positions.size());
+        if (start < end) {
+            threads.emplace_back(worker, start, end);
+        }
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return tables;
+}
+
+}  // namespace trading
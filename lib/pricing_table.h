@@ -0,0 +1,84 @@
+#ifndef LIB_PRICING_TABLE_H_
+#define LIB_PRICING_TABLE_H_
+
+#include "lib/position.h"
+
+#include <vector>
+
+namespace trading {
+
+struct PricingTableConfig {
+    double spot_range = 0.25;      // Table covers spot * (1 +/- spot_range)
+    size_t initial_nodes = 64;
+    size_t max_nodes = 8192;
+    double error_tolerance = 1e-6;  // Max abs price error vs black_scholes_price
+};
+
+// Per-option cubic Hermite table of price against spot, built from the
+// analytic price and delta at each node. The node count doubles until the
+// error measured against black_scholes_price inside every cell is within
+// the configured tolerance. A table that still misses the tolerance at
+// max_nodes is not used: price() returns the analytic price everywhere,
+// as it does for spots outside the table.
+class OptionPriceTable {
+public:
+    OptionPriceTable() = default;
+    OptionPriceTable(const Position& pos, const PricingTableConfig& config);
+
+    double price(double spot) const {
+        double x = (spot - min_spot_) * inv_step_;
+        if (!within_tolerance_ || !(x >= 0.0 && x < last_cell_)) {
+            return fallback_price(spot);
+        }
+        size_t i = static_cast<size_t>(x);
+        return interpolate(&nodes_[2 * i], x - static_cast<double>(i));
+    }
+
+    // Largest error measured in the final table, whether or not it is used.
+    double max_error() const { return max_error_; }
+    bool within_tolerance() const { return within_tolerance_; }
+    size_t num_nodes() const { return nodes_.size() / 2; }
+    double min_spot() const { return min_spot_; }
+    double max_spot() const {
+        return nodes_.empty() ? min_spot_ : min_spot_ + last_cell_ / inv_step_;
+    }
+
+private:
+    // Hermite interpolation at t in [0, 1) of the cell starting at node.
+    static double interpolate(const double* node, double t) {
+        double t2 = t * t;
+        double t3 = t2 * t;
+        double h00 = 2.0 * t3 - 3.0 * t2 + 1.0;
+        double h10 = t3 - 2.0 * t2 + t;
+        double h01 = -2.0 * t3 + 3.0 * t2;
+        double h11 = t3 - t2;
+        return h00 * node[0] + h10 * node[1] + h01 * node[2] + h11 * node[3];
+    }
+
+    void build(size_t num_nodes, double min_spot, double max_spot);
+    double measure_error() const;
+    double fallback_price(double spot) const;
+
+    bool is_stock_ = true;
+    bool is_call_ = false;
+    double strike_ = 0.0;
+    double vol_ = 0.0;
+    double rate_ = 0.0;
+    double time_ = 0.0;
+    double min_spot_ = 0.0;
+    double inv_step_ = 0.0;
+    double last_cell_ = 0.0;
+    double max_error_ = 0.0;
+    bool within_tolerance_ = false;
+    // Interleaved {price, delta * step} per node
+    std::vector<double> nodes_;
+};
+
+std::vector<OptionPriceTable> build_price_tables(
+    const std::vector<Position>& positions,
+    const PricingTableConfig& config,
+    int num_threads);
+
+}  // namespace trading
+
+#endif  // LIB_PRICING_TABLE_H_
@@ -0,0 +1,100 @@
+#include "lib/pricing_table.h"
+
+#include "lib/greeks.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+Position make_option(PositionType type, double time) {
+    return {.symbol = "AAPL", .quantity = 10, .price = 150.0, .volatility = 0.3,
+            .type = type, .strike = 155.0, .time_to_expiry = time,
+            .risk_free_rate = 0.05};
+}
+
+TEST(PricingTableTest, WithinErrorBound) {
+    PricingTableConfig config;
+    Position option = make_option(PositionType::OPTION_CALL, 0.5);
+    OptionPriceTable table(option, config);
+
+    EXPECT_TRUE(table.within_tolerance());
+    EXPECT_LE(table.max_error(), config.error_tolerance);
+
+    for (double spot = table.min_spot(); spot < table.max_spot(); spot += 0.0371) {
+        double analytic = black_scholes_price(spot, 155.0, 0.3, 0.05, 0.5, true);
+        EXPECT_NEAR(table.price(spot), analytic, config.error_tolerance);
+    }
+}
+
+TEST(PricingTableTest, RefinesShortDatedOptions) {
+    PricingTableConfig config;
+    OptionPriceTable long_dated(make_option(PositionType::OPTION_PUT, 2.0), config);
+    OptionPriceTable short_dated(make_option(PositionType::OPTION_PUT, 0.02), config);
+
+    EXPECT_LE(short_dated.max_error(), config.error_tolerance);
+    EXPECT_GT(short_dated.num_nodes(), long_dated.num_nodes());
+}
+
+TEST(PricingTableTest, UnreachableToleranceFallsBackToAnalytic) {
+    PricingTableConfig config;
+    config.max_nodes = 128;
+    Position option = make_option(PositionType::OPTION_CALL, 0.001);
+    option.strike = option.price;  // At the money, hours from expiry
+    OptionPriceTable table(option, config);
+
+    EXPECT_FALSE(table.within_tolerance());
+    EXPECT_GT(table.max_error(), config.error_tolerance);
+    EXPECT_EQ(table.num_nodes(), config.max_nodes);
+    for (double spot = table.min_spot(); spot < table.max_spot(); spot += 0.173) {
+        EXPECT_EQ(table.price(spot),
+                  black_scholes_price(spot, option.strike, 0.3, 0.05, 0.001, true));
+    }
+
+    // With room to refine, the same option gets a table that meets it.
+    config.max_nodes = 1 << 16;
+    OptionPriceTable refined(option, config);
+    EXPECT_TRUE(refined.within_tolerance());
+    for (double spot = refined.min_spot(); spot < refined.max_spot(); spot += 0.00731) {
+        double analytic = black_scholes_price(spot, option.strike, 0.3, 0.05, 0.001, true);
+        ASSERT_NEAR(refined.price(spot), analytic, config.error_tolerance);
+    }
+}
+
+TEST(PricingTableTest, OutOfRangeFallsBackToAnalytic) {
+    Position option = make_option(PositionType::OPTION_PUT, 0.5);
+    OptionPriceTable table(option, PricingTableConfig{});
+
+    double spot = table.max_spot() * 1.5;
+    EXPECT_EQ(table.price(spot),
+              black_scholes_price(spot, 155.0, 0.3, 0.05, 0.5, false));
+}
+
+TEST(PricingTableTest, StockPassThrough) {
+    Position stock = make_option(PositionType::STOCK, 0.0);
+    OptionPriceTable table(stock, PricingTableConfig{});
+
+    EXPECT_EQ(table.num_nodes(), 0);
+    EXPECT_EQ(table.price(123.0), 123.0);
+}
+
+TEST(PricingTableTest, BuildBook) {
+    auto positions = generate_random_positions(200, 42);
+    PricingTableConfig config;
+    auto tables = build_price_tables(positions, config, 4);
+
+    ASSERT_EQ(tables.size(), positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        const auto& pos = positions[i];
+        if (pos.type == PositionType::STOCK) continue;
+        double spot = pos.price * 1.07;
+        double analytic = black_scholes_price(
+            spot, pos.strike, pos.volatility, pos.risk_free_rate,
+            pos.time_to_expiry, pos.type == PositionType::OPTION_CALL);
+        EXPECT_NEAR(tables[i].price(spot), analytic, config.error_tolerance);
+    }
+}
+
+}  // namespace
+}  // namespace trading
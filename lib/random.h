@@ -0,0 +1,145 @@
+#ifndef LIB_RANDOM_H_
+#define LIB_RANDOM_H_
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace trading {
+
+// Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+// 3"): a keyed bijection of a 128-bit counter. Draw k of item i is a pure
+// function of (key, i, k), so parallel generators can split the counter
+// space any way they like and still produce the same stream.
+class Philox4x32 {
+public:
+    using Block = std::array<uint32_t, 4>;
+
+    explicit Philox4x32(uint64_t key)
+        : key0_(static_cast<uint32_t>(key)), key1_(static_cast<uint32_t>(key >> 32)) {}
+
+    Block operator()(uint64_t index, uint64_t block) const {
+        uint32_t c0 = static_cast<uint32_t>(index);
+        uint32_t c1 = static_cast<uint32_t>(index >> 32);
+        uint32_t c2 = static_cast<uint32_t>(block);
+        uint32_t c3 = static_cast<uint32_t>(block >> 32);
+        uint32_t k0 = key0_;
+        uint32_t k1 = key1_;
+        for (int round = 0; round < 10; ++round) {
+            uint64_t p0 = static_cast<uint64_t>(kMul0) * c0;
+            uint64_t p1 = static_cast<uint64_t>(kMul1) * c2;
+            uint32_t n0 = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+            uint32_t n2 = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<uint32_t>(p1);
+            c3 = static_cast<uint32_t>(p0);
+            c0 = n0;
+            c2 = n2;
+            k0 += kWeyl0;
+            k1 += kWeyl1;
+        }
+        return {c0, c1, c2, c3};
+    }
+
+private:
+    static constexpr uint32_t kMul0 = 0xD2511F53;
+    static constexpr uint32_t kMul1 = 0xCD9E8D57;
+    static constexpr uint32_t kWeyl0 = 0x9E3779B9;
+    static constexpr uint32_t kWeyl1 = 0xBB67AE85;
+
+    uint32_t key0_;
+    uint32_t key1_;
+};
+
+// Maps 32 random bits to (0, 1).
+inline double uniform_unit(uint32_t bits) {
+    return (bits + 0.5) * (1.0 / 4294967296.0);
+}
+
+// Four independent standard normals from one block (Box-Muller on both
+// halves).
+inline std::array<double, 4> normal_quad(const Philox4x32::Block& bits) {
+    constexpr double kTwoPi = 6.28318530717958647692;
+    double r0 = std::sqrt(-2.0 * std::log(uniform_unit(bits[0])));
+    double r1 = std::sqrt(-2.0 * std::log(uniform_unit(bits[2])));
+    double t0 = kTwoPi * uniform_unit(bits[1]);
+    double t1 = kTwoPi * uniform_unit(bits[3]);
+    return {r0 * std::cos(t0), r0 * std::sin(t0), r1 * std::cos(t1), r1 * std::sin(t1)};
+}
+
+// normal_quad(bits)[lane], evaluating only the Box-Muller half it needs.
+inline double normal_lane(const Philox4x32::Block& bits, size_t lane) {
+    constexpr double kTwoPi = 6.28318530717958647692;
+    size_t half = lane & 2;
+    double r = std::sqrt(-2.0 * std::log(uniform_unit(bits[half])));
+    double t = kTwoPi * uniform_unit(bits[half + 1]);
+    return r * ((lane & 1) ? std::sin(t) : std::cos(t));
+}
+
+// Vose's alias method: O(1) draws from a fixed discrete distribution.
+class AliasTable {
+public:
+    explicit AliasTable(const std::vector<double>& weights) {
+        size_t n = weights.size();
+        if (n == 0) {
+            throw std::invalid_argument("alias table needs at least one weight");
+        }
+        double total = 0.0;
+        for (double w : weights) {
+            if (w < 0.0) throw std::invalid_argument("alias table weight is negative");
+            total += w;
+        }
+        if (total <= 0.0) {
+            throw std::invalid_argument("alias table weights sum to zero");
+        }
+
+        probability_.resize(n);
+        alias_.resize(n);
+        std::vector<double> scaled(n);
+        std::vector<uint32_t> small;
+        std::vector<uint32_t> large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = weights[i] * n / total;
+            (scaled[i] < 1.0 ? small : large).push_back(static_cast<uint32_t>(i));
+        }
+        while (!small.empty() && !large.empty()) {
+            uint32_t s = small.back();
+            small.pop_back();
+            uint32_t l = large.back();
+            probability_[s] = scaled[s];
+            alias_[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        for (uint32_t i : large) {
+            probability_[i] = 1.0;
+            alias_[i] = i;
+        }
+        for (uint32_t i : small) {  // Rounding leftovers
+            probability_[i] = 1.0;
+            alias_[i] = i;
+        }
+    }
+
+    // Two independent uniforms in (0, 1).
+    uint32_t sample(double u_column, double u_coin) const {
+        uint32_t column = static_cast<uint32_t>(u_column * probability_.size());
+        if (column >= probability_.size()) column = static_cast<uint32_t>(probability_.size() - 1);
+        return u_coin < probability_[column] ? column : alias_[column];
+    }
+
+    size_t size() const { return probability_.size(); }
+
+private:
+    std::vector<double> probability_;
+    std::vector<uint32_t> alias_;
+};
+
+}  // namespace trading
+
+#endif  // LIB_RANDOM_H_
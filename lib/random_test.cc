@@ -0,0 +1,61 @@
+#include "lib/random.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+TEST(Philox4x32Test, MatchesReferenceVectors) {
+    // Known-answer tests from the Random123 distribution.
+    EXPECT_EQ(Philox4x32(0)(0, 0),
+              (Philox4x32::Block{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(Philox4x32(~0ull)(~0ull, ~0ull),
+              (Philox4x32::Block{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+}
+
+TEST(Philox4x32Test, NormalQuadHasUnitMoments) {
+    Philox4x32 rng(3);
+    const int kBlocks = 100000;
+    double sum = 0.0;
+    double sum_sq = 0.0;
+    for (int i = 0; i < kBlocks; ++i) {
+        for (double z : normal_quad(rng(i, 0))) {
+            sum += z;
+            sum_sq += z * z;
+        }
+    }
+    double n = 4.0 * kBlocks;
+    EXPECT_NEAR(sum / n, 0.0, 0.01);
+    EXPECT_NEAR(sum_sq / n, 1.0, 0.01);
+}
+
+TEST(Philox4x32Test, NormalLaneMatchesQuad) {
+    Philox4x32 rng(8);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        auto bits = rng(i, i % 7);
+        auto quad = normal_quad(bits);
+        for (size_t lane = 0; lane < 4; ++lane) {
+            EXPECT_EQ(normal_lane(bits, lane), quad[lane]);
+        }
+    }
+}
+
+TEST(AliasTableTest, SamplesInProportionToWeights) {
+    AliasTable table({1.0, 0.0, 3.0, 4.0});
+    Philox4x32 rng(9);
+    std::vector<int> counts(4, 0);
+    const int kDraws = 200000;
+    for (int i = 0; i < kDraws; ++i) {
+        auto bits = rng(i, 0);
+        ++counts[table.sample(uniform_unit(bits[0]), uniform_unit(bits[1]))];
+    }
+    EXPECT_EQ(counts[1], 0);
+    EXPECT_NEAR(counts[0] / double(kDraws), 0.125, 0.005);
+    EXPECT_NEAR(counts[2] / double(kDraws), 0.375, 0.005);
+    EXPECT_NEAR(counts[3] / double(kDraws), 0.5, 0.005);
+    EXPECT_THROW(AliasTable({0.0, 0.0}), std::invalid_argument);
+}
+
+}  // namespace
+}  // namespace trading
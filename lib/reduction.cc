@@ -0,0 +1,138 @@
+#include "lib/reduction.h"
+
+#include <algorithm>
+#include <thread>
+
+namespace trading {
+
+namespace {
+
+NeumaierSum sum_block(const double* values, size_t count, Summation mode) {
+    NeumaierSum block;
+    if (mode == Summation::NEUMAIER) {
+        for (size_t i = 0; i < count; ++i) {
+            block.add(values[i]);
+        }
+    } else {
+        double total = 0.0;
+        for (size_t i = 0; i < count; ++i) {
+            total += values[i];
+        }
+        block.sum = total;
+    }
+    return block;
+}
+
+double combine_blocks(std::vector<NeumaierSum>& blocks, Summation mode) {
+    if (blocks.empty()) return 0.0;
+    if (mode == Summation::NEUMAIER) {
+        tree_reduce(blocks, [](NeumaierSum& a, const NeumaierSum& b) { a.merge(b); });
+        return blocks[0].value();
+    }
+    tree_reduce(blocks, [](NeumaierSum& a, const NeumaierSum& b) { a.sum += b.sum; });
+    return blocks[0].sum;
+}
+
+// Builds the tree_reduce tree over leaves pushed left to right while
+// holding one partial per level: equal-sized neighbours merge as soon as
+// both exist, and the leftover right spine merges from the right at the
+// end. Same merges in the same order as tree_reduce, without storing
+// every leaf, so the sequential path does not allocate.
+class PairwiseStack {
+public:
+    explicit PairwiseStack(Summation mode) : mode_(mode) {}
+
+    void push(const NeumaierSum& leaf) {
+        partials_[depth_] = leaf;
+        leaves_[depth_] = 1;
+        ++depth_;
+        while (depth_ >= 2 && leaves_[depth_ - 1] == leaves_[depth_ - 2]) {
+            combine(partials_[depth_ - 2], partials_[depth_ - 1]);
+            leaves_[depth_ - 2] *= 2;
+            --depth_;
+        }
+    }
+
+    double finish() {
+        if (depth_ == 0) return 0.0;
+        for (size_t i = depth_ - 1; i > 0; --i) {
+            combine(partials_[i - 1], partials_[i]);
+        }
+        return mode_ == Summation::NEUMAIER ? partials_[0].value() : partials_[0].sum;
+    }
+
+private:
+    void combine(NeumaierSum& a, const NeumaierSum& b) const {
+        if (mode_ == Summation::NEUMAIER) {
+            a.merge(b);
+        } else {
+            a.sum += b.sum;
+        }
+    }
+
+    Summation mode_;
+    size_t depth_ = 0;
+    NeumaierSum partials_[64];
+    size_t leaves_[64];
+};
+
+}  // namespace
+
+double reduce_sum(const double* values, size_t count, Summation mode) {
+    if (mode == Summation::NAIVE) {
+        return sum_block(values, count, mode).sum;
+    }
+    PairwiseStack tree(mode);
+    for (size_t start = 0; start < count; start += kReductionBlock) {
+        tree.push(sum_block(values + start, std::min(kReductionBlock, count - start), mode));
+    }
+    return tree.finish();
+}
+
+double parallel_reduce_sum(const double* values, size_t count, int num_threads,
+                           Summation mode) {
+    std::vector<std::thread> threads;
+
+    if (mode == Summation::NAIVE) {
+        std::vector<double> partials(num_threads, 0.0);
+        size_t chunk_size = (count + num_threads - 1) / num_threads;
+        for (int t = 0; t < num_threads; ++t) {
+            size_t start = std::min(t * chunk_size, count);
+            size_t end = std::min(start + chunk_size, count);
+            threads.emplace_back([&, t, start, end]() {
+                partials[t] = sum_block(values + start, end - start, mode).sum;
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double total = 0.0;
+        for (double partial : partials) {
+            total += partial;
+        }
+        return total;
+    }
+
+    // Threads take contiguous runs of whole blocks; the blocks themselves
+    // and the tree over them do not depend on num_threads.
+    size_t num_blocks = (count + kReductionBlock - 1) / kReductionBlock;
+    std::vector<NeumaierSum> blocks(num_blocks);
+    size_t blocks_per_thread = (num_blocks + num_threads - 1) / num_threads;
+    for (int t = 0; t < num_threads; ++t) {
+        size_t first = std::min(t * blocks_per_thread, num_blocks);
+        size_t last = std::min(first + blocks_per_thread, num_blocks);
+        threads.emplace_back([&, first, last]() {
+            for (size_t b = first; b < last; ++b) {
+                size_t start = b * kReductionBlock;
+                blocks[b] = sum_block(values + start,
+                                      std::min(kReductionBlock, count - start), mode);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return combine_blocks(blocks, mode);
+}
+
+}  // namespace trading
@@ -0,0 +1,66 @@
+#ifndef LIB_REDUCTION_H_
+#define LIB_REDUCTION_H_
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace trading {
+
+// How a reduction adds its terms.
+//   NAIVE     Left-to-right; in parallel, one partial per thread chunk, so
+//             the result changes with the thread count.
+//   PAIRWISE  Fixed kReductionBlock-sized leaves summed left-to-right, then
+//             a pairwise tree over the leaves. The shape depends only on
+//             the input length, so every thread count gives the same bits.
+//   NEUMAIER  PAIRWISE shape with compensated leaves and merges.
+enum class Summation { NAIVE, PAIRWISE, NEUMAIER };
+
+constexpr size_t kReductionBlock = 4096;
+
+// Neumaier's improved Kahan summation: carries the rounding error of each
+// add in a separate term, including when the new term is the larger one.
+struct NeumaierSum {
+    double sum = 0.0;
+    double compensation = 0.0;
+
+    void add(double x) {
+        double t = sum + x;
+        if (std::abs(sum) >= std::abs(x)) {
+            compensation += (sum - t) + x;
+        } else {
+            compensation += (x - t) + sum;
+        }
+        sum = t;
+    }
+
+    void merge(const NeumaierSum& other) {
+        add(other.sum);
+        compensation += other.compensation;
+    }
+
+    double value() const { return sum + compensation; }
+};
+
+// Combines partials[0..n) in place with a fixed pairwise tree; the result
+// is left in partials[0]. `combine(a, b)` folds b into a.
+template <typename T, typename Combine>
+void tree_reduce(std::vector<T>& partials, Combine combine) {
+    for (size_t step = 1; step < partials.size(); step *= 2) {
+        for (size_t i = 0; i + step < partials.size(); i += 2 * step) {
+            combine(partials[i], partials[i + step]);
+        }
+    }
+}
+
+double reduce_sum(const double* values, size_t count,
+                  Summation mode = Summation::PAIRWISE);
+
+// PAIRWISE and NEUMAIER return exactly reduce_sum(values, count, mode) for
+// any num_threads.
+double parallel_reduce_sum(const double* values, size_t count, int num_threads,
+                           Summation mode = Summation::PAIRWISE);
+
+}  // namespace trading
+
+#endif  // LIB_REDUCTION_H_
@@ -0,0 +1,91 @@
+#include "lib/reduction.h"
+
+#include "lib/aggregator.h"
+
+#include <gtest/gtest.h>
+#include <random>
+
+namespace trading {
+namespace {
+
+std::vector<double> mixed_magnitudes(size_t count) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-8, 12);
+    std::vector<double> values(count);
+    for (auto& v : values) {
+        v = std::ldexp(mantissa(rng), exponent(rng) * 2);
+    }
+    return values;
+}
+
+TEST(ReductionTest, NeumaierRecoversCancelledTerms) {
+    NeumaierSum total;
+    for (double x : {1e16, 1.0, -1e16, 1.0}) {
+        total.add(x);
+    }
+    EXPECT_EQ(total.value(), 2.0);
+
+    std::vector<double> values = {1e16, 1.0, -1e16, 1.0};
+    EXPECT_EQ(reduce_sum(values.data(), values.size(), Summation::NEUMAIER), 2.0);
+    EXPECT_EQ(reduce_sum(nullptr, 0), 0.0);
+}
+
+TEST(ReductionTest, TreeSumsAreBitwiseStableAcrossThreadCounts) {
+    auto values = mixed_magnitudes(100003);
+    for (Summation mode : {Summation::PAIRWISE, Summation::NEUMAIER}) {
+        double expected = reduce_sum(values.data(), values.size(), mode);
+        for (int threads = 1; threads <= 9; ++threads) {
+            EXPECT_EQ(parallel_reduce_sum(values.data(), values.size(), threads, mode),
+                      expected)
+                << "threads=" << threads;
+        }
+    }
+}
+
+TEST(ReductionTest, SequentialTreeMatchesParallelForEveryShape) {
+    auto values = mixed_magnitudes(41 * kReductionBlock);
+    for (Summation mode : {Summation::PAIRWISE, Summation::NEUMAIER}) {
+        for (size_t blocks = 1; blocks <= 41; ++blocks) {
+            size_t count = blocks * kReductionBlock - (blocks % 3) * 1000;
+            EXPECT_EQ(reduce_sum(values.data(), count, mode),
+                      parallel_reduce_sum(values.data(), count, 4, mode))
+                << "count=" << count;
+        }
+    }
+}
+
+TEST(ReductionTest, DeterministicAggregationIsBitwiseStable) {
+    auto positions = generate_random_positions(30000, 8, 700);
+    auto single = aggregate_positions_single(positions);
+
+    for (Summation mode : {Summation::PAIRWISE, Summation::NEUMAIER}) {
+        auto reference = aggregate_positions_deterministic(positions, 1, mode);
+        for (int threads : {2, 3, 5, 8}) {
+            auto result = aggregate_positions_deterministic(positions, threads, mode);
+            EXPECT_EQ(result.net_exposure, reference.net_exposure);
+            EXPECT_EQ(result.total_long_exposure, reference.total_long_exposure);
+            EXPECT_EQ(result.total_short_exposure, reference.total_short_exposure);
+            ASSERT_EQ(result.by_symbol.size(), reference.by_symbol.size());
+            for (const auto& [symbol, exposure] : reference.by_symbol) {
+                const NetExposure& actual = result.by_symbol.at(symbol);
+                EXPECT_EQ(actual.quantity, exposure.quantity);
+                EXPECT_EQ(actual.notional, exposure.notional);
+                EXPECT_EQ(actual.avg_price, exposure.avg_price);
+            }
+        }
+
+        EXPECT_EQ(reference.total_positions, single.total_positions);
+        EXPECT_NEAR(reference.net_exposure, single.net_exposure,
+                    1e-9 * single.total_long_exposure);
+    }
+
+    // Uncompensated per-symbol sums follow book order, like the single pass.
+    auto pairwise = aggregate_positions_deterministic(positions, 4, Summation::PAIRWISE);
+    for (const auto& [symbol, exposure] : single.by_symbol) {
+        EXPECT_EQ(pairwise.by_symbol.at(symbol).notional, exposure.notional);
+    }
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,147 @@
+#include "lib/ring_buffer.h"
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace trading {
+namespace {
+
+TEST(RingBufferTest, CapacityRoundsToPowerOfTwo) {
+    SpscRing<int> ring(100);
+    EXPECT_EQ(ring.capacity(), 128u);
+    EXPECT_THROW(SpscRing<int>(1), std::invalid_argument);
+}
+
+TEST(RingBufferTest, SpscFullAndBatchPop) {
+    SpscRing<int> ring(8);
+    for (int i = 0; i < 8; ++i) {
+        EXPECT_TRUE(ring.try_push(i));
+    }
+    EXPECT_FALSE(ring.try_push(8));
+
+    int out[8];
+    ASSERT_EQ(ring.pop_batch(out, 5), 5u);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(out[i], i);
+    }
+    EXPECT_TRUE(ring.try_push(8));
+    EXPECT_EQ(ring.pop_batch(out, 8), 4u);
+    EXPECT_EQ(out[3], 8);
+    EXPECT_EQ(ring.pop_batch(out, 8), 0u);
+}
+
+TEST(RingBufferTest, SpscPreservesOrderAcrossThreads) {
+    constexpr int kCount = 200000;
+    SpscRing<int> ring(1024);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < kCount; ++i) {
+            while (!ring.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    int out[64];
+    while (expected < kCount) {
+        size_t n = ring.pop_batch(out, 64);
+        for (size_t k = 0; k < n; ++k) {
+            ASSERT_EQ(out[k], expected++);
+        }
+        if (n == 0) std::this_thread::yield();
+    }
+    producer.join();
+}
+
+TEST(RingBufferTest, MpscDeliversEveryItemOnce) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 50000;
+    MpscRing<int> ring(256);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                while (!ring.try_push(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> last(kProducers, -1);
+    std::vector<char> seen(kProducers * kPerProducer, 0);
+    int received = 0;
+    int out[32];
+    while (received < kProducers * kPerProducer) {
+        size_t n = ring.pop_batch(out, 32);
+        for (size_t k = 0; k < n; ++k) {
+            int p = out[k] / kPerProducer;
+            ASSERT_GT(out[k], last[p]);  // Per-producer FIFO
+            last[p] = out[k];
+            ASSERT_FALSE(seen[out[k]]);
+            seen[out[k]] = 1;
+        }
+        received += static_cast<int>(n);
+        if (n == 0) std::this_thread::yield();
+    }
+    for (auto& t : producers) {
+        t.join();
+    }
+
+    int tail;
+    EXPECT_FALSE(ring.try_pop(tail));
+}
+
+TEST(RingBufferTest, MpmcDeliversEveryItemOnce) {
+    constexpr int kProducers = 3;
+    constexpr int kConsumers = 3;
+    constexpr int kPerProducer = 40000;
+    constexpr int kTotal = kProducers * kPerProducer;
+    MpmcRing<int> ring(64);
+
+    std::vector<std::atomic<int>> seen(kTotal);
+    for (auto& s : seen) {
+        s.store(0, std::memory_order_relaxed);
+    }
+    std::atomic<int> received{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < kProducers; ++p) {
+        threads.emplace_back([&, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                while (!ring.try_push(p * kPerProducer + i)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < kConsumers; ++c) {
+        threads.emplace_back([&]() {
+            int value;
+            while (received.load(std::memory_order_relaxed) < kTotal) {
+                if (ring.try_pop(value)) {
+                    seen[value].fetch_add(1, std::memory_order_relaxed);
+                    received.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    for (int i = 0; i < kTotal; ++i) {
+        ASSERT_EQ(seen[i].load(), 1) << i;
+    }
+    int tail;
+    EXPECT_FALSE(ring.try_pop(tail));
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,146 @@
+#include "lib/risk_pipeline.h"
+
+#include "lib/greeks.h"
+
+#include <cmath>
+
+namespace trading {
+
+namespace {
+
+// One thread's share of the fused pass.
+struct PipelinePartial {
+    PipelinePartial(size_t num_symbols, const RollupConfig& config)
+        : greeks(num_symbols, config), by_symbol(num_symbols) {}
+
+    GreeksRollupAccumulator greeks;
+    std::vector<NetExposure> by_symbol;
+    double total_long = 0.0;
+    double total_short = 0.0;
+    int count = 0;
+};
+
+class FusedKernel {
+public:
+    FusedKernel(const std::vector<Position>& positions,
+                const std::vector<uint32_t>& symbol_ids, double time_horizon,
+                McInputs* mc)
+        : positions_(positions),
+          symbol_ids_(symbol_ids),
+          time_horizon_(time_horizon),
+          sqrt_t_(std::sqrt(time_horizon)),
+          mc_(mc) {}
+
+    void operator()(PipelinePartial& partial, size_t i, const Greeks& g) const {
+        const Position& pos = positions_[i];
+        uint32_t symbol = symbol_ids_[i];
+        partial.greeks.add(pos, symbol, g);
+
+        GbmTerms terms = gbm_terms(pos, time_horizon_, sqrt_t_);
+        double notional = terms.notional;
+        NetExposure& exposure = partial.by_symbol[symbol];
+        exposure.quantity += pos.quantity;
+        exposure.notional += notional;
+        exposure.position_count++;
+        if (notional > 0) {
+            partial.total_long += notional;
+        } else {
+            partial.total_short += std::abs(notional);
+        }
+        partial.count++;
+
+        mc_->drift[i] = terms.drift;
+        mc_->vol_sqrt_t[i] = terms.vol_sqrt_t;
+        mc_->notional[i] = terms.notional;
+    }
+
+private:
+    const std::vector<Position>& positions_;
+    const std::vector<uint32_t>& symbol_ids_;
+    double time_horizon_;
+    double sqrt_t_;
+    McInputs* mc_;
+};
+
+void resize_mc_inputs(McInputs* mc, size_t n) {
+    mc->drift.resize(n);
+    mc->vol_sqrt_t.resize(n);
+    mc->notional.resize(n);
+}
+
+RiskPipelineResult finish(std::vector<PipelinePartial>& partials,
+                          const SymbolTable& symbols, McInputs mc) {
+    PipelinePartial& total = partials[0];
+    for (size_t t = 1; t < partials.size(); ++t) {
+        const PipelinePartial& p = partials[t];
+        total.greeks.merge(p.greeks);
+        for (size_t s = 0; s < total.by_symbol.size(); ++s) {
+            total.by_symbol[s].quantity += p.by_symbol[s].quantity;
+            total.by_symbol[s].notional += p.by_symbol[s].notional;
+            total.by_symbol[s].position_count += p.by_symbol[s].position_count;
+        }
+        total.total_long += p.total_long;
+        total.total_short += p.total_short;
+        total.count += p.count;
+    }
+
+    RiskPipelineResult result;
+    result.greeks = total.greeks.to_rollup();
+    result.exposure.total_long_exposure = total.total_long;
+    result.exposure.total_short_exposure = total.total_short;
+    result.exposure.net_exposure = total.total_long - total.total_short;
+    result.exposure.total_positions = total.count;
+    result.exposure.by_symbol.reserve(total.by_symbol.size());
+    for (size_t s = 0; s < total.by_symbol.size(); ++s) {
+        NetExposure exposure = total.by_symbol[s];
+        if (exposure.position_count == 0) continue;
+        if (exposure.quantity != 0.0) {
+            exposure.avg_price = exposure.notional / exposure.quantity;
+        }
+        result.exposure.by_symbol.emplace(symbols.name(static_cast<uint32_t>(s)),
+                                          exposure);
+    }
+    result.mc_inputs = std::move(mc);
+    return result;
+}
+
+}  // namespace
+
+RiskPipelineResult run_risk_pipeline_single(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, const SymbolTable& symbols,
+    double time_horizon, const RollupConfig& config) {
+    McInputs mc;
+    resize_mc_inputs(&mc, positions.size());
+    FusedKernel kernel(positions, symbol_ids, time_horizon, &mc);
+
+    std::vector<PipelinePartial> partials;
+    partials.emplace_back(symbols.size(), config);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        kernel(partials[0], i, calculate_greeks(positions[i]));
+    }
+    return finish(partials, symbols, std::move(mc));
+}
+
+RiskPipelineResult run_risk_pipeline_multi(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, const SymbolTable& symbols,
+    double time_horizon, int num_threads, const RollupConfig& config) {
+    McInputs mc;
+    resize_mc_inputs(&mc, positions.size());
+    FusedKernel kernel(positions, symbol_ids, time_horizon, &mc);
+
+    std::vector<PipelinePartial> partials;
+    partials.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        partials.emplace_back(symbols.size(), config);
+    }
+
+    for_each_greeks_multi(positions, num_threads,
+                          [&](int chunk, size_t i, const Greeks& g) {
+                              kernel(partials[chunk], i, g);
+                          });
+    return finish(partials, symbols, std::move(mc));
+}
+
+}  // namespace trading
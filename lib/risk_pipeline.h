@@ -0,0 +1,37 @@
+#ifndef LIB_RISK_PIPELINE_H_
+#define LIB_RISK_PIPELINE_H_
+
+#include "lib/aggregator.h"
+#include "lib/monte_carlo.h"
+#include "lib/position.h"
+#include "lib/rollup.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+struct RiskPipelineResult {
+    GreeksRollup greeks;
+    AggregationResult exposure;
+    McInputs mc_inputs;
+};
+
+// Fused risk pass: each position is read once per thread chunk and feeds
+// Greeks (rolled up by symbol/expiry/strike), per-symbol NetExposure and
+// the MC coefficients together, instead of three separate walks of the
+// book. Exposure is reduced per thread into arrays indexed by symbol id
+// and only turned into the string-keyed map once at the end.
+RiskPipelineResult run_risk_pipeline_single(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, const SymbolTable& symbols,
+    double time_horizon, const RollupConfig& config = {});
+
+RiskPipelineResult run_risk_pipeline_multi(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, const SymbolTable& symbols,
+    double time_horizon, int num_threads, const RollupConfig& config = {});
+
+}  // namespace trading
+
+#endif  // LIB_RISK_PIPELINE_H_
@@ -0,0 +1,73 @@
+#include "lib/risk_pipeline.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+void expect_bucket_near(const GreeksBucket& a, const GreeksBucket& b) {
+    EXPECT_NEAR(a.delta, b.delta, 1e-6 * (1.0 + std::abs(b.delta)));
+    EXPECT_NEAR(a.gamma, b.gamma, 1e-6 * (1.0 + std::abs(b.gamma)));
+    EXPECT_NEAR(a.vega, b.vega, 1e-6 * (1.0 + std::abs(b.vega)));
+    EXPECT_NEAR(a.market_value, b.market_value, 1e-6 * (1.0 + std::abs(b.market_value)));
+    EXPECT_EQ(a.position_count, b.position_count);
+}
+
+TEST(RiskPipelineTest, MatchesSeparateKernels) {
+    auto positions = generate_random_positions(5000, 21);
+    SymbolTable symbols;
+    auto ids = intern_symbols(positions, &symbols);
+
+    auto rollup = calculate_greeks_rollup_single(positions, ids, symbols.size());
+    auto exposure = aggregate_positions_single(positions);
+
+    for (int threads : {1, 4}) {
+        auto result = threads == 1
+            ? run_risk_pipeline_single(positions, ids, symbols, 1.0 / 252)
+            : run_risk_pipeline_multi(positions, ids, symbols, 1.0 / 252, threads);
+
+        expect_bucket_near(result.greeks.total, rollup.total);
+        ASSERT_EQ(result.greeks.by_symbol.size(), rollup.by_symbol.size());
+        for (size_t s = 0; s < rollup.by_symbol.size(); ++s) {
+            expect_bucket_near(result.greeks.by_symbol[s], rollup.by_symbol[s]);
+        }
+
+        EXPECT_EQ(result.exposure.total_positions, exposure.total_positions);
+        EXPECT_NEAR(result.exposure.total_long_exposure,
+                    exposure.total_long_exposure, 1e-6 * exposure.total_long_exposure);
+        EXPECT_NEAR(result.exposure.total_short_exposure,
+                    exposure.total_short_exposure, 1e-6 * exposure.total_short_exposure);
+        ASSERT_EQ(result.exposure.by_symbol.size(), exposure.by_symbol.size());
+        for (const auto& [symbol, net] : exposure.by_symbol) {
+            const NetExposure& fused = result.exposure.by_symbol.at(symbol);
+            EXPECT_NEAR(fused.quantity, net.quantity, 1e-9 * (1.0 + std::abs(net.quantity)));
+            EXPECT_NEAR(fused.notional, net.notional, 1e-6 * (1.0 + std::abs(net.notional)));
+            EXPECT_EQ(fused.position_count, net.position_count);
+        }
+    }
+}
+
+TEST(RiskPipelineTest, McInputsReproduceVaR) {
+    auto positions = generate_random_positions(1000, 5);
+    SymbolTable symbols;
+    auto ids = intern_symbols(positions, &symbols);
+    double horizon = 1.0 / 252;
+
+    auto result = run_risk_pipeline_multi(positions, ids, symbols, horizon, 3);
+    auto expected = prepare_mc_inputs(positions, horizon);
+    ASSERT_EQ(result.mc_inputs.notional.size(), positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        EXPECT_EQ(result.mc_inputs.drift[i], expected.drift[i]);
+        EXPECT_EQ(result.mc_inputs.vol_sqrt_t[i], expected.vol_sqrt_t[i]);
+        EXPECT_EQ(result.mc_inputs.notional[i], expected.notional[i]);
+    }
+
+    auto from_positions = run_monte_carlo_multi(positions, 2000, horizon, 2, 7);
+    auto from_inputs = run_monte_carlo_multi(result.mc_inputs, 2000, 2, 7);
+    EXPECT_DOUBLE_EQ(from_inputs.var_95, from_positions.var_95);
+    EXPECT_DOUBLE_EQ(from_inputs.var_99, from_positions.var_99);
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,269 @@
+#include "lib/risk_service.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace trading {
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int kSendFlags = MSG_NOSIGNAL;
+#else
+constexpr int kSendFlags = 0;
+#endif
+
+void disable_sigpipe(int fd) {
+#ifdef SO_NOSIGPIPE
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#else
+    (void)fd;
+#endif
+}
+
+bool write_full(int fd, const void* data, size_t size) {
+    const char* p = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = send(fd, p, size, kSendFlags);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool read_full(int fd, void* data, size_t size) {
+    char* p = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t n = recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool make_address(const std::string& path, sockaddr_un* addr) {
+    std::memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr->sun_path)) return false;
+    std::memcpy(addr->sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+}  // namespace
+
+RiskService::RiskService(std::vector<Position> positions,
+                         const RiskServiceConfig& config)
+    : positions_(std::move(positions)),
+      config_(config),
+      workspace_(config.num_threads),
+      mc_inputs_(prepare_mc_inputs(positions_, config.time_horizon)),
+      greeks_(positions_.size()) {}
+
+RiskService::~RiskService() {
+    stop();
+    if (listen_fd_ >= 0) {
+        ::close(listen_fd_);
+        unlink(config_.socket_path.c_str());
+    }
+}
+
+bool RiskService::start() {
+    sockaddr_un addr;
+    if (!make_address(config_.socket_path, &addr)) {
+        std::cerr << "Error: invalid socket path " << config_.socket_path << "\n";
+        return false;
+    }
+
+    // Warm up before binding so no client ever waits on a cold pass.
+    handle({static_cast<uint32_t>(RiskRequestType::GREEKS), 0, 42, 0});
+    handle({static_cast<uint32_t>(RiskRequestType::EXPOSURE), 0, 42, 0});
+    handle({static_cast<uint32_t>(RiskRequestType::VAR), config_.max_simulations, 42, 0});
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) return false;
+
+    unlink(config_.socket_path.c_str());
+    if (bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 128) != 0) {
+        std::cerr << "Error: cannot listen on " << config_.socket_path << ": "
+                  << std::strerror(errno) << "\n";
+        ::close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    stopping_ = false;
+    return true;
+}
+
+void RiskService::run() {
+    pollfd pfd{listen_fd_, POLLIN, 0};
+
+    while (!stopping_) {
+        int ready = poll(&pfd, 1, 100);
+        if (ready <= 0 || !(pfd.revents & POLLIN)) continue;
+
+        int fd = accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) continue;
+        disable_sigpipe(fd);
+
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connection_fds_.push_back(fd);
+        ++active_connections_;
+        std::thread(&RiskService::serve_connection, this, fd).detach();
+    }
+
+    std::unique_lock<std::mutex> lock(connections_mutex_);
+    for (int fd : connection_fds_) {
+        shutdown(fd, SHUT_RDWR);
+    }
+    connections_done_.wait(lock, [this]() { return active_connections_ == 0; });
+}
+
+void RiskService::stop() {
+    stopping_ = true;
+}
+
+void RiskService::serve_connection(int fd) {
+    RiskRequest request;
+    while (!stopping_ && read_full(fd, &request, sizeof(request))) {
+        RiskResponse response{};
+        try {
+            response = handle(request);
+        } catch (const std::exception& e) {
+            // Fail this request, not the daemon.
+            std::cerr << "Error: request failed: " << e.what() << "\n";
+            response.status = kRiskStatusError;
+        }
+        if (!write_full(fd, &response, sizeof(response))) break;
+    }
+
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    connection_fds_.erase(
+        std::find(connection_fds_.begin(), connection_fds_.end(), fd));
+    ::close(fd);
+    --active_connections_;
+    connections_done_.notify_all();
+}
+
+RiskResponse RiskService::handle(const RiskRequest& request) {
+    RiskResponse response{};
+    response.status = kRiskStatusOk;
+
+    switch (static_cast<RiskRequestType>(request.type)) {
+    case RiskRequestType::PING:
+        break;
+
+    case RiskRequestType::VAR: {
+        size_t sims = request.num_simulations > 0 ? request.num_simulations
+                                                  : config_.default_simulations;
+        if (sims > config_.max_simulations) {
+            response.status = kRiskStatusBadRequest;
+            break;
+        }
+        std::lock_guard<std::mutex> lock(compute_mutex_);
+        VaRResult var = run_monte_carlo_multi(mc_inputs_, sims, workspace_,
+                                              request.seed);
+        response.count = 5;
+        response.values[0] = var.var_95;
+        response.values[1] = var.var_99;
+        response.values[2] = var.expected_shortfall;
+        response.values[3] = var.mean_pnl;
+        response.values[4] = var.std_pnl;
+        break;
+    }
+
+    case RiskRequestType::GREEKS: {
+        std::lock_guard<std::mutex> lock(compute_mutex_);
+        calculate_all_greeks_multi(positions_, workspace_, greeks_.data());
+        double totals[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+        for (size_t i = 0; i < greeks_.size(); ++i) {
+            double qty = positions_[i].quantity;
+            totals[0] += greeks_[i].delta * qty;
+            totals[1] += greeks_[i].gamma * qty;
+            totals[2] += greeks_[i].vega * qty;
+            totals[3] += greeks_[i].theta * qty;
+            totals[4] += greeks_[i].price * qty;
+        }
+        response.count = 5;
+        std::copy(totals, totals + 5, response.values);
+        break;
+    }
+
+    case RiskRequestType::EXPOSURE: {
+        std::lock_guard<std::mutex> lock(compute_mutex_);
+        aggregate_positions_multi(positions_, workspace_, &exposure_);
+        double top_notional = 0.0;
+        for (const auto& entry : exposure_.by_symbol) {
+            top_notional = std::max(top_notional, std::abs(entry.second.notional));
+        }
+        response.count = 5;
+        response.values[0] = exposure_.net_exposure;
+        response.values[1] = exposure_.total_long_exposure;
+        response.values[2] = exposure_.total_short_exposure;
+        response.values[3] = static_cast<double>(exposure_.by_symbol.size());
+        response.values[4] = top_notional;
+        break;
+    }
+
+    case RiskRequestType::SHUTDOWN:
+        stopping_ = true;
+        break;
+
+    default:
+        response.status = kRiskStatusBadRequest;
+        break;
+    }
+
+    return response;
+}
+
+RiskClient::~RiskClient() {
+    close();
+}
+
+bool RiskClient::connect(const std::string& socket_path) {
+    sockaddr_un addr;
+    if (!make_address(socket_path, &addr)) return false;
+
+    close();
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) return false;
+    disable_sigpipe(fd_);
+
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool RiskClient::request(const RiskRequest& request, RiskResponse* response) {
+    if (fd_ < 0) return false;
+    return write_full(fd_, &request, sizeof(request)) &&
+           read_full(fd_, response, sizeof(*response));
+}
+
+void RiskClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+}  // namespace trading
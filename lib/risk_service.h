@@ -0,0 +1,114 @@
+#ifndef LIB_RISK_SERVICE_H_
+#define LIB_RISK_SERVICE_H_
+
+#include "lib/aggregator.h"
+#include "lib/greeks.h"
+#include "lib/monte_carlo.h"
+#include "lib/position.h"
+#include "lib/risk_workspace.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trading {
+
+// Fixed-size binary protocol over a Unix domain socket. Both ends run on
+// the same host, so fields are sent in native byte order.
+enum class RiskRequestType : uint32_t {
+    PING = 0,
+    VAR = 1,       // values: var_95, var_99, expected_shortfall, mean, std
+    GREEKS = 2,    // values: delta, gamma, vega, theta, market value
+    EXPOSURE = 3,  // values: net, long, short, symbols, top |notional|
+    SHUTDOWN = 4
+};
+
+constexpr uint32_t kRiskStatusOk = 0;
+constexpr uint32_t kRiskStatusBadRequest = 1;
+constexpr uint32_t kRiskStatusError = 2;  // The request failed inside the service
+
+struct RiskRequest {
+    uint32_t type;
+    uint32_t num_simulations;  // VAR only; 0 = service default, at most max
+    uint32_t seed;             // VAR only
+    uint32_t reserved;
+};
+
+struct RiskResponse {
+    uint32_t status;
+    uint32_t count;  // Number of populated values
+    double values[6];
+};
+
+struct RiskServiceConfig {
+    std::string socket_path;
+    int num_threads = 1;
+    double time_horizon = 1.0 / 252.0;
+    uint32_t default_simulations = 10000;
+    // Larger VAR requests are rejected. start() sizes the workspace for
+    // this many, so no accepted request grows it.
+    uint32_t max_simulations = 100000;
+};
+
+// Resident risk daemon. Holds the book, its MC coefficients, the result
+// buffers and a RiskWorkspace for its whole lifetime, so after the warm-up
+// in start() a request does not allocate. Compute requests are serialized
+// because each one already fans out across the workspace's threads.
+class RiskService {
+public:
+    RiskService(std::vector<Position> positions, const RiskServiceConfig& config);
+    ~RiskService();
+
+    RiskService(const RiskService&) = delete;
+    RiskService& operator=(const RiskService&) = delete;
+
+    // Runs one pass of every request type (VAR at max_simulations) to warm
+    // caches, pages and the allocator, then binds the socket.
+    bool start();
+    // Accepts connections until stop() or a SHUTDOWN request.
+    void run();
+    void stop();
+
+    RiskResponse handle(const RiskRequest& request);
+
+private:
+    void serve_connection(int fd);
+
+    std::vector<Position> positions_;
+    RiskServiceConfig config_;
+    RiskWorkspace workspace_;
+    McInputs mc_inputs_;
+    std::vector<Greeks> greeks_;
+    AggregationResult exposure_{};
+
+    int listen_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+    std::mutex compute_mutex_;
+    std::mutex connections_mutex_;
+    std::condition_variable connections_done_;
+    std::vector<int> connection_fds_;
+    int active_connections_ = 0;
+};
+
+class RiskClient {
+public:
+    RiskClient() = default;
+    ~RiskClient();
+
+    RiskClient(const RiskClient&) = delete;
+    RiskClient& operator=(const RiskClient&) = delete;
+
+    bool connect(const std::string& socket_path);
+    bool request(const RiskRequest& request, RiskResponse* response);
+    void close();
+
+private:
+    int fd_ = -1;
+};
+
+}  // namespace trading
+
+#endif  // LIB_RISK_SERVICE_H_
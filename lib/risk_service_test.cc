@@ -0,0 +1,164 @@
+#include "lib/risk_service.h"
+
+#include "lib/aggregator.h"
+#include "lib/memory_stats.h"
+#include "lib/monte_carlo.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <thread>
+
+#include <unistd.h>
+
+namespace trading {
+namespace {
+
+RiskServiceConfig test_config(const std::string& name) {
+    RiskServiceConfig config;
+    config.socket_path = "/tmp/risk_service_test_" + name + "_" +
+                         std::to_string(getpid()) + ".sock";
+    config.num_threads = 2;
+    config.default_simulations = 2000;
+    config.max_simulations = 4000;
+    return config;
+}
+
+RiskRequest make_request(RiskRequestType type, uint32_t sims = 0,
+                         uint32_t seed = 42) {
+    return {static_cast<uint32_t>(type), sims, seed, 0};
+}
+
+TEST(RiskServiceTest, HandleMatchesDirectComputation) {
+    auto positions = generate_random_positions(200, 7);
+    auto config = test_config("handle");
+    RiskService service(positions, config);
+
+    RiskResponse greeks = service.handle(make_request(RiskRequestType::GREEKS));
+    EXPECT_EQ(greeks.status, kRiskStatusOk);
+    EXPECT_EQ(greeks.count, 5u);
+
+    double delta = 0.0;
+    auto expected = calculate_all_greeks_single(positions);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        delta += expected[i].delta * positions[i].quantity;
+    }
+    EXPECT_NEAR(greeks.values[0], delta, 1e-6 * std::abs(delta) + 1e-9);
+
+    RiskResponse exposure = service.handle(make_request(RiskRequestType::EXPOSURE));
+    auto agg = aggregate_positions_single(positions);
+    EXPECT_NEAR(exposure.values[0], agg.net_exposure,
+                1e-9 * std::abs(agg.net_exposure) + 1e-6);
+    EXPECT_EQ(exposure.values[3], static_cast<double>(agg.by_symbol.size()));
+
+    RiskResponse var = service.handle(make_request(RiskRequestType::VAR, 1000, 9));
+    VaRResult direct = run_monte_carlo_multi(positions, 1000, config.time_horizon,
+                                             config.num_threads, 9);
+    EXPECT_DOUBLE_EQ(var.values[0], direct.var_95);
+    EXPECT_DOUBLE_EQ(var.values[1], direct.var_99);
+}
+
+TEST(RiskServiceTest, WarmRequestsReuseThreadsAndBuffers) {
+    ASSERT_TRUE(allocation_hook_installed());
+    auto positions = generate_random_positions(500, 3);
+    RiskService service(positions, test_config("warm"));
+
+    // One pass of each type, as start() does before binding.
+    auto config = test_config("warm");
+    service.handle(make_request(RiskRequestType::GREEKS));
+    service.handle(make_request(RiskRequestType::EXPOSURE));
+    service.handle(make_request(RiskRequestType::VAR, config.max_simulations));
+
+    // Worker threads, the P&L and sort buffers, the Greeks vector and the
+    // exposure maps are all reused: no request after the warm-up allocates.
+    uint64_t before = allocation_counts().allocations;
+    set_allocation_counting(true);
+    double checksum = 0.0;
+    for (uint32_t seed = 1; seed <= 5; ++seed) {
+        checksum += service.handle(make_request(RiskRequestType::GREEKS)).values[0];
+        checksum += service.handle(make_request(RiskRequestType::EXPOSURE)).values[0];
+        checksum += service.handle(make_request(RiskRequestType::VAR, 0, seed)).values[1];
+        checksum += service.handle(make_request(RiskRequestType::VAR, 1500, seed)).values[1];
+        checksum += service.handle(make_request(RiskRequestType::VAR, 4000, seed)).values[1];
+    }
+    set_allocation_counting(false);
+    EXPECT_EQ(allocation_counts().allocations, before);
+    EXPECT_TRUE(std::isfinite(checksum));
+}
+
+TEST(RiskServiceTest, UnknownRequestRejected) {
+    RiskService service(generate_random_positions(10), test_config("unknown"));
+
+    RiskRequest request{99, 0, 0, 0};
+    EXPECT_EQ(service.handle(request).status, kRiskStatusBadRequest);
+    EXPECT_EQ(service.handle(make_request(RiskRequestType::PING)).status,
+              kRiskStatusOk);
+}
+
+TEST(RiskServiceTest, OversizedVarRejectedAndServiceKeepsServing) {
+    auto config = test_config("oversized");
+    RiskService service(generate_random_positions(100), config);
+    ASSERT_TRUE(service.start());
+    std::thread server([&]() { service.run(); });
+
+    RiskClient client;
+    ASSERT_TRUE(client.connect(config.socket_path));
+    RiskResponse response;
+    for (uint32_t sims : {config.max_simulations + 1, 0xFFFFFFFFu}) {
+        ASSERT_TRUE(client.request(make_request(RiskRequestType::VAR, sims), &response));
+        EXPECT_EQ(response.status, kRiskStatusBadRequest);
+    }
+    ASSERT_TRUE(client.request(make_request(RiskRequestType::PING), &response));
+    EXPECT_EQ(response.status, kRiskStatusOk);
+    ASSERT_TRUE(client.request(make_request(RiskRequestType::VAR, config.max_simulations),
+                               &response));
+    EXPECT_EQ(response.status, kRiskStatusOk);
+
+    ASSERT_TRUE(client.request(make_request(RiskRequestType::SHUTDOWN), &response));
+    server.join();
+}
+
+TEST(RiskServiceTest, ServesClientsOverSocket) {
+    auto config = test_config("socket");
+    RiskService service(generate_random_positions(100), config);
+    ASSERT_TRUE(service.start());
+    std::thread server([&]() { service.run(); });
+
+    std::vector<std::thread> clients;
+    std::vector<int> successes(3, 0);
+    for (int c = 0; c < 3; ++c) {
+        clients.emplace_back([&, c]() {
+            RiskClient client;
+            if (!client.connect(config.socket_path)) return;
+            RiskResponse response;
+            for (int r = 0; r < 20; ++r) {
+                auto type = (r % 2 == 0) ? RiskRequestType::PING
+                                         : RiskRequestType::GREEKS;
+                if (client.request(make_request(type), &response) &&
+                    response.status == kRiskStatusOk) {
+                    ++successes[c];
+                }
+            }
+        });
+    }
+    for (auto& t : clients) {
+        t.join();
+    }
+    for (int s : successes) {
+        EXPECT_EQ(s, 20);
+    }
+
+    // A connection left open must not keep the service alive.
+    RiskClient idle;
+    ASSERT_TRUE(idle.connect(config.socket_path));
+
+    RiskClient control;
+    ASSERT_TRUE(control.connect(config.socket_path));
+    RiskResponse response;
+    ASSERT_TRUE(control.request(make_request(RiskRequestType::SHUTDOWN), &response));
+    EXPECT_EQ(response.status, kRiskStatusOk);
+
+    server.join();
+}
+
+}  // namespace
+}  // namespace trading
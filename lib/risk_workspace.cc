@@ -0,0 +1,211 @@
+#include "lib/risk_workspace.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace trading {
+
+WorkerPool::WorkerPool(int num_threads) {
+    int workers = std::max(num_threads, 1) - 1;
+    threads_.reserve(workers);
+    for (int part = 1; part <= workers; ++part) {
+        threads_.emplace_back(&WorkerPool::worker_loop, this, part);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    start_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkerPool::run_job(Job job, void* context) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job_ = job;
+        context_ = context;
+        pending_ = static_cast<int>(threads_.size());
+        ++generation_;
+    }
+    start_.notify_all();
+    job(context, 0);
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [this]() { return pending_ == 0; });
+}
+
+void WorkerPool::worker_loop(int part) {
+    uint64_t seen = 0;
+    for (;;) {
+        Job job;
+        void* context;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            start_.wait(lock, [&]() { return stopping_ || generation_ != seen; });
+            if (stopping_) return;
+            seen = generation_;
+            job = job_;
+            context = context_;
+        }
+        job(context, part);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--pending_ == 0) done_.notify_one();
+        }
+    }
+}
+
+double* RiskWorkspace::pnl(size_t num_simulations) {
+    if (pnl_.size() < num_simulations) pnl_.resize(num_simulations);
+    return pnl_.data();
+}
+
+double* RiskWorkspace::sorted(size_t num_simulations) {
+    if (sorted_.size() < num_simulations) sorted_.resize(num_simulations);
+    return sorted_.data();
+}
+
+namespace {
+
+void reset_exposure(AggregationResult* result) {
+    for (auto& entry : result->by_symbol) {
+        entry.second = NetExposure{};
+    }
+    result->total_long_exposure = 0.0;
+    result->total_short_exposure = 0.0;
+    result->net_exposure = 0.0;
+    result->total_positions = 0;
+}
+
+// Looks the symbol up before inserting, so a symbol that is already in
+// the map never constructs a key.
+NetExposure& exposure_for(AggregationResult* result, const std::string& symbol) {
+    auto it = result->by_symbol.find(symbol);
+    if (it == result->by_symbol.end()) {
+        it = result->by_symbol.emplace(symbol, NetExposure{}).first;
+    }
+    return it->second;
+}
+
+void erase_empty(AggregationResult* result) {
+    for (auto it = result->by_symbol.begin(); it != result->by_symbol.end();) {
+        if (it->second.position_count == 0) {
+            it = result->by_symbol.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+}  // namespace
+
+template <typename NormalPolicy>
+void calculate_all_greeks_multi(const std::vector<Position>& positions,
+                                RiskWorkspace& workspace, Greeks* out,
+                                double bump_size) {
+    size_t num_parts = static_cast<size_t>(workspace.num_threads());
+    size_t chunk_size = (positions.size() + num_parts - 1) / num_parts;
+    auto price = [&](int part) {
+        size_t start = std::min(part * chunk_size, positions.size());
+        size_t end = std::min(start + chunk_size, positions.size());
+        for (size_t i = start; i < end; ++i) {
+            out[i] = calculate_greeks<NormalPolicy>(positions[i], bump_size);
+        }
+    };
+    workspace.pool().run(price);
+}
+
+template <typename T>
+VaRResult run_monte_carlo_multi(const McInputsT<T>& inputs, size_t num_simulations,
+                                RiskWorkspace& workspace, unsigned int seed) {
+    int num_threads = workspace.num_threads();
+    double* all_pnl = workspace.pnl(num_simulations);
+    size_t sims_per_thread = num_simulations / num_threads;
+    size_t remainder = num_simulations % num_threads;
+
+    // Same split and per-thread seeds as the allocating version; each part
+    // writes its scenarios straight into its slice of the combined vector.
+    auto simulate = [&](int part) {
+        size_t offset = part * sims_per_thread + std::min<size_t>(part, remainder);
+        size_t sims = sims_per_thread + (part < static_cast<int>(remainder) ? 1 : 0);
+        unsigned int thread_seed = seed + part * 12345;
+        simulate_portfolio_pnl(inputs, sims, thread_seed, all_pnl + offset);
+    };
+    workspace.pool().run(simulate);
+
+    return calculate_var(all_pnl, num_simulations, workspace.sorted(num_simulations));
+}
+
+void aggregate_positions_multi(const std::vector<Position>& positions,
+                               RiskWorkspace& workspace, AggregationResult* out) {
+    int num_threads = workspace.num_threads();
+    auto& partials = workspace.exposure_partials();
+    if (partials.size() != static_cast<size_t>(num_threads)) {
+        partials.resize(num_threads);
+    }
+    size_t chunk_size = (positions.size() + num_threads - 1) / num_threads;
+
+    auto aggregate = [&](int part) {
+        size_t start = std::min(part * chunk_size, positions.size());
+        size_t end = std::min(start + chunk_size, positions.size());
+        AggregationResult& local = partials[part];
+        reset_exposure(&local);
+
+        for (size_t i = start; i < end; ++i) {
+            const auto& pos = positions[i];
+            double notional = pos.quantity * pos.price;
+
+            NetExposure& exposure = exposure_for(&local, pos.symbol);
+            exposure.quantity += pos.quantity;
+            exposure.notional += notional;
+            exposure.position_count++;
+
+            if (notional > 0) {
+                local.total_long_exposure += notional;
+            } else {
+                local.total_short_exposure += std::abs(notional);
+            }
+            local.net_exposure += notional;
+            local.total_positions++;
+        }
+        erase_empty(&local);
+    };
+    workspace.pool().run(aggregate);
+
+    reset_exposure(out);
+    for (const auto& partial : partials) {
+        for (const auto& [symbol, exp] : partial.by_symbol) {
+            NetExposure& final_exp = exposure_for(out, symbol);
+            final_exp.quantity += exp.quantity;
+            final_exp.notional += exp.notional;
+            final_exp.position_count += exp.position_count;
+        }
+        out->total_long_exposure += partial.total_long_exposure;
+        out->total_short_exposure += partial.total_short_exposure;
+        out->net_exposure += partial.net_exposure;
+        out->total_positions += partial.total_positions;
+    }
+    erase_empty(out);
+
+    for (auto& [symbol, exp] : out->by_symbol) {
+        if (exp.quantity != 0.0) {
+            exp.avg_price = exp.notional / exp.quantity;
+        }
+    }
+}
+
+template void calculate_all_greeks_multi<PreciseNormal>(
+    const std::vector<Position>&, RiskWorkspace&, Greeks*, double);
+template void calculate_all_greeks_multi<FastNormal>(
+    const std::vector<Position>&, RiskWorkspace&, Greeks*, double);
+template VaRResult run_monte_carlo_multi<double>(
+    const McInputs&, size_t, RiskWorkspace&, unsigned int);
+template VaRResult run_monte_carlo_multi<float>(
+    const McInputsT<float>&, size_t, RiskWorkspace&, unsigned int);
+
+}  // namespace trading
@@ -0,0 +1,107 @@
+#ifndef LIB_RISK_WORKSPACE_H_
+#define LIB_RISK_WORKSPACE_H_
+
+#include "lib/aggregator.h"
+#include "lib/greeks.h"
+#include "lib/monte_carlo.h"
+#include "lib/position.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace trading {
+
+// Threads started once and reused for every parallel loop. A job is a
+// function pointer plus a context pointer, so dispatching one allocates
+// nothing (unlike spawning std::threads or wrapping it in std::function).
+class WorkerPool {
+public:
+    // num_threads counts the calling thread, which runs part 0 itself.
+    explicit WorkerPool(int num_threads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Runs fn(part) for every part in [0, num_threads()) and returns once
+    // all of them have finished. One run at a time.
+    template <typename Fn>
+    void run(Fn& fn) {
+        run_job(&invoke<Fn>, &fn);
+    }
+
+    int num_threads() const { return static_cast<int>(threads_.size()) + 1; }
+
+private:
+    using Job = void (*)(void* context, int part);
+
+    template <typename Fn>
+    static void invoke(void* context, int part) {
+        (*static_cast<Fn*>(context))(part);
+    }
+
+    void run_job(Job job, void* context);
+    void worker_loop(int part);
+
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    uint64_t generation_ = 0;
+    int pending_ = 0;
+    bool stopping_ = false;
+    Job job_ = nullptr;
+    void* context_ = nullptr;
+};
+
+// Everything a repeated risk run needs besides its inputs and outputs:
+// the worker pool, the combined P&L vector and its sort buffer, and one
+// private exposure map per thread. Buffers only grow, and the maps keep
+// their nodes between runs, so once a book has been run through the
+// workspace, running it again does not touch the heap.
+class RiskWorkspace {
+public:
+    explicit RiskWorkspace(int num_threads) : pool_(num_threads) {}
+
+    int num_threads() const { return pool_.num_threads(); }
+    WorkerPool& pool() { return pool_; }
+
+    // P&L and sort scratch for num_simulations scenarios.
+    double* pnl(size_t num_simulations);
+    double* sorted(size_t num_simulations);
+    std::vector<AggregationResult>& exposure_partials() { return exposure_partials_; }
+
+private:
+    WorkerPool pool_;
+    std::vector<double> pnl_;
+    std::vector<double> sorted_;
+    std::vector<AggregationResult> exposure_partials_;
+};
+
+// Same results as calculate_all_greeks_multi with the workspace's thread
+// count, written to out[0, positions.size()).
+template <typename NormalPolicy = PreciseNormal>
+void calculate_all_greeks_multi(const std::vector<Position>& positions,
+                                RiskWorkspace& workspace, Greeks* out,
+                                double bump_size = 0.01);
+
+// Bitwise the same as run_monte_carlo_multi(inputs, num_simulations,
+// workspace.num_threads(), seed). Instantiated for float and double.
+template <typename T>
+VaRResult run_monte_carlo_multi(const McInputsT<T>& inputs, size_t num_simulations,
+                                RiskWorkspace& workspace, unsigned int seed = 42);
+
+// Same result as aggregate_positions_multi with the workspace's thread
+// count. `out` is reused: entries of symbols still in the book are
+// overwritten in place and the others erased, so a result that is passed
+// back in every run stops allocating once it has seen the book's symbols.
+void aggregate_positions_multi(const std::vector<Position>& positions,
+                               RiskWorkspace& workspace, AggregationResult* out);
+
+}  // namespace trading
+
+#endif  // LIB_RISK_WORKSPACE_H_
@@ -0,0 +1,110 @@
+#include "lib/risk_workspace.h"
+
+#include "lib/memory_stats.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <vector>
+
+namespace trading {
+namespace {
+
+std::vector<Position> mixed_book(size_t count) {
+    auto positions = generate_random_positions(count, 77, 40);
+    for (size_t i = 0; i < positions.size(); i += 50) {
+        if (positions[i].type != PositionType::STOCK) {
+            positions[i].exercise = ExerciseStyle::AMERICAN;
+        }
+    }
+    return positions;
+}
+
+TEST(RiskWorkspaceTest, MatchesAllocatingVersions) {
+    auto positions = mixed_book(1500);
+    auto inputs = prepare_mc_inputs(positions, 1.0/252.0);
+    for (int threads : {1, 3, 4}) {
+        RiskWorkspace workspace(threads);
+        EXPECT_EQ(workspace.num_threads(), threads);
+
+        std::vector<Greeks> greeks(positions.size());
+        calculate_all_greeks_multi(positions, workspace, greeks.data());
+        auto expected_greeks = calculate_all_greeks_multi(positions, threads);
+        for (size_t i = 0; i < positions.size(); ++i) {
+            ASSERT_EQ(greeks[i].price, expected_greeks[i].price);
+            ASSERT_EQ(greeks[i].delta, expected_greeks[i].delta);
+        }
+
+        VaRResult var = run_monte_carlo_multi(inputs, 3001, workspace, 9);
+        VaRResult expected_var = run_monte_carlo_multi(inputs, 3001, threads, 9);
+        EXPECT_EQ(var.var_95, expected_var.var_95);
+        EXPECT_EQ(var.var_99, expected_var.var_99);
+        EXPECT_EQ(var.expected_shortfall, expected_var.expected_shortfall);
+        EXPECT_EQ(var.std_pnl, expected_var.std_pnl);
+
+        AggregationResult exposure;
+        aggregate_positions_multi(positions, workspace, &exposure);
+        AggregationResult expected = aggregate_positions_multi(positions, threads);
+        EXPECT_EQ(exposure.net_exposure, expected.net_exposure);
+        EXPECT_EQ(exposure.total_positions, expected.total_positions);
+        ASSERT_EQ(exposure.by_symbol.size(), expected.by_symbol.size());
+        for (const auto& [symbol, exp] : expected.by_symbol) {
+            const NetExposure& actual = exposure.by_symbol.at(symbol);
+            EXPECT_EQ(actual.notional, exp.notional);
+            EXPECT_EQ(actual.avg_price, exp.avg_price);
+            EXPECT_EQ(actual.position_count, exp.position_count);
+        }
+    }
+}
+
+TEST(RiskWorkspaceTest, ReusedResultDropsSymbolsThatLeftTheBook) {
+    auto positions = mixed_book(300);
+    RiskWorkspace workspace(2);
+    AggregationResult exposure;
+    aggregate_positions_multi(positions, workspace, &exposure);
+
+    positions.resize(10);
+    aggregate_positions_multi(positions, workspace, &exposure);
+    AggregationResult expected = aggregate_positions_single(positions);
+    EXPECT_EQ(exposure.by_symbol.size(), expected.by_symbol.size());
+    EXPECT_EQ(exposure.total_positions, 10);
+    for (const auto& [symbol, exp] : expected.by_symbol) {
+        EXPECT_EQ(exposure.by_symbol.at(symbol).position_count, exp.position_count);
+    }
+}
+
+TEST(RiskWorkspaceTest, SteadyStateDoesNotAllocate) {
+    auto positions = mixed_book(2000);
+    auto inputs = prepare_mc_inputs(positions, 1.0/252.0);
+    RiskWorkspace workspace(4);
+    std::vector<Greeks> greeks(positions.size());
+    AggregationResult exposure;
+
+    double checksum = 0.0;
+    auto run_once = [&](unsigned int seed) {
+        calculate_all_greeks_multi(positions, workspace, greeks.data());
+        VaRResult var = run_monte_carlo_multi(inputs, 2000, workspace, seed);
+        aggregate_positions_multi(positions, workspace, &exposure);
+        checksum += greeks[0].price + var.var_99 + exposure.net_exposure;
+    };
+
+    ASSERT_TRUE(allocation_hook_installed());
+    run_once(1);  // Warm-up: buffers, maps and thread-local lattices grow
+    uint64_t before = allocation_counts().allocations;
+    set_allocation_counting(true);
+    for (unsigned int seed = 2; seed < 7; ++seed) {
+        run_once(seed);
+    }
+    set_allocation_counting(false);
+    EXPECT_EQ(allocation_counts().allocations, before);
+    EXPECT_TRUE(std::isfinite(checksum));
+
+    // The hook itself works.
+    set_allocation_counting(true);
+    auto allocating = calculate_all_greeks_multi(positions, 2);
+    set_allocation_counting(false);
+    EXPECT_GT(allocation_counts().allocations, before);
+    EXPECT_EQ(allocating.size(), positions.size());
+}
+
+}  // namespace
+}  // namespace trading
@@ -0,0 +1,89 @@
+#include "lib/rollup.h"
+
+#include <algorithm>
+
+namespace trading {
+
+GreeksRollupAccumulator::GreeksRollupAccumulator(size_t num_symbols,
+                                                 const RollupConfig& config)
+    : config_(config),
+      symbol_base_(1),
+      expiry_base_(symbol_base_ + num_symbols),
+      strike_base_(expiry_base_ + config.expiry_edges.size() + 1),
+      buckets_(strike_base_ + config.moneyness_edges.size() + 1) {}
+
+void GreeksRollupAccumulator::merge(const GreeksRollupAccumulator& other) {
+    for (size_t b = 0; b < buckets_.size(); ++b) {
+        GreeksBucket& dst = buckets_[b];
+        const GreeksBucket& src = other.buckets_[b];
+        dst.delta += src.delta;
+        dst.gamma += src.gamma;
+        dst.vega += src.vega;
+        dst.theta += src.theta;
+        dst.market_value += src.market_value;
+        dst.position_count += src.position_count;
+    }
+}
+
+GreeksRollup GreeksRollupAccumulator::to_rollup() const {
+    GreeksRollup result;
+    result.total = buckets_[0];
+    result.by_symbol.assign(buckets_.begin() + symbol_base_,
+                            buckets_.begin() + expiry_base_);
+    result.by_expiry.assign(buckets_.begin() + expiry_base_,
+                            buckets_.begin() + strike_base_);
+    result.by_strike.assign(buckets_.begin() + strike_base_, buckets_.end());
+    return result;
+}
+
+template <typename NormalPolicy>
+GreeksRollup calculate_greeks_rollup_single(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, size_t num_symbols,
+    const RollupConfig& config, double bump_size) {
+    GreeksRollupAccumulator buckets(num_symbols, config);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        buckets.add(positions[i], symbol_ids[i],
+                    calculate_greeks<NormalPolicy>(positions[i], bump_size));
+    }
+    return buckets.to_rollup();
+}
+
+template <typename NormalPolicy>
+GreeksRollup calculate_greeks_rollup_multi(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, size_t num_symbols,
+    int num_threads, const RollupConfig& config, double bump_size) {
+    std::vector<GreeksRollupAccumulator> per_thread;
+    per_thread.reserve(num_threads);
+    for (int t = 0; t < num_threads; ++t) {
+        per_thread.emplace_back(num_symbols, config);
+    }
+
+    for_each_greeks_multi<NormalPolicy>(
+        positions, num_threads,
+        [&](int chunk, size_t i, const Greeks& g) {
+            per_thread[chunk].add(positions[i], symbol_ids[i], g);
+        },
+        bump_size);
+
+    for (int t = 1; t < num_threads; ++t) {
+        per_thread[0].merge(per_thread[t]);
+    }
+    return per_thread[0].to_rollup();
+}
+
+template GreeksRollup calculate_greeks_rollup_single<PreciseNormal>(
+    const std::vector<Position>&, const std::vector<uint32_t>&, size_t,
+    const RollupConfig&, double);
+template GreeksRollup calculate_greeks_rollup_single<FastNormal>(
+    const std::vector<Position>&, const std::vector<uint32_t>&, size_t,
+    const RollupConfig&, double);
+template GreeksRollup calculate_greeks_rollup_multi<PreciseNormal>(
+    const std::vector<Position>&, const std::vector<uint32_t>&, size_t, int,
+    const RollupConfig&, double);
+template GreeksRollup calculate_greeks_rollup_multi<FastNormal>(
+    const std::vector<Position>&, const std::vector<uint32_t>&, size_t, int,
+    const RollupConfig&, double);
+
+}  // namespace trading
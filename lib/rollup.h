@@ -0,0 +1,102 @@
+#ifndef LIB_ROLLUP_H_
+#define LIB_ROLLUP_H_
+
+#include "lib/greeks.h"
+#include "lib/position.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+// Quantity-weighted Greeks for one bucket.
+struct GreeksBucket {
+    double delta = 0.0;
+    double gamma = 0.0;
+    double vega = 0.0;
+    double theta = 0.0;
+    double market_value = 0.0;
+    int position_count = 0;
+};
+
+struct RollupConfig {
+    // Bucket b covers [edges[b-1], edges[b]); edges.size() + 1 buckets.
+    std::vector<double> expiry_edges{0.25, 0.5, 1.0};           // Years
+    std::vector<double> moneyness_edges{0.9, 0.97, 1.03, 1.1};  // Strike / spot
+};
+
+// Stocks count towards their symbol and the total only; the expiry and
+// strike ladders cover options.
+struct GreeksRollup {
+    GreeksBucket total;
+    std::vector<GreeksBucket> by_symbol;  // Indexed by SymbolTable id
+    std::vector<GreeksBucket> by_expiry;
+    std::vector<GreeksBucket> by_strike;
+};
+
+// One thread's buckets, laid out flat as [total | symbols | expiry |
+// strike] so a reduction touches one contiguous array.
+class GreeksRollupAccumulator {
+public:
+    GreeksRollupAccumulator(size_t num_symbols, const RollupConfig& config);
+
+    void add(const Position& pos, uint32_t symbol_id, const Greeks& g) {
+        double qty = pos.quantity;
+        accumulate(buckets_[0], qty, g);
+        accumulate(buckets_[symbol_base_ + symbol_id], qty, g);
+
+        if (pos.type != PositionType::STOCK) {
+            accumulate(buckets_[expiry_base_ +
+                                bucket_of(config_.expiry_edges, pos.time_to_expiry)],
+                       qty, g);
+            accumulate(buckets_[strike_base_ +
+                                bucket_of(config_.moneyness_edges,
+                                          pos.strike / pos.price)],
+                       qty, g);
+        }
+    }
+
+    void merge(const GreeksRollupAccumulator& other);
+    GreeksRollup to_rollup() const;
+
+private:
+    static size_t bucket_of(const std::vector<double>& edges, double value) {
+        return std::upper_bound(edges.begin(), edges.end(), value) - edges.begin();
+    }
+
+    static void accumulate(GreeksBucket& bucket, double qty, const Greeks& g) {
+        bucket.delta += g.delta * qty;
+        bucket.gamma += g.gamma * qty;
+        bucket.vega += g.vega * qty;
+        bucket.theta += g.theta * qty;
+        bucket.market_value += g.price * qty;
+        ++bucket.position_count;
+    }
+
+    RollupConfig config_;
+    size_t symbol_base_;
+    size_t expiry_base_;
+    size_t strike_base_;
+    std::vector<GreeksBucket> buckets_;
+};
+
+// `symbol_ids` comes from intern_symbols() and is reusable for as long as
+// the book's symbols do not change. Positions are priced and bucketed in
+// one traversal; each thread reduces into its own accumulator and the
+// accumulators are merged at the end.
+template <typename NormalPolicy = PreciseNormal>
+GreeksRollup calculate_greeks_rollup_single(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, size_t num_symbols,
+    const RollupConfig& config = {}, double bump_size = 0.01);
+
+template <typename NormalPolicy = PreciseNormal>
+GreeksRollup calculate_greeks_rollup_multi(
+    const std::vector<Position>& positions,
+    const std::vector<uint32_t>& symbol_ids, size_t num_symbols,
+    int num_threads, const RollupConfig& config = {}, double bump_size = 0.01);
+
+}  // namespace trading
+
+#endif  // LIB_ROLLUP_H_
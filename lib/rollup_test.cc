@@ -0,0 +1,88 @@
+#include "lib/rollup.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+TEST(SymbolTableTest, InternsInFirstSeenOrder) {
+    SymbolTable table;
+    EXPECT_EQ(table.intern("MSFT"), 0u);
+    EXPECT_EQ(table.intern("AAPL"), 1u);
+    EXPECT_EQ(table.intern("MSFT"), 0u);
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_EQ(table.name(1), "AAPL");
+    EXPECT_EQ(table.find("AAPL"), 1);
+    EXPECT_EQ(table.find("GOOG"), -1);
+}
+
+TEST(GreeksRollupTest, BucketsOptionsByExpiryAndMoneyness) {
+    std::vector<Position> positions = {
+        {.symbol = "AAPL", .quantity = 100, .price = 150.0, .volatility = 0.3,
+         .type = PositionType::STOCK, .strike = 0, .time_to_expiry = 0, .risk_free_rate = 0.05},
+        {.symbol = "AAPL", .quantity = 10, .price = 150.0, .volatility = 0.3,
+         .type = PositionType::OPTION_CALL, .strike = 150.0, .time_to_expiry = 0.1, .risk_free_rate = 0.05},
+        {.symbol = "MSFT", .quantity = -5, .price = 300.0, .volatility = 0.25,
+         .type = PositionType::OPTION_PUT, .strike = 240.0, .time_to_expiry = 1.5, .risk_free_rate = 0.05},
+    };
+    SymbolTable symbols;
+    auto ids = intern_symbols(positions, &symbols);
+
+    auto rollup = calculate_greeks_rollup_single(positions, ids, symbols.size());
+
+    ASSERT_EQ(rollup.by_symbol.size(), 2u);
+    EXPECT_EQ(rollup.by_symbol[0].position_count, 2);
+    EXPECT_EQ(rollup.by_symbol[1].position_count, 1);
+    EXPECT_EQ(rollup.total.position_count, 3);
+
+    ASSERT_EQ(rollup.by_expiry.size(), 4u);
+    EXPECT_EQ(rollup.by_expiry[0].position_count, 1);  // 0.1y
+    EXPECT_EQ(rollup.by_expiry[3].position_count, 1);  // 1.5y
+
+    ASSERT_EQ(rollup.by_strike.size(), 5u);
+    EXPECT_EQ(rollup.by_strike[2].position_count, 1);  // At the money
+    EXPECT_EQ(rollup.by_strike[0].position_count, 1);  // 0.8 moneyness
+
+    Greeks call = calculate_greeks(positions[1]);
+    EXPECT_NEAR(rollup.by_expiry[0].delta, 10 * call.delta, 1e-12);
+    EXPECT_NEAR(rollup.by_symbol[0].delta, 100.0 + 10 * call.delta, 1e-9);
+}
+
+TEST(GreeksRollupTest, MatchesPerPositionGreeks) {
+    auto positions = generate_random_positions(2000, 11);
+    SymbolTable symbols;
+    auto ids = intern_symbols(positions, &symbols);
+
+    auto greeks = calculate_all_greeks_single(positions);
+    double delta = total_portfolio_delta(greeks, positions);
+    double vega = 0.0;
+    for (size_t i = 0; i < positions.size(); ++i) {
+        vega += greeks[i].vega * positions[i].quantity;
+    }
+
+    auto single = calculate_greeks_rollup_single(positions, ids, symbols.size());
+    auto multi = calculate_greeks_rollup_multi(positions, ids, symbols.size(), 4);
+
+    EXPECT_NEAR(single.total.delta, delta, 1e-9 * std::abs(delta));
+    EXPECT_NEAR(single.total.vega, vega, 1e-9 * std::abs(vega));
+    EXPECT_NEAR(multi.total.delta, delta, 1e-9 * std::abs(delta));
+    EXPECT_EQ(multi.total.position_count, 2000);
+
+    double symbol_delta = 0.0;
+    int symbol_count = 0;
+    for (const auto& b : multi.by_symbol) {
+        symbol_delta += b.delta;
+        symbol_count += b.position_count;
+    }
+    EXPECT_NEAR(symbol_delta, delta, 1e-9 * std::abs(delta));
+    EXPECT_EQ(symbol_count, 2000);
+
+    for (size_t s = 0; s < single.by_symbol.size(); ++s) {
+        EXPECT_NEAR(multi.by_symbol[s].gamma, single.by_symbol[s].gamma,
+                    1e-9 * (1.0 + std::abs(single.by_symbol[s].gamma)));
+    }
+}
+
+}  // namespace
+}  // namespace trading
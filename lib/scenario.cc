@@ -0,0 +1,291 @@
+#include "lib/scenario.h"
+
+#include "lib/greeks.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace trading {
+
+namespace {
+
+// Per-scenario terms that do not depend on the option, shared by every
+// position revalued under the same grid.
+struct PreparedGrid {
+    std::vector<double> spot_shock;
+    std::vector<double> log_spot_mult;
+    std::vector<double> vol_shock;
+    std::vector<uint32_t> time_index;
+    std::vector<double> time_shifts;  // Unique shifts referenced by time_index
+};
+
+struct ScenarioBook {
+    std::vector<std::string> symbols;
+    std::vector<uint32_t> symbol_of;       // Position -> symbol id
+    std::vector<uint32_t> grid_of_symbol;  // Symbol id -> prepared grid
+    std::vector<PreparedGrid> grids;
+    size_t num_scenarios;
+};
+
+PreparedGrid prepare_grid(const std::vector<Scenario>& scenarios) {
+    PreparedGrid grid;
+    grid.spot_shock.reserve(scenarios.size());
+    grid.log_spot_mult.reserve(scenarios.size());
+    grid.vol_shock.reserve(scenarios.size());
+    grid.time_index.reserve(scenarios.size());
+
+    for (const auto& s : scenarios) {
+        grid.spot_shock.push_back(s.spot_shock);
+        grid.log_spot_mult.push_back(std::log1p(s.spot_shock));
+        grid.vol_shock.push_back(s.vol_shock);
+
+        auto it = std::find(grid.time_shifts.begin(), grid.time_shifts.end(),
+                            s.time_shift);
+        if (it == grid.time_shifts.end()) {
+            grid.time_shifts.push_back(s.time_shift);
+            it = grid.time_shifts.end() - 1;
+        }
+        grid.time_index.push_back(
+            static_cast<uint32_t>(it - grid.time_shifts.begin()));
+    }
+
+    return grid;
+}
+
+ScenarioBook prepare_book(const std::vector<Position>& positions,
+                          const ScenarioGrid& grid) {
+    ScenarioBook book;
+    book.num_scenarios = grid.scenarios.size();
+    book.grids.push_back(prepare_grid(grid.scenarios));
+    book.symbol_of.reserve(positions.size());
+
+    std::unordered_map<std::string, uint32_t> ids;
+    for (const auto& pos : positions) {
+        auto [it, inserted] = ids.emplace(
+            pos.symbol, static_cast<uint32_t>(book.symbols.size()));
+        if (inserted) {
+            book.symbols.push_back(pos.symbol);
+            book.grid_of_symbol.push_back(0);
+
+            auto override_it = grid.by_symbol.find(pos.symbol);
+            if (override_it != grid.by_symbol.end()) {
+                if (override_it->second.size() != book.num_scenarios) {
+                    throw std::invalid_argument(
+                        "scenario override for " + pos.symbol +
+                        " does not match the grid size");
+                }
+                book.grid_of_symbol.back() =
+                    static_cast<uint32_t>(book.grids.size());
+                book.grids.push_back(prepare_grid(override_it->second));
+            }
+        }
+        book.symbol_of.push_back(it->second);
+    }
+
+    return book;
+}
+
+// Revalues one position under scenarios [begin, end) and adds its P&L to
+// pnl[begin..end). The option's log-moneyness, base price and per-time-shift
+// sqrt/discount terms are computed once and shared by every scenario.
+void revalue_position(const Position& pos, const PreparedGrid& grid,
+                      size_t begin, size_t end, double* pnl,
+                      std::vector<double>& scratch) {
+    if (pos.type == PositionType::STOCK) {
+        double notional = pos.quantity * pos.price;
+        for (size_t s = begin; s < end; ++s) {
+            pnl[s] += notional * grid.spot_shock[s];
+        }
+        return;
+    }
+
+    bool is_call = (pos.type == PositionType::OPTION_CALL);
+    double strike = pos.strike;
+    double rate = pos.risk_free_rate;
+    double base = black_scholes_price(pos.price, strike, pos.volatility,
+                                      rate, pos.time_to_expiry, is_call);
+    double log_moneyness = std::log(pos.price / strike);
+
+    size_t num_times = grid.time_shifts.size();
+    scratch.resize(3 * num_times);
+    double* times = scratch.data();
+    double* sqrt_times = times + num_times;
+    double* strike_discounts = sqrt_times + num_times;
+    for (size_t u = 0; u < num_times; ++u) {
+        times[u] = pos.time_to_expiry - grid.time_shifts[u];
+        sqrt_times[u] = times[u] > 0.0 ? std::sqrt(times[u]) : 0.0;
+        strike_discounts[u] = strike * std::exp(-rate * times[u]);
+    }
+
+    for (size_t s = begin; s < end; ++s) {
+        double spot = pos.price * (1.0 + grid.spot_shock[s]);
+        double vol = pos.volatility + grid.vol_shock[s];
+        uint32_t u = grid.time_index[s];
+        double time = times[u];
+
+        double price;
+        if (time <= 0.0 || vol <= 0.0) {
+            price = is_call ? std::max(spot - strike, 0.0)
+                            : std::max(strike - spot, 0.0);
+        } else {
+            double vol_sqrt_t = vol * sqrt_times[u];
+            double d1 = (log_moneyness + grid.log_spot_mult[s] +
+                         (rate + 0.5 * vol * vol) * time) / vol_sqrt_t;
+            double d2 = d1 - vol_sqrt_t;
+            if (is_call) {
+                price = spot * normal_cdf(d1) -
+                        strike_discounts[u] * normal_cdf(d2);
+            } else {
+                price = strike_discounts[u] * normal_cdf(-d2) -
+                        spot * normal_cdf(-d1);
+            }
+        }
+
+        pnl[s] += pos.quantity * (price - base);
+    }
+}
+
+ScenarioResult collect_result(const ScenarioBook& book,
+                              const std::vector<double>& symbol_pnl) {
+    size_t num_scenarios = book.num_scenarios;
+
+    ScenarioResult result;
+    result.portfolio_pnl.assign(num_scenarios, 0.0);
+    result.pnl_by_symbol.reserve(book.symbols.size());
+
+    for (size_t sym = 0; sym < book.symbols.size(); ++sym) {
+        auto row_begin = symbol_pnl.begin() + sym * num_scenarios;
+        for (size_t s = 0; s < num_scenarios; ++s) {
+            result.portfolio_pnl[s] += row_begin[s];
+        }
+        result.pnl_by_symbol.emplace(
+            book.symbols[sym],
+            std::vector<double>(row_begin, row_begin + num_scenarios));
+    }
+
+    return result;
+}
+
+}  // namespace
+
+std::vector<Scenario> make_spot_vol_grid(const std::vector<double>& spot_shocks,
+                                         const std::vector<double>& vol_shocks,
+                                         double time_shift) {
+    std::vector<Scenario> scenarios;
+    scenarios.reserve(spot_shocks.size() * vol_shocks.size());
+
+    for (double vol_shock : vol_shocks) {
+        for (double spot_shock : spot_shocks) {
+            scenarios.push_back({spot_shock, vol_shock, time_shift});
+        }
+    }
+
+    return scenarios;
+}
+
+ScenarioResult run_scenarios_single(const std::vector<Position>& positions,
+                                    const ScenarioGrid& grid) {
+    ScenarioBook book = prepare_book(positions, grid);
+    size_t num_scenarios = book.num_scenarios;
+
+    std::vector<double> symbol_pnl(book.symbols.size() * num_scenarios, 0.0);
+    std::vector<double> scratch;
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        uint32_t sym = book.symbol_of[i];
+        revalue_position(positions[i], book.grids[book.grid_of_symbol[sym]],
+                         0, num_scenarios,
+                         symbol_pnl.data() + sym * num_scenarios, scratch);
+    }
+
+    return collect_result(book, symbol_pnl);
+}
+
+ScenarioResult run_scenarios_multi(const std::vector<Position>& positions,
+                                   const ScenarioGrid& grid,
+                                   int num_threads) {
+    ScenarioBook book = prepare_book(positions, grid);
+    size_t num_scenarios = book.num_scenarios;
+    size_t num_symbols = book.symbols.size();
+
+    // Counting sort by symbol so each symbol's positions are contiguous and
+    // every (symbol range, scenario range) tile owns a disjoint output block.
+    std::vector<size_t> symbol_offsets(num_symbols + 1, 0);
+    for (uint32_t sym : book.symbol_of) {
+        symbol_offsets[sym + 1]++;
+    }
+    for (size_t sym = 0; sym < num_symbols; ++sym) {
+        symbol_offsets[sym + 1] += symbol_offsets[sym];
+    }
+    std::vector<size_t> order(positions.size());
+    std::vector<size_t> cursor(symbol_offsets.begin(), symbol_offsets.end() - 1);
+    for (size_t i = 0; i < positions.size(); ++i) {
+        order[cursor[book.symbol_of[i]]++] = i;
+    }
+
+    // Group symbols into runs of roughly equal position counts, then split
+    // the scenarios so there are a few tiles per thread for load balancing.
+    size_t target_tiles = static_cast<size_t>(num_threads) * 4;
+    size_t positions_per_group =
+        std::max<size_t>(1, positions.size() / target_tiles);
+    std::vector<size_t> group_bounds = {0};
+    for (size_t sym = 0; sym < num_symbols; ++sym) {
+        if (symbol_offsets[sym + 1] - symbol_offsets[group_bounds.back()] >=
+            positions_per_group) {
+            group_bounds.push_back(sym + 1);
+        }
+    }
+    if (group_bounds.back() != num_symbols) {
+        group_bounds.push_back(num_symbols);
+    }
+    size_t num_groups = group_bounds.size() - 1;
+    size_t scenario_chunks = std::min(
+        std::max<size_t>(1, num_scenarios),
+        std::max<size_t>(1, (target_tiles + num_groups - 1) /
+                                std::max<size_t>(1, num_groups)));
+    size_t scenarios_per_chunk =
+        (num_scenarios + scenario_chunks - 1) / scenario_chunks;
+    size_t num_tiles = num_groups * scenario_chunks;
+
+    std::vector<double> symbol_pnl(num_symbols * num_scenarios, 0.0);
+    std::atomic<size_t> next_tile{0};
+
+    auto worker = [&]() {
+        std::vector<double> scratch;
+        for (size_t tile = next_tile.fetch_add(1); tile < num_tiles;
+             tile = next_tile.fetch_add(1)) {
+            size_t group = tile / scenario_chunks;
+            size_t s_begin = (tile % scenario_chunks) * scenarios_per_chunk;
+            size_t s_end = std::min(s_begin + scenarios_per_chunk, num_scenarios);
+
+            for (size_t sym = group_bounds[group]; sym < group_bounds[group + 1];
+                 ++sym) {
+                const PreparedGrid& prepared = book.grids[book.grid_of_symbol[sym]];
+                double* row = symbol_pnl.data() + sym * num_scenarios;
+                for (size_t k = symbol_offsets[sym]; k < symbol_offsets[sym + 1];
+                     ++k) {
+                    revalue_position(positions[order[k]], prepared,
+                                     s_begin, s_end, row, scratch);
+                }
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(worker);
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    return collect_result(book, symbol_pnl);
+}
+
+}  // namespace trading
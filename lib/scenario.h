@@ -0,0 +1,44 @@
+#ifndef LIB_SCENARIO_H_
+#define LIB_SCENARIO_H_
+
+#include "lib/position.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace trading {
+
+struct Scenario {
+    double spot_shock;  // Relative spot move (-0.05 = -5%)
+    double vol_shock;   // Absolute vol move (0.05 = +5 vol points)
+    double time_shift;  // Years elapsed before revaluation
+};
+
+struct ScenarioGrid {
+    // Shocks applied to every underlying
+    std::vector<Scenario> scenarios;
+    // Per-underlying shocks; each must hold one entry per scenario
+    std::unordered_map<std::string, std::vector<Scenario>> by_symbol;
+};
+
+struct ScenarioResult {
+    std::vector<double> portfolio_pnl;  // One entry per scenario
+    std::unordered_map<std::string, std::vector<double>> pnl_by_symbol;
+};
+
+// Cartesian product of spot and vol shocks at a fixed time shift
+std::vector<Scenario> make_spot_vol_grid(const std::vector<double>& spot_shocks,
+                                         const std::vector<double>& vol_shocks,
+                                         double time_shift = 0.0);
+
+ScenarioResult run_scenarios_single(const std::vector<Position>& positions,
+                                    const ScenarioGrid& grid);
+
+ScenarioResult run_scenarios_multi(const std::vector<Position>& positions,
+                                   const ScenarioGrid& grid,
+                                   int num_threads);
+
+}  // namespace trading
+
+#endif  // LIB_SCENARIO_H_
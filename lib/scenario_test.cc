@@ -0,0 +1,91 @@
+#include "lib/scenario.h"
+
+#include "lib/greeks.h"
+
+#include <gtest/gtest.h>
+#include <cmath>
+
+namespace trading {
+namespace {
+
+TEST(ScenarioTest, SpotVolGridSize) {
+    auto scenarios = make_spot_vol_grid({-0.1, 0.0, 0.1}, {-0.05, 0.05}, 0.01);
+
+    ASSERT_EQ(scenarios.size(), 6);
+    EXPECT_EQ(scenarios[0].spot_shock, -0.1);
+    EXPECT_EQ(scenarios[0].vol_shock, -0.05);
+    EXPECT_EQ(scenarios[5].spot_shock, 0.1);
+    EXPECT_EQ(scenarios[5].time_shift, 0.01);
+}
+
+TEST(ScenarioTest, StockPnL) {
+    std::vector<Position> positions = {
+        {.symbol = "AAPL", .quantity = 100, .price = 150.0, .volatility = 0.3,
+         .type = PositionType::STOCK, .strike = 0, .time_to_expiry = 0, .risk_free_rate = 0.05}
+    };
+    ScenarioGrid grid;
+    grid.scenarios = make_spot_vol_grid({-0.1, 0.2}, {0.0});
+
+    auto result = run_scenarios_single(positions, grid);
+
+    ASSERT_EQ(result.portfolio_pnl.size(), 2);
+    EXPECT_NEAR(result.portfolio_pnl[0], -1500.0, 1e-9);
+    EXPECT_NEAR(result.portfolio_pnl[1], 3000.0, 1e-9);
+}
+
+TEST(ScenarioTest, MatchesDirectRevaluation) {
+    Position option{.symbol = "AAPL", .quantity = 10, .price = 150.0,
+                    .volatility = 0.3, .type = PositionType::OPTION_PUT,
+                    .strike = 155.0, .time_to_expiry = 0.5, .risk_free_rate = 0.05};
+    ScenarioGrid grid;
+    grid.scenarios = make_spot_vol_grid({-0.2, -0.05, 0.0, 0.15}, {-0.05, 0.05},
+                                        5.0 / 365.0);
+
+    auto result = run_scenarios_single({option}, grid);
+
+    double base = black_scholes_price(150.0, 155.0, 0.3, 0.05, 0.5, false);
+    for (size_t s = 0; s < grid.scenarios.size(); ++s) {
+        const auto& sc = grid.scenarios[s];
+        double shocked = black_scholes_price(
+            150.0 * (1.0 + sc.spot_shock), 155.0, 0.3 + sc.vol_shock, 0.05,
+            0.5 - sc.time_shift, false);
+        EXPECT_NEAR(result.portfolio_pnl[s], 10 * (shocked - base), 1e-8);
+    }
+}
+
+TEST(ScenarioTest, PerSymbolOverride) {
+    std::vector<Position> positions = {
+        {.symbol = "AAPL", .quantity = 100, .price = 100.0, .volatility = 0.3,
+         .type = PositionType::STOCK, .strike = 0, .time_to_expiry = 0, .risk_free_rate = 0.05},
+        {.symbol = "MSFT", .quantity = 100, .price = 100.0, .volatility = 0.3,
+         .type = PositionType::STOCK, .strike = 0, .time_to_expiry = 0, .risk_free_rate = 0.05}
+    };
+    ScenarioGrid grid;
+    grid.scenarios = {{0.1, 0.0, 0.0}};
+    grid.by_symbol["MSFT"] = {{-0.2, 0.0, 0.0}};
+
+    auto result = run_scenarios_single(positions, grid);
+
+    EXPECT_NEAR(result.pnl_by_symbol["AAPL"][0], 1000.0, 1e-9);
+    EXPECT_NEAR(result.pnl_by_symbol["MSFT"][0], -2000.0, 1e-9);
+    EXPECT_NEAR(result.portfolio_pnl[0], -1000.0, 1e-9);
+}
+
+TEST(ScenarioTest, MultiThreadedConsistency) {
+    auto positions = generate_random_positions(1000, 42);
+    ScenarioGrid grid;
+    grid.scenarios = make_spot_vol_grid({-0.2, -0.1, -0.01, 0.01, 0.1, 0.2},
+                                        {-0.05, 0.0, 0.05}, 1.0 / 365.0);
+
+    auto single_result = run_scenarios_single(positions, grid);
+    auto multi_result = run_scenarios_multi(positions, grid, 4);
+
+    ASSERT_EQ(single_result.portfolio_pnl.size(), multi_result.portfolio_pnl.size());
+    EXPECT_EQ(single_result.pnl_by_symbol.size(), multi_result.pnl_by_symbol.size());
+    for (size_t s = 0; s < single_result.portfolio_pnl.size(); ++s) {
+        EXPECT_EQ(single_result.portfolio_pnl[s], multi_result.portfolio_pnl[s]);
+    }
+}
+
+}  // namespace
+}  // namespace trading
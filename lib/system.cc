@@ -11,8 +11,11 @@
 #ifdef HAVE_NUMA
 #include <numa.h>
 #endif
+#include <linux/perf_event.h>
 #include <sched.h>
+#include <sys/ioctl.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/resource.h>
 #include <unistd.h>
 #endif
@@ -306,4 +309,52 @@ std::vector<int> parse_cpu_list(const std::string& cpu_str) {
     return cpus;
 }
 
+PerfCounter::PerfCounter(Event event) {
+#ifdef __linux__
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (event) {
+        case Event::CYCLES:        attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case Event::INSTRUCTIONS:  attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case Event::BRANCHES:      attr.config = PERF_COUNT_HW_BRANCH_INSTRUCTIONS; break;
+        case Event::BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    }
+    attr.disabled = 1;
+    attr.inherit = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+    (void)event;
+#endif
+}
+
+PerfCounter::~PerfCounter() {
+#ifdef __linux__
+    if (fd_ >= 0) close(fd_);
+#endif
+}
+
+void PerfCounter::start() {
+#ifdef __linux__
+    if (fd_ < 0) return;
+    ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+}
+
+uint64_t PerfCounter::stop() {
+#ifdef __linux__
+    if (fd_ < 0) return 0;
+    ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    uint64_t count = 0;
+    if (read(fd_, &count, sizeof(count)) != sizeof(count)) return 0;
+    return count;
+#else
+    return 0;
+#endif
+}
+
 }  // namespace trading
@@ -1,6 +1,7 @@
 #ifndef LIB_SYSTEM_H_
 #define LIB_SYSTEM_H_
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -56,6 +57,31 @@ void print_applied_config(const SystemConfig& config);
 // Parse CPU list string (e.g., "0,1,2" or "0-3" or "0,2-4")
 std::vector<int> parse_cpu_list(const std::string& cpu_str);
 
+// Hardware event counter (Linux perf_event_open) for the calling thread and
+// any threads it starts while counting. Not available on other platforms,
+// in most containers, or when kernel.perf_event_paranoid forbids it.
+class PerfCounter {
+public:
+    enum class Event { CYCLES, INSTRUCTIONS, BRANCHES, BRANCH_MISSES };
+
+    explicit PerfCounter(Event event);
+    ~PerfCounter();
+
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    bool available() const { return fd_ >= 0; }
+
+    // Resets and enables the counter.
+    void start();
+    // Disables the counter and returns the events since start(); 0 if
+    // unavailable.
+    uint64_t stop();
+
+private:
+    int fd_ = -1;
+};
+
 }  // namespace trading
 
 #endif  // LIB_SYSTEM_H_
@@ -0,0 +1,161 @@
+#include "lib/var_attribution.h"
+
+#include "lib/chunked_mc.h"
+#include "lib/random.h"
+#include "lib/reduction.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <thread>
+
+namespace trading {
+
+namespace {
+
+enum TailSet : unsigned {
+    kEsTail = 1u << 0,
+    kVar99Window = 1u << 1,
+    kVar95Window = 1u << 2,
+};
+
+struct TrackedScenario {
+    uint64_t scenario;
+    unsigned sets;
+};
+
+// Splits [0, total) into one contiguous chunk per thread, with chunk
+// boundaries on multiples of `align`, and runs fn(begin, end) on each.
+template <typename Fn>
+void run_in_chunks(size_t total, size_t num_threads, size_t align, Fn fn) {
+    size_t units = (total + align - 1) / align;
+    num_threads = std::max<size_t>(1, std::min(num_threads, units));
+    size_t per_thread = units / num_threads;
+    size_t remainder = units % num_threads;
+
+    std::vector<std::thread> threads;
+    size_t begin = 0;
+    for (size_t t = 0; t < num_threads; ++t) {
+        size_t end = std::min(total, begin + (per_thread + (t < remainder ? 1 : 0)) * align);
+        if (t + 1 == num_threads) {
+            fn(begin, end);
+        } else {
+            threads.emplace_back(fn, begin, end);
+        }
+        begin = end;
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+double allocate(double total, double share, double sample_sum) {
+    return sample_sum != 0.0 ? total * share / sample_sum : 0.0;
+}
+
+}  // namespace
+
+VaRAttribution attribute_var(const std::vector<Position>& positions,
+                             const VaRAttributionConfig& config) {
+    McInputs inputs = prepare_mc_inputs(positions, config.time_horizon);
+    size_t n = positions.size();
+    uint64_t num_sims = config.num_simulations;
+    size_t num_threads = static_cast<size_t>(std::max(config.num_threads, 1));
+
+    VaRAttribution result{};
+    result.component.assign(n, ComponentRisk{});
+    result.marginal.assign(n, ComponentRisk{});
+    std::vector<uint32_t> symbol_ids = intern_symbols(positions, &result.symbols);
+    result.by_symbol.assign(result.symbols.size(), ComponentRisk{});
+    if (num_sims == 0) {
+        result.portfolio = calculate_var({});
+        return result;
+    }
+
+    // Pass 1: portfolio P&L only.
+    std::vector<double> pnl(num_sims);
+    run_in_chunks(num_sims, num_threads, 1, [&](size_t begin, size_t end) {
+        simulate_pnl_scenarios(inputs, config.seed, begin, end - begin, pnl.data() + begin);
+    });
+    result.portfolio = calculate_var(pnl);
+
+    // Rank the worst scenarios (ties broken by index, so the tail set is
+    // well defined) down to the far edge of the 95% neighbourhood.
+    size_t idx_95 = static_cast<size_t>(num_sims * 0.05);
+    size_t idx_99 = static_cast<size_t>(num_sims * 0.01);
+    size_t half = std::max<size_t>(1, static_cast<size_t>(config.var_window * num_sims));
+    size_t deepest = static_cast<size_t>(std::min<uint64_t>(num_sims - 1, idx_95 + half));
+
+    std::vector<uint64_t> order(num_sims);
+    std::iota(order.begin(), order.end(), uint64_t{0});
+    auto worse = [&](uint64_t a, uint64_t b) {
+        return pnl[a] < pnl[b] || (pnl[a] == pnl[b] && a < b);
+    };
+    std::nth_element(order.begin(), order.begin() + deepest, order.end(), worse);
+    std::sort(order.begin(), order.begin() + deepest + 1, worse);
+
+    auto near = [half](size_t rank, size_t centre) {
+        return (rank > centre ? rank - centre : centre - rank) <= half;
+    };
+    std::vector<TrackedScenario> tracked;
+    NeumaierSum window_pnl_95;
+    NeumaierSum window_pnl_99;
+    for (size_t rank = 0; rank <= deepest; ++rank) {
+        unsigned sets = (rank <= idx_99 ? kEsTail : 0u) |
+                        (near(rank, idx_99) ? kVar99Window : 0u) |
+                        (near(rank, idx_95) ? kVar95Window : 0u);
+        if (sets == 0) continue;
+        tracked.push_back({order[rank], sets});
+        if (sets & kVar99Window) window_pnl_99.add(pnl[order[rank]]);
+        if (sets & kVar95Window) window_pnl_95.add(pnl[order[rank]]);
+    }
+    result.tracked_scenarios = tracked.size();
+    std::vector<uint64_t>().swap(order);
+
+    // Pass 2: replay the tracked scenarios. Each thread owns a slice of
+    // positions (whole Philox blocks) and sums its contributions in rank
+    // order.
+    std::vector<ComponentRisk> sums(n);
+    run_in_chunks(n, num_threads, 4, [&](size_t begin, size_t end) {
+        Philox4x32 rng(config.seed);
+        const double* drift = inputs.drift.data();
+        const double* vol_sqrt_t = inputs.vol_sqrt_t.data();
+        const double* notional = inputs.notional.data();
+        for (const TrackedScenario& t : tracked) {
+            for (size_t i = begin; i < end; i += 4) {
+                std::array<double, 4> z = normal_quad(rng(t.scenario, i / 4));
+                size_t lanes = std::min<size_t>(4, end - i);
+                for (size_t j = 0; j < lanes; ++j) {
+                    double contribution = notional[i + j] *
+                        (std::exp(drift[i + j] + vol_sqrt_t[i + j] * z[j]) - 1.0);
+                    ComponentRisk& sum = sums[i + j];
+                    if (t.sets & kEsTail) sum.es += contribution;
+                    if (t.sets & kVar99Window) sum.var_99 += contribution;
+                    if (t.sets & kVar95Window) sum.var_95 += contribution;
+                }
+            }
+        }
+    });
+
+    const VaRResult& portfolio = result.portfolio;
+    for (size_t i = 0; i < n; ++i) {
+        ComponentRisk& component = result.component[i];
+        component.var_95 = allocate(portfolio.var_95, sums[i].var_95, window_pnl_95.value());
+        component.var_99 = allocate(portfolio.var_99, sums[i].var_99, window_pnl_99.value());
+        component.es = -sums[i].es / (idx_99 + 1);
+
+        double notional = inputs.notional[i];
+        if (notional != 0.0) {
+            result.marginal[i] = {component.var_95 / notional, component.var_99 / notional,
+                                  component.es / notional};
+        }
+
+        ComponentRisk& symbol = result.by_symbol[symbol_ids[i]];
+        symbol.var_95 += component.var_95;
+        symbol.var_99 += component.var_99;
+        symbol.es += component.es;
+    }
+    return result;
+}
+
+}  // namespace trading
@@ -0,0 +1,55 @@
+#ifndef LIB_VAR_ATTRIBUTION_H_
+#define LIB_VAR_ATTRIBUTION_H_
+
+#include "lib/monte_carlo.h"
+#include "lib/position.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace trading {
+
+struct VaRAttributionConfig {
+    uint64_t num_simulations = 100000;
+    double time_horizon = 1.0 / 252.0;
+    uint64_t seed = 42;
+    int num_threads = 1;
+    // Half-width of the neighbourhood around each VaR rank, as a fraction
+    // of the scenarios (at least one scenario either side).
+    double var_window = 0.001;
+};
+
+// Share of VaR(95%), VaR(99%) and ES attributed to one position or symbol.
+struct ComponentRisk {
+    double var_95 = 0.0;
+    double var_99 = 0.0;
+    double es = 0.0;
+};
+
+struct VaRAttribution {
+    VaRResult portfolio;                   // Same as calculate_var over the run
+    std::vector<ComponentRisk> component;  // Per position; sums to the portfolio figures
+    std::vector<ComponentRisk> marginal;   // Component per unit of notional
+    SymbolTable symbols;
+    std::vector<ComponentRisk> by_symbol;  // Indexed by symbol id
+    size_t tracked_scenarios;              // Scenarios replayed per position
+};
+
+// Euler allocation of Monte Carlo VaR and ES to positions, in two passes
+// over the same Philox scenarios as simulate_pnl_scenarios:
+//   1. portfolio P&L per scenario (one double each), ranked to find the
+//      ES tail and the neighbourhoods of the 95% and 99% VaR ranks;
+//   2. only those scenarios are replayed, accumulating each position's
+//      P&L contribution. The position x scenario matrix is never stored.
+// Component ES is minus the position's mean contribution over the ES
+// tail. Component VaR is minus its mean contribution over the
+// neighbourhood, scaled so the components add up to VaR exactly.
+// Scenarios are split across threads in pass 1 and positions in pass 2,
+// so the result does not depend on num_threads.
+VaRAttribution attribute_var(const std::vector<Position>& positions,
+                             const VaRAttributionConfig& config);
+
+}  // namespace trading
+
+#endif  // LIB_VAR_ATTRIBUTION_H_
@@ -0,0 +1,129 @@
+#include "lib/var_attribution.h"
+
+#include "lib/chunked_mc.h"
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace trading {
+namespace {
+
+ComponentRisk total_of(const std::vector<ComponentRisk>& parts) {
+    ComponentRisk total;
+    for (const auto& part : parts) {
+        total.var_95 += part.var_95;
+        total.var_99 += part.var_99;
+        total.es += part.es;
+    }
+    return total;
+}
+
+TEST(VaRAttributionTest, ComponentsAddUpToPortfolioRisk) {
+    auto positions = generate_random_positions(60, 21, 12);
+    VaRAttributionConfig config;
+    config.num_simulations = 20000;
+    config.seed = 3;
+
+    VaRAttribution result = attribute_var(positions, config);
+
+    std::vector<double> pnl(config.num_simulations);
+    auto inputs = prepare_mc_inputs(positions, config.time_horizon);
+    simulate_pnl_scenarios(inputs, config.seed, 0, pnl.size(), pnl.data());
+    VaRResult expected = calculate_var(pnl);
+    EXPECT_EQ(result.portfolio.var_95, expected.var_95);
+    EXPECT_EQ(result.portfolio.var_99, expected.var_99);
+    EXPECT_EQ(result.portfolio.expected_shortfall, expected.expected_shortfall);
+
+    ASSERT_EQ(result.component.size(), positions.size());
+    ComponentRisk total = total_of(result.component);
+    EXPECT_NEAR(total.var_95, expected.var_95, 1e-9 * expected.var_95);
+    EXPECT_NEAR(total.var_99, expected.var_99, 1e-9 * expected.var_99);
+    EXPECT_NEAR(total.es, expected.expected_shortfall, 1e-9 * expected.expected_shortfall);
+
+    ComponentRisk by_symbol = total_of(result.by_symbol);
+    EXPECT_EQ(result.by_symbol.size(), result.symbols.size());
+    EXPECT_NEAR(by_symbol.es, total.es, 1e-9 * std::abs(total.es));
+
+    for (size_t i = 0; i < positions.size(); ++i) {
+        double notional = positions[i].quantity * positions[i].price;
+        EXPECT_NEAR(result.marginal[i].var_99 * notional, result.component[i].var_99,
+                    1e-9 * std::abs(result.component[i].var_99) + 1e-12);
+    }
+    // ES tail (200) plus two neighbourhoods of 2 * 20 + 1 that overlap it
+    // by 21 scenarios at most.
+    EXPECT_GE(result.tracked_scenarios, 201u + 41u);
+    EXPECT_LE(result.tracked_scenarios, 201u + 41u + 41u);
+}
+
+TEST(VaRAttributionTest, ComponentEsMatchesBruteForce) {
+    auto positions = generate_random_positions(9, 5);
+    VaRAttributionConfig config;
+    config.num_simulations = 3000;
+    auto inputs = prepare_mc_inputs(positions, config.time_horizon);
+
+    std::vector<double> pnl(config.num_simulations);
+    simulate_pnl_scenarios(inputs, config.seed, 0, pnl.size(), pnl.data());
+    VaRAttribution result = attribute_var(positions, config);
+
+    std::vector<size_t> order(pnl.size());
+    std::iota(order.begin(), order.end(), size_t{0});
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return pnl[a] < pnl[b]; });
+    size_t tail = static_cast<size_t>(pnl.size() * 0.01) + 1;
+
+    // Replaying one scenario with all positions but one zeroed isolates
+    // that position's contribution.
+    for (size_t i = 0; i < positions.size(); ++i) {
+        McInputs only = inputs;
+        for (size_t k = 0; k < positions.size(); ++k) {
+            if (k != i) only.notional[k] = 0.0;
+        }
+        double sum = 0.0;
+        for (size_t r = 0; r < tail; ++r) {
+            double contribution;
+            simulate_pnl_scenarios(only, config.seed, order[r], 1, &contribution);
+            sum += contribution;
+        }
+        EXPECT_NEAR(result.component[i].es, -sum / tail,
+                    1e-9 * result.portfolio.expected_shortfall);
+    }
+}
+
+TEST(VaRAttributionTest, ThreadCountDoesNotChangeResult) {
+    auto positions = generate_random_positions(37, 8, 6);
+    VaRAttributionConfig config;
+    config.num_simulations = 4001;
+    VaRAttribution reference = attribute_var(positions, config);
+
+    for (int threads : {2, 3, 7}) {
+        config.num_threads = threads;
+        VaRAttribution result = attribute_var(positions, config);
+        EXPECT_EQ(result.tracked_scenarios, reference.tracked_scenarios);
+        for (size_t i = 0; i < positions.size(); ++i) {
+            EXPECT_EQ(result.component[i].var_95, reference.component[i].var_95);
+            EXPECT_EQ(result.component[i].var_99, reference.component[i].var_99);
+            EXPECT_EQ(result.component[i].es, reference.component[i].es);
+        }
+    }
+}
+
+TEST(VaRAttributionTest, SinglePositionCarriesAllRisk) {
+    auto positions = generate_random_positions(1, 2);
+    VaRAttributionConfig config;
+    config.num_simulations = 1000;
+    VaRAttribution result = attribute_var(positions, config);
+    ASSERT_EQ(result.component.size(), 1u);
+    EXPECT_NEAR(result.component[0].var_99, result.portfolio.var_99,
+                1e-12 * std::abs(result.portfolio.var_99));
+    EXPECT_NEAR(result.component[0].es, result.portfolio.expected_shortfall,
+                1e-12 * std::abs(result.portfolio.expected_shortfall));
+
+    config.num_simulations = 0;
+    EXPECT_EQ(attribute_var(positions, config).tracked_scenarios, 0u);
+}
+
+}  // namespace
+}  // namespace trading
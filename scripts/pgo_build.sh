@@ -0,0 +1,100 @@
+#!/bin/bash
+set -e
+
+# Profile-guided + LTO build of risk_benchmark:
+#   1. instrumented build
+#   2. training run of the benchmark itself
+#   3. optimized rebuild against the collected profile
+#
+# Usage: pgo_build.sh [cmake|bazel]
+# PGO_TRAINING_ARGS overrides the benchmark arguments of the training run.
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(dirname "$SCRIPT_DIR")"
+BUILD_SYSTEM="${1:-cmake}"
+BUILD_DIR="${PROJECT_DIR}/build-pgo"
+PROFILE_DIR="${PROJECT_DIR}/build-pgo/profiles"
+TRAINING_ARGS="${PGO_TRAINING_ARGS:---positions 50000 --simulations 20000}"
+JOBS="$(nproc 2>/dev/null || sysctl -n hw.ncpu 2>/dev/null || echo 4)"
+
+# Clang writes raw profiles that must be merged before the optimized build.
+merge_clang_profiles() {
+    if ls "${PROFILE_DIR}"/*.profraw >/dev/null 2>&1; then
+        echo "Merging Clang profiles..."
+        llvm-profdata merge -output="${PROFILE_DIR}/default.profdata" \
+            "${PROFILE_DIR}"/*.profraw
+    fi
+}
+
+train() {
+    echo ""
+    echo "=== Training run: risk_benchmark ${TRAINING_ARGS} ==="
+    # shellcheck disable=SC2086
+    "$1" ${TRAINING_ARGS} > "${BUILD_DIR}/training.log"
+    # shellcheck disable=SC2086
+    "$1" ${TRAINING_ARGS} --book skewed >> "${BUILD_DIR}/training.log"
+    echo "Training output: ${BUILD_DIR}/training.log"
+}
+
+echo "=== PGO + LTO build (${BUILD_SYSTEM}) ==="
+echo "Profile directory: ${PROFILE_DIR}"
+rm -rf "${PROFILE_DIR}"
+mkdir -p "${PROFILE_DIR}"
+
+case "${BUILD_SYSTEM}" in
+cmake)
+    # GCC names profiles after the object paths, so both phases share one
+    # build directory.
+    echo ""
+    echo "=== Instrumented build ==="
+    cmake -S "${PROJECT_DIR}" -B "${BUILD_DIR}" -DCMAKE_BUILD_TYPE=Release \
+        -DBUILD_TESTS=OFF -DTRADING_LTO=ON -DTRADING_PGO=GENERATE \
+        -DTRADING_PGO_DIR="${PROFILE_DIR}"
+    cmake --build "${BUILD_DIR}" --target risk_benchmark --parallel "${JOBS}"
+
+    train "${BUILD_DIR}/risk_benchmark"
+    merge_clang_profiles
+
+    echo ""
+    echo "=== Optimized build ==="
+    cmake -S "${PROJECT_DIR}" -B "${BUILD_DIR}" -DTRADING_PGO=USE
+    cmake --build "${BUILD_DIR}" --target risk_benchmark --parallel "${JOBS}"
+    BINARY="${BUILD_DIR}/risk_benchmark"
+    ;;
+bazel)
+    cd "${PROJECT_DIR}"
+    if "${CC:-cc}" --version 2>/dev/null | grep -q clang; then
+        PROFILE_USE="${PROFILE_DIR}/default.profdata"
+    else
+        PROFILE_USE="${PROFILE_DIR}"
+    fi
+
+    echo ""
+    echo "=== Instrumented build ==="
+    bazel build -c opt --config=lto --config=pgo-generate \
+        --copt=-fprofile-generate="${PROFILE_DIR}" \
+        --linkopt=-fprofile-generate="${PROFILE_DIR}" \
+        //apps:risk_benchmark
+    mkdir -p "${BUILD_DIR}"
+    cp -f bazel-bin/apps/risk_benchmark "${BUILD_DIR}/risk_benchmark-instrumented"
+
+    train "${BUILD_DIR}/risk_benchmark-instrumented"
+    merge_clang_profiles
+
+    echo ""
+    echo "=== Optimized build ==="
+    bazel build -c opt --config=lto --config=pgo-use \
+        --copt=-fprofile-use="${PROFILE_USE}" \
+        --linkopt=-fprofile-use="${PROFILE_USE}" \
+        //apps:risk_benchmark
+    BINARY="${PROJECT_DIR}/bazel-bin/apps/risk_benchmark"
+    ;;
+*)
+    echo "Usage: $0 [cmake|bazel]"
+    exit 1
+    ;;
+esac
+
+echo ""
+echo "=== PGO Build Complete ==="
+echo "Run benchmark:  ${BINARY}"